@@ -0,0 +1,226 @@
+#include "alphablend.h"
+#include <QPainter>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ALPHABLEND_SSE2
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define ALPHABLEND_AVX2_FUNCTION
+#else
+#define ALPHABLEND_AVX2_FUNCTION __attribute__((target("avx2")))
+#endif
+#endif
+#endif
+
+namespace {
+
+// Qt's BYTE_MUL: x * a / 255 on every channel, rounded the same way the raster engine does it
+inline quint32 byteMul(quint32 x, quint32 a) {
+    quint32 t = (x & 0xff00ff) * a;
+    t = (t + ((t >> 8) & 0xff00ff) + 0x800080) >> 8;
+    t &= 0xff00ff;
+    x = ((x >> 8) & 0xff00ff) * a;
+    x = (x + ((x >> 8) & 0xff00ff) + 0x800080);
+    x &= 0xff00ff00;
+    return x | t;
+}
+
+// QPainter turns an opacity of 0.5 into (128 * 255) >> 8
+constexpr quint32 halfAlpha = (128 * 255) >> 8;
+
+void sourceOverScalar(quint32* dst, const quint32* src, int count) {
+    for (int i = 0; i < count; i++) {
+        quint32 s = src[i];
+        if (s >= 0xff000000)
+            dst[i] = s;
+        else if (s != 0)
+            dst[i] = s + byteMul(dst[i], qAlpha(~s));
+    }
+}
+
+void sourceOverHalfScalar(quint32* dst, const quint32* src, int count) {
+    for (int i = 0; i < count; i++) {
+        quint32 s = byteMul(src[i], halfAlpha);
+        dst[i] = s + byteMul(dst[i], qAlpha(~s));
+    }
+}
+
+#ifdef ALPHABLEND_SSE2
+// multiplies 4 pixels by the 16 bit per channel alphas in alphaLo (pixels 0-1) and alphaHi (pixels 2-3)
+inline __m128i byteMulSSE2(__m128i x, __m128i alphaLo, __m128i alphaHi) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i half = _mm_set1_epi16(0x80);
+    __m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(x, zero), alphaLo);
+    __m128i hi = _mm_mullo_epi16(_mm_unpackhi_epi8(x, zero), alphaHi);
+    lo = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), half), 8);
+    hi = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), half), 8);
+    return _mm_packus_epi16(lo, hi);
+}
+
+// s + BYTE_MUL(d, 255 - alpha(s)) for 4 pixels
+inline __m128i blendSSE2(__m128i s, __m128i d) {
+    __m128i ia = _mm_sub_epi32(_mm_set1_epi32(255), _mm_srli_epi32(s, 24));
+    ia = _mm_or_si128(ia, _mm_slli_epi32(ia, 16));
+    return _mm_add_epi32(s, byteMulSSE2(d, _mm_unpacklo_epi32(ia, ia), _mm_unpackhi_epi32(ia, ia)));
+}
+
+void sourceOverSSE2(quint32* dst, const quint32* src, int count) {
+    const __m128i opaque = _mm_set1_epi32(static_cast<int>(0xff000000));
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        // tiles are mostly fully opaque or fully transparent, skip the math for those
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(s, opaque), opaque)) == 0xffff) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), s);
+            continue;
+        }
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(s, zero)) == 0xffff)
+            continue;
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), blendSSE2(s, d));
+    }
+    sourceOverScalar(dst + i, src + i, count - i);
+}
+
+void sourceOverHalfSSE2(quint32* dst, const quint32* src, int count) {
+    const __m128i alpha = _mm_set1_epi16(halfAlpha);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i s = byteMulSSE2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), alpha, alpha);
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), blendSSE2(s, d));
+    }
+    sourceOverHalfScalar(dst + i, src + i, count - i);
+}
+
+// the AVX2 versions are the SSE2 ones on 8 pixels, unpack and pack both work per 128 bit lane so the layout matches
+ALPHABLEND_AVX2_FUNCTION inline __m256i byteMulAVX2(__m256i x, __m256i alphaLo, __m256i alphaHi) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i half = _mm256_set1_epi16(0x80);
+    __m256i lo = _mm256_mullo_epi16(_mm256_unpacklo_epi8(x, zero), alphaLo);
+    __m256i hi = _mm256_mullo_epi16(_mm256_unpackhi_epi8(x, zero), alphaHi);
+    lo = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(lo, _mm256_srli_epi16(lo, 8)), half), 8);
+    hi = _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(hi, _mm256_srli_epi16(hi, 8)), half), 8);
+    return _mm256_packus_epi16(lo, hi);
+}
+
+ALPHABLEND_AVX2_FUNCTION inline __m256i blendAVX2(__m256i s, __m256i d) {
+    __m256i ia = _mm256_sub_epi32(_mm256_set1_epi32(255), _mm256_srli_epi32(s, 24));
+    ia = _mm256_or_si256(ia, _mm256_slli_epi32(ia, 16));
+    return _mm256_add_epi32(s, byteMulAVX2(d, _mm256_unpacklo_epi32(ia, ia), _mm256_unpackhi_epi32(ia, ia)));
+}
+
+ALPHABLEND_AVX2_FUNCTION void sourceOverAVX2(quint32* dst, const quint32* src, int count) {
+    const __m256i opaque = _mm256_set1_epi32(static_cast<int>(0xff000000));
+    const __m256i zero = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(_mm256_and_si256(s, opaque), opaque)) == -1) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), s);
+            continue;
+        }
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(s, zero)) == -1)
+            continue;
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), blendAVX2(s, d));
+    }
+    sourceOverSSE2(dst + i, src + i, count - i);
+}
+
+ALPHABLEND_AVX2_FUNCTION void sourceOverHalfAVX2(quint32* dst, const quint32* src, int count) {
+    const __m256i alpha = _mm256_set1_epi16(halfAlpha);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i s = byteMulAVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)), alpha, alpha);
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), blendAVX2(s, d));
+    }
+    sourceOverHalfSSE2(dst + i, src + i, count - i);
+}
+
+bool cpuHasAVX2() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    // the os has to save the ymm registers too
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!osxsave || (_xgetbv(0) & 6) != 6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+using Kernels = AlphaBlend::Kernels;
+
+const Kernels& kernels() {
+    static const Kernels k = [] {
+#ifdef ALPHABLEND_SSE2
+        if (cpuHasAVX2())
+            return Kernels{sourceOverAVX2, sourceOverHalfAVX2, "avx2"};
+        return Kernels{sourceOverSSE2, sourceOverHalfSSE2, "sse2"};
+#else
+        return Kernels{sourceOverScalar, sourceOverHalfScalar, "scalar"};
+#endif
+    }();
+    return k;
+}
+
+}
+
+void AlphaBlend::sourceOver(quint32* dst, const quint32* src, int count) {
+    kernels().over(dst, src, count);
+}
+
+void AlphaBlend::sourceOverHalf(quint32* dst, const quint32* src, int count) {
+    kernels().half(dst, src, count);
+}
+
+void AlphaBlend::blendImage(QImage& dst, const QPoint& pos, const QImage& src, bool half) {
+    blendImage(dst, pos, src, src.rect(), half);
+}
+
+void AlphaBlend::blendImage(QImage& dst, const QPoint& pos, const QImage& src, const QRect& srcRect, bool half) {
+    if (dst.format() != QImage::Format_ARGB32_Premultiplied || src.format() != QImage::Format_ARGB32_Premultiplied) {
+        QPainter p{&dst};
+        p.setCompositionMode(QPainter::CompositionMode_SourceOver);
+        if (half)
+            p.setOpacity(0.5);
+        p.drawImage(pos, src, srcRect);
+        p.end();
+        return;
+    }
+    // the part of srcRect outside of src is skipped, like QPainter does
+    const QRect source = srcRect & src.rect();
+    const QPoint origin = pos + (source.topLeft() - srcRect.topLeft());
+    QRect area = QRect{origin, source.size()} & dst.rect();
+    if (area.isEmpty())
+        return;
+    auto blend = half ? kernels().half : kernels().over;
+    for (int y = area.top(); y <= area.bottom(); y++) {
+        auto* d = reinterpret_cast<quint32*>(dst.scanLine(y)) + area.left();
+        auto* s = reinterpret_cast<const quint32*>(src.constScanLine(source.top() + y - origin.y())) + source.left() + (area.left() - origin.x());
+        blend(d, s, area.width());
+    }
+}
+
+const char* AlphaBlend::kernelName() {
+    return kernels().name;
+}
+
+QVector<AlphaBlend::Kernels> AlphaBlend::availableKernels() {
+    QVector<Kernels> all{{sourceOverScalar, sourceOverHalfScalar, "scalar"}};
+#ifdef ALPHABLEND_SSE2
+    all.append({sourceOverSSE2, sourceOverHalfSSE2, "sse2"});
+    if (cpuHasAVX2())
+        all.append({sourceOverAVX2, sourceOverHalfAVX2, "avx2"});
+#endif
+    return all;
+}
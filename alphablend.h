@@ -0,0 +1,37 @@
+#ifndef ALPHABLEND_H
+#define ALPHABLEND_H
+
+#include <QImage>
+#include <QPoint>
+#include <QRect>
+#include <QVector>
+#include <QtGlobal>
+
+// Blending kernels for premultiplied ARGB32 pixels, used to composite tiles without going through QPainter.
+// The arithmetic is the same as Qt's raster engine, so the results are bit-exact with QPainter's output
+// for 1:1 blits of Format_ARGB32_Premultiplied images.
+class AlphaBlend
+{
+public:
+    // one implementation of the two row kernels
+    struct Kernels {
+        void (*over)(quint32* dst, const quint32* src, int count);
+        void (*half)(quint32* dst, const quint32* src, int count);
+        const char* name;
+    };
+    // dst = src + dst * (255 - alpha(src)), same as QPainter::CompositionMode_SourceOver
+    static void sourceOver(quint32* dst, const quint32* src, int count);
+    // same as sourceOver with QPainter::setOpacity(0.5)
+    static void sourceOverHalf(quint32* dst, const quint32* src, int count);
+    // blends src onto dst with its top left corner at pos, src is clipped to dst
+    // falls back to QPainter if either image is not premultiplied ARGB32
+    static void blendImage(QImage& dst, const QPoint& pos, const QImage& src, bool half = false);
+    // same, with only the srcRect part of src, e.g. one glyph or tile out of an atlas
+    static void blendImage(QImage& dst, const QPoint& pos, const QImage& src, const QRect& srcRect, bool half = false);
+    // name of the kernel set picked for this cpu ("avx2", "sse2" or "scalar")
+    static const char* kernelName();
+    // every kernel set this cpu can run, scalar first, so each can be checked and not only the one picked
+    static QVector<Kernels> availableKernels();
+};
+
+#endif // ALPHABLEND_H
@@ -0,0 +1,114 @@
+#include "batchconverter.h"
+#include "headlesstool.h"
+#include "jsonsprite.h"
+#include "spritesaver.h"
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QThreadPool>
+
+using namespace HeadlessTool;
+
+bool BatchConverter::requested(int argc, char* argv[]) {
+    return hasFlag(argc, argv, "--convert");
+}
+
+int BatchConverter::run(const QStringList& arguments) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Converts every sprite under a directory between the CFG and JSON formats.");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"convert", "Directory to convert recursively.", "dir"},
+        {"to", "Format to convert to, json (default) or cfg.", "format", "json"},
+        {"output", "Directory the converted tree is written to, defaults to the input directory.", "dir"},
+        {"jobs", "Number of worker threads, defaults to the number of cores.", "n"},
+        {"overwrite", "Replace files that already exist instead of skipping them."},
+        {"translucency-compat", "Encode translucent display tiles the old way (map16 tile + 0x8000)."},
+    });
+    if (!parser.parse(arguments)) {
+        QTextStream(stderr) << parser.errorText() << '\n';
+        return ExitUsage;
+    }
+    if (parser.isSet("help")) {
+        QTextStream(stdout) << parser.helpText();
+        return ExitOk;
+    }
+
+    Options options;
+    options.inputDir = parser.value("convert");
+    options.outputDir = parser.isSet("output") ? parser.value("output") : options.inputDir;
+    options.overwrite = parser.isSet("overwrite");
+    options.translucencyCompatibility = parser.isSet("translucency-compat");
+    auto format = parser.value("to").toLower();
+    if (format != "json" && format != "cfg") {
+        QTextStream(stderr) << "Unknown format " << format << ", valid formats are: json, cfg\n";
+        return ExitUsage;
+    }
+    options.targetExtension = "." + format;
+    if (parser.isSet("jobs")) {
+        bool ok = false;
+        options.jobs = parser.value("jobs").toInt(&ok);
+        if (!ok || options.jobs < 1) {
+            QTextStream(stderr) << "--jobs expects a positive number\n";
+            return ExitUsage;
+        }
+    }
+    if (!QFileInfo{options.inputDir}.isDir()) {
+        QTextStream(stderr) << options.inputDir << " is not a directory\n";
+        return ExitUsage;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    auto results = convertTree(options);
+    auto elapsed = timer.elapsed();
+
+    return printResults(results, "converted", elapsed, [](const Result&) { return QString{}; });
+}
+
+QVector<BatchConverter::Result> BatchConverter::convertTree(const Options& options) {
+    const QString sourceExtension = options.targetExtension == ".json" ? ".cfg" : ".json";
+    QDir inputDir{options.inputDir};
+    QDir outputDir{options.outputDir};
+
+    const QStringList sources = findFiles(options.inputDir, {"*" + sourceExtension});
+
+    // the tasks only write their own result, which keeps them in the sorted order without locking
+    QVector<Result> results(sources.size());
+    QThreadPool pool;
+    if (options.jobs > 0)
+        pool.setMaxThreadCount(options.jobs);
+    for (qsizetype i = 0; i < sources.size(); i++) {
+        pool.start([&, i]() {
+            auto relative = inputDir.relativeFilePath(sources[i]);
+            relative.chop(sourceExtension.size());
+            results[i] = convertFile(sources[i], outputDir.filePath(relative + options.targetExtension), options);
+        });
+    }
+    pool.waitForDone();
+    return results;
+}
+
+BatchConverter::Result BatchConverter::convertFile(const QString& source, const QString& target, const Options& options) {
+    Result result{source, target, Status::Failed, {}};
+    if (!options.overwrite && QFileInfo::exists(target)) {
+        result.status = Status::Skipped;
+        result.message = "target already exists";
+        return result;
+    }
+    JsonSprite sprite;
+    if (!sprite.load_file(source, result.message))
+        return result;
+    if (!QDir{}.mkpath(QFileInfo{target}.absolutePath())) {
+        result.message = "could not create the output directory";
+        return result;
+    }
+    // written the way the editor saves sprites, atomically and with the platform's line endings
+    bool written = false;
+    if (!SpriteSaver::writeFile(target, sprite.to_text(target, options.translucencyCompatibility), written, result.message))
+        return result;
+    result.status = Status::Converted;
+    return result;
+}
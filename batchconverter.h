@@ -0,0 +1,40 @@
+#ifndef BATCHCONVERTER_H
+#define BATCHCONVERTER_H
+
+#include <QStringList>
+#include <QVector>
+
+// Headless CFG <-> JSON conversion of whole directory trees, started with --convert.
+// Files are converted in parallel but reported in sorted path order, so the output doesn't depend on scheduling.
+class BatchConverter
+{
+public:
+    enum class Status {
+        Converted,
+        Skipped,
+        Failed
+    };
+    struct Result {
+        QString source;
+        QString target;
+        Status status = Status::Failed;
+        QString message;
+    };
+    struct Options {
+        QString inputDir;
+        QString outputDir;
+        // extension of the files to write, the other one is read
+        QString targetExtension = ".json";
+        int jobs = 0;
+        bool overwrite = false;
+        bool translucencyCompatibility = false;
+    };
+    // true if argv asks for conversion, checked before any QCoreApplication exists
+    static bool requested(int argc, char* argv[]);
+    // parses the arguments of a running QCoreApplication, converts and returns the process exit code
+    static int run(const QStringList& arguments);
+    static QVector<Result> convertTree(const Options& options);
+    static Result convertFile(const QString& source, const QString& target, const Options& options);
+};
+
+#endif // BATCHCONVERTER_H
@@ -0,0 +1,98 @@
+#include "benchmark.h"
+#include "alphablend.h"
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSysInfo>
+#include <algorithm>
+#include <numeric>
+
+namespace {
+qint64 timeBatch(const Benchmark::Body& body, qint64 iterations) {
+    QElapsedTimer timer;
+    timer.start();
+    for (qint64 i = 0; i < iterations; i++)
+        body();
+    return timer.nsecsElapsed();
+}
+}
+
+QString Benchmark::Scenario::id() const {
+    return QString::asprintf("%s/%d", qPrintable(name), scale);
+}
+
+QString Benchmark::Measurement::id() const {
+    return QString::asprintf("%s/%d", qPrintable(name), scale);
+}
+
+Benchmark::Measurement Benchmark::measure(const Scenario& scenario, const Options& options) {
+    Measurement m{scenario.name, scenario.group, scenario.scale, 1, 0, 0, 0, 0, 0};
+    Body body = scenario.setup();
+    // the first call pays for lazy initialization and cold caches, it also tells how many calls fill a sample
+    qint64 single = qMax<qint64>(timeBatch(body, 1), 1);
+    if (single < options.minSampleNs) {
+        m.iterations = qMax<qint64>(1, options.minSampleNs / single);
+        // grow the batch until it really takes long enough, the first call is usually slower than the rest
+        while (timeBatch(body, m.iterations) < options.minSampleNs)
+            m.iterations *= 2;
+    }
+    QVector<double> perCall;
+    perCall.reserve(options.samples);
+    for (int s = 0; s < options.samples; s++)
+        perCall.append(static_cast<double>(timeBatch(body, m.iterations)) / m.iterations);
+    std::sort(perCall.begin(), perCall.end());
+    m.samples = static_cast<int>(perCall.size());
+    if (perCall.isEmpty())
+        return m;
+    auto mid = perCall.size() / 2;
+    m.medianNs = perCall.size() % 2 ? perCall[mid] : (perCall[mid - 1] + perCall[mid]) / 2;
+    m.minNs = perCall.first();
+    m.maxNs = perCall.last();
+    m.meanNs = std::accumulate(perCall.cbegin(), perCall.cend(), 0.0) / perCall.size();
+    return m;
+}
+
+QJsonObject Benchmark::context() {
+    return QJsonObject{
+        {"date", QDateTime::currentDateTimeUtc().toString(Qt::ISODate)},
+        {"host", QSysInfo::machineHostName()},
+        {"os", QSysInfo::prettyProductName()},
+        {"cpu", QSysInfo::currentCpuArchitecture()},
+        {"qt", qVersion()},
+        {"blendKernels", AlphaBlend::kernelName()},
+#ifdef QT_NO_DEBUG_OUTPUT
+        {"debugOutput", false},
+#else
+        {"debugOutput", true},
+#endif
+    };
+}
+
+QByteArray Benchmark::toJson(const QVector<Measurement>& results) {
+    QJsonArray array;
+    for (auto& m : results) {
+        array.append(QJsonObject{
+            {"name", m.name},
+            {"group", m.group},
+            {"scale", m.scale},
+            {"iterations", m.iterations},
+            {"samples", m.samples},
+            {"median_ns", m.medianNs},
+            {"min_ns", m.minNs},
+            {"max_ns", m.maxNs},
+            {"mean_ns", m.meanNs},
+        });
+    }
+    return QJsonDocument{QJsonObject{{"context", context()}, {"results", array}}}.toJson();
+}
+
+QString Benchmark::formatNs(double ns) {
+    if (ns >= 1e9)
+        return QString::asprintf("%.2f s", ns / 1e9);
+    if (ns >= 1e6)
+        return QString::asprintf("%.2f ms", ns / 1e6);
+    if (ns >= 1e3)
+        return QString::asprintf("%.2f us", ns / 1e3);
+    return QString::asprintf("%.0f ns", ns);
+}
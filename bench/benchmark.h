@@ -0,0 +1,65 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+#include <functional>
+
+// keeps the compiler from dropping a computation whose result isn't otherwise used
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static const void* volatile sink;
+    sink = &value;
+#endif
+}
+
+// Minimal timing harness: every scenario is warmed up, its body is repeated until one sample takes long enough
+// to time reliably, and the per call time of several samples is summarized. Medians are what gets compared,
+// the other numbers are there to judge how noisy a run was.
+class Benchmark
+{
+public:
+    using Body = std::function<void()>;
+    struct Scenario {
+        // dotted name, e.g. "decode.get8x8TileFromVect"
+        QString name;
+        // "micro" for a single function, "macro" for a whole user action
+        QString group;
+        // size of the input, what it counts depends on the scenario (tiles, displays, ...)
+        int scale = 1;
+        // builds the fixtures outside of the timed region and returns the body to time, which owns them
+        std::function<Body()> setup;
+        QString id() const;
+    };
+    struct Measurement {
+        QString name;
+        QString group;
+        int scale = 1;
+        // calls of the body per sample
+        qint64 iterations = 0;
+        int samples = 0;
+        double medianNs = 0;
+        double minNs = 0;
+        double maxNs = 0;
+        double meanNs = 0;
+        QString id() const;
+    };
+    struct Options {
+        int samples = 15;
+        // a sample runs the body until at least this much time passed
+        qint64 minSampleNs = 5'000'000;
+    };
+    static Measurement measure(const Scenario& scenario, const Options& options);
+    // where a run happened: date, machine, Qt version and the build flags that change the timings
+    static QJsonObject context();
+    // {"context": {...}, "results": [...]}, meant to be stored and compared between runs
+    static QByteArray toJson(const QVector<Measurement>& results);
+    static QString formatNs(double ns);
+};
+
+#endif // BENCHMARK_H
@@ -0,0 +1,44 @@
+#include "fixtures.h"
+#include "corpusgenerator.h"
+#include <QFile>
+
+bool Fixtures::isValid() const {
+    return m_dir.isValid();
+}
+
+QString Fixtures::map16Base64(int tiles, quint32 seed) {
+    return CorpusGenerator::map16Base64(tiles, seed);
+}
+
+JsonSprite Fixtures::sprite(int displays, int tilesPerDisplay, int map16Tiles, int collections, quint32 seed) {
+    return CorpusGenerator::sprite(displays, tilesPerDisplay, map16Tiles, collections, seed);
+}
+
+QString Fixtures::spriteFile(const QString& extension, int displays, int tilesPerDisplay, int map16Tiles) {
+    auto name = QString::asprintf("sprite_%d_%d_%d", displays, tilesPerDisplay, map16Tiles) + extension;
+    return file(name, [=]() { return sprite(displays, tilesPerDisplay, map16Tiles, displays).to_text(name, false); });
+}
+
+QString Fixtures::externalGfxFile(quint32 seed) {
+    return file(QString::asprintf("ExGFX%X.bin", 0x80 + seed), [seed]() { return CorpusGenerator::exgfxFile(seed); });
+}
+
+QString Fixtures::map16File(int pages) {
+    return file(QString::asprintf("stress_%dp.map16", pages), [pages]() { return CorpusGenerator::map16File(pages); });
+}
+
+QString Fixtures::file(const QString& name, const std::function<QByteArray()>& contents) {
+    auto it = m_files.constFind(name);
+    if (it != m_files.cend())
+        return *it;
+    auto path = m_dir.filePath(name);
+    QFile file{path};
+    if (file.open(QFile::OpenModeFlag::WriteOnly))
+        file.write(contents());
+    m_files.insert(name, path);
+    return path;
+}
+
+QString Fixtures::scratchFile(const QString& name) const {
+    return m_dir.filePath(name);
+}
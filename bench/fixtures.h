@@ -0,0 +1,35 @@
+#ifndef FIXTURES_H
+#define FIXTURES_H
+
+#include <QHash>
+#include <QString>
+#include <QTemporaryDir>
+#include <functional>
+#include "jsonsprite.h"
+
+// Deterministic benchmark inputs made with CorpusGenerator: the same scale and seed always give the same bytes,
+// so runs on different days (or machines) measure the same work. Files are written once into a temporary
+// directory that lives as long as the Fixtures object.
+class Fixtures
+{
+public:
+    bool isValid() const;
+    // the base64 "Map16" field of a sprite with this many custom tiles
+    static QString map16Base64(int tiles, quint32 seed = 1);
+    static JsonSprite sprite(int displays, int tilesPerDisplay, int map16Tiles, int collections, quint32 seed = 1);
+    // sprite(...) saved as .json or .cfg
+    QString spriteFile(const QString& extension, int displays, int tilesPerDisplay, int map16Tiles);
+    // 32KB of random 4bpp graphics, the largest ExGFX file the editor accepts
+    QString externalGfxFile(quint32 seed = 1);
+    // a .map16 file with this many pages of 16x16 tiles
+    QString map16File(int pages);
+    // a path in the fixture directory for benchmarks that write files
+    QString scratchFile(const QString& name) const;
+private:
+    // writes contents() into the directory the first time name is asked for
+    QString file(const QString& name, const std::function<QByteArray()>& contents);
+    QTemporaryDir m_dir;
+    QHash<QString, QString> m_files;
+};
+
+#endif // FIXTURES_H
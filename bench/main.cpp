@@ -0,0 +1,170 @@
+#include "benchmark.h"
+#include "fixtures.h"
+#include "regression.h"
+#include "scenarios.h"
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QTextStream>
+
+namespace {
+// the hot paths are full of qDebug, a debug build would mostly measure the message handler
+void dropDebugMessages(QtMsgType type, const QMessageLogContext&, const QString& message) {
+    if (type != QtDebugMsg)
+        QTextStream(stderr) << message << '\n';
+}
+}
+
+int main(int argc, char *argv[])
+{
+    // the widget benchmarks need a QApplication, but never a display
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication a(argc, argv);
+    qInstallMessageHandler(dropDebugMessages);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmarks the decoding, map16, sprite file and rendering paths of the editor.");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"output", "File the JSON results are written to, defaults to standard output.", "file"},
+        {"filter", "Only run scenarios whose name/scale matches this regular expression.", "regex"},
+        {"samples", "Samples per scenario, defaults to 15.", "n", "15"},
+        {"min-sample-ms", "Minimum duration of one sample, defaults to 5.", "ms", "5"},
+        {"list", "List the scenarios without running them."},
+        {"baseline", "Compare the medians and golden images with this baseline, the exit code is 1 on a regression.", "file"},
+        {"update-baseline", "Record the medians and golden images of this run into --baseline instead."},
+        {"update-images", "Only record the golden images into --baseline, no scenario is run."},
+        {"check-blend", "Only check every AlphaBlend kernel against QPainter, the exit code is 1 if one differs."},
+        {"retries", "Times a scenario slower than the baseline is measured again before it counts, defaults to 1.", "n", "1"},
+    });
+    parser.process(a);
+
+    Fixtures fixtures;
+    if (!fixtures.isValid()) {
+        QTextStream(stderr) << "Could not create a directory for the fixtures\n";
+        return 1;
+    }
+    auto scenarios = allScenarios(fixtures);
+    QRegularExpression filter{parser.value("filter")};
+    if (!filter.isValid()) {
+        QTextStream(stderr) << "Invalid --filter: " << filter.errorString() << '\n';
+        return 2;
+    }
+    scenarios.removeIf([&](const Benchmark::Scenario& s) { return !filter.match(s.id()).hasMatch(); });
+
+    QTextStream err{stderr};
+    if (parser.isSet("list")) {
+        for (auto& s : scenarios)
+            QTextStream(stdout) << s.group << ' ' << s.id() << '\n';
+        return 0;
+    }
+
+    if (parser.isSet("check-blend")) {
+        QTextStream out{stdout};
+        return Regression::compare({}, {}, {}, {}, Regression::blendChecks(), out).failed() ? 1 : 0;
+    }
+
+    Benchmark::Options options;
+    bool ok = false;
+    options.samples = parser.value("samples").toInt(&ok);
+    if (!ok || options.samples < 1) {
+        err << "--samples expects a positive number\n";
+        return 2;
+    }
+    options.minSampleNs = parser.value("min-sample-ms").toLongLong(&ok) * 1'000'000;
+    if (!ok || options.minSampleNs < 0) {
+        err << "--min-sample-ms expects a number\n";
+        return 2;
+    }
+
+    const int retries = parser.value("retries").toInt(&ok);
+    if (!ok || retries < 0) {
+        err << "--retries expects a number\n";
+        return 2;
+    }
+
+    const QString baselineFile = parser.value("baseline");
+    const bool updateBaseline = parser.isSet("update-baseline");
+    const bool updateImages = parser.isSet("update-images");
+    if ((updateBaseline || updateImages) && baselineFile.isEmpty()) {
+        err << (updateBaseline ? "--update-baseline" : "--update-images") << " needs --baseline\n";
+        return 2;
+    }
+    Regression::Baseline baseline;
+    QHash<QString, QString> images;
+    QVector<Regression::Serialization> serializations;
+    QVector<Regression::BlendCheck> blends;
+    if (!baselineFile.isEmpty()) {
+        QString error;
+        // a new baseline can be recorded into a file that doesn't exist yet
+        if ((!(updateBaseline || updateImages) || QFileInfo::exists(baselineFile)) && !Regression::readBaseline(baselineFile, baseline, error)) {
+            err << "Could not read " << baselineFile << ": " << error << '\n';
+            return 2;
+        }
+        // drawn before the scenarios run, so they start from the same state the editor does
+        images = Regression::imageHashes(goldenImages());
+        serializations = Regression::serializations(serializerCases(fixtures));
+        blends = Regression::blendChecks();
+    }
+    if (updateImages) {
+        Regression::updateImages(baseline, images);
+        QString error;
+        if (!Regression::writeBaseline(baselineFile, baseline, error)) {
+            err << "Could not write " << baselineFile << ": " << error << '\n';
+            return 1;
+        }
+        err << "Recorded " << images.size() << " images into " << baselineFile << '\n';
+        return 0;
+    }
+
+    QVector<Benchmark::Measurement> results;
+    results.reserve(scenarios.size());
+    for (auto& s : scenarios) {
+        results.append(Benchmark::measure(s, options));
+        auto& m = results.last();
+        // a slow sample is more often a busy machine than a regression, only a repeated one counts
+        for (int r = 0; r < retries && !updateBaseline && Regression::isSlower(baseline, m); r++) {
+            err << s.id() << " is slower than the baseline, measuring again\n";
+            auto again = Benchmark::measure(s, options);
+            if (again.medianNs < m.medianNs)
+                m = again;
+        }
+        err << qSetFieldWidth(40) << Qt::left << s.id() << qSetFieldWidth(0)
+            << Benchmark::formatNs(m.medianNs) << " (" << m.iterations << " x " << m.samples << ")\n";
+        err.flush();
+    }
+
+    auto json = Benchmark::toJson(results);
+    if (parser.isSet("output")) {
+        QSaveFile out{parser.value("output")};
+        if (!out.open(QIODevice::WriteOnly) || out.write(json) != json.size() || !out.commit()) {
+            err << "Could not write " << parser.value("output") << ": " << out.errorString() << '\n';
+            return 1;
+        }
+    } else if (baselineFile.isEmpty()) {
+        QTextStream(stdout) << json;
+    }
+    if (baselineFile.isEmpty())
+        return 0;
+
+    if (updateBaseline) {
+        Regression::update(baseline, results, images);
+        QString error;
+        if (!Regression::writeBaseline(baselineFile, baseline, error)) {
+            err << "Could not write " << baselineFile << ": " << error << '\n';
+            return 1;
+        }
+        err << "Recorded " << results.size() << " scenarios and " << images.size() << " images into " << baselineFile << '\n';
+        return 0;
+    }
+    // only the serializations and blend checks are checked then, say so instead of passing quietly
+    if (baseline.medians.isEmpty())
+        err << baselineFile << " has no medians, record them with --update-baseline on the machine the check runs on\n";
+    if (baseline.images.isEmpty())
+        err << baselineFile << " has no image hashes, record them with --update-images\n";
+    QTextStream out{stdout};
+    return Regression::compare(baseline, results, images, serializations, blends, out).failed() ? 1 : 0;
+}
@@ -0,0 +1,299 @@
+#include "regression.h"
+#include "alphablend.h"
+#include "snesgfxconverter.h"
+#include "structuralhash.h"
+#include <QFile>
+#include <QJsonDocument>
+#include <QPainter>
+#include <QRandomGenerator>
+#include <QSaveFile>
+#include <algorithm>
+
+namespace {
+// as many fully transparent and fully opaque pixels as partly transparent ones, the kernels have shortcuts for both
+QRgb randomPixel(QRandomGenerator& rng) {
+    const int pick = rng.bounded(4);
+    const int a = pick == 0 ? 0 : pick == 1 ? 255 : rng.bounded(256);
+    return qRgba(rng.bounded(a + 1), rng.bounded(a + 1), rng.bounded(a + 1), a);
+}
+
+QImage randomImage(QRandomGenerator& rng, int width, int height) {
+    QImage img{width, height, QImage::Format_ARGB32_Premultiplied};
+    for (int y = 0; y < height; y++) {
+        auto line = reinterpret_cast<QRgb*>(img.scanLine(y));
+        for (int x = 0; x < width; x++)
+            line[x] = randomPixel(rng);
+    }
+    return img;
+}
+
+QImage painted(QImage dst, const QPoint& pos, const QImage& src, const QRect& srcRect, bool half) {
+    QPainter p{&dst};
+    p.setCompositionMode(QPainter::CompositionMode_SourceOver);
+    if (half)
+        p.setOpacity(0.5);
+    p.drawImage(pos, src, srcRect);
+    p.end();
+    return dst;
+}
+
+qint64 differentPixels(const QImage& a, const QImage& b) {
+    qint64 count = 0;
+    for (int y = 0; y < a.height(); y++) {
+        auto la = reinterpret_cast<const QRgb*>(a.constScanLine(y));
+        auto lb = reinterpret_cast<const QRgb*>(b.constScanLine(y));
+        for (int x = 0; x < a.width(); x++)
+            count += la[x] != lb[x];
+    }
+    return count;
+}
+}
+
+double Regression::Baseline::toleranceFor(const QString& id) const {
+    return tolerances.value(id, tolerance);
+}
+
+bool Regression::Report::failed() const {
+    return slower > 0 || changedImages > 0 || differentSerializations > 0 || differentBlends > 0;
+}
+
+bool Regression::readBaseline(const QString& filename, Baseline& baseline, QString& error) {
+    QFile file{filename};
+    if (!file.open(QFile::OpenModeFlag::ReadOnly)) {
+        error = file.errorString();
+        return false;
+    }
+    QJsonParseError parseError{};
+    QJsonObject obj = QJsonDocument::fromJson(file.readAll(), &parseError).object();
+    if (parseError.error != QJsonParseError::NoError) {
+        error = QString::asprintf("Malformed JSON at offset %d: ", static_cast<int>(parseError.offset)) + parseError.errorString();
+        return false;
+    }
+    baseline = Baseline{};
+    baseline.tolerance = obj["tolerance"].toDouble(baseline.tolerance);
+    baseline.context = obj["context"].toObject();
+    const QJsonObject scenarios = obj["scenarios"].toObject();
+    for (auto it = scenarios.constBegin(); it != scenarios.constEnd(); ++it) {
+        const QJsonObject entry = it.value().toObject();
+        if (entry.contains("tolerance"))
+            baseline.tolerances.insert(it.key(), entry["tolerance"].toDouble());
+        if (entry.contains("median_ns"))
+            baseline.medians.insert(it.key(), entry["median_ns"].toDouble());
+    }
+    const QJsonObject images = obj["images"].toObject();
+    for (auto it = images.constBegin(); it != images.constEnd(); ++it)
+        baseline.images.insert(it.key(), it.value().toString());
+    return true;
+}
+
+bool Regression::writeBaseline(const QString& filename, const Baseline& baseline, QString& error) {
+    QJsonObject scenarios;
+    for (auto it = baseline.tolerances.constBegin(); it != baseline.tolerances.constEnd(); ++it) {
+        QJsonObject e = scenarios.value(it.key()).toObject();
+        e["tolerance"] = it.value();
+        scenarios[it.key()] = e;
+    }
+    for (auto it = baseline.medians.constBegin(); it != baseline.medians.constEnd(); ++it) {
+        QJsonObject e = scenarios.value(it.key()).toObject();
+        e["median_ns"] = it.value();
+        scenarios[it.key()] = e;
+    }
+    QJsonObject images;
+    for (auto it = baseline.images.constBegin(); it != baseline.images.constEnd(); ++it)
+        images[it.key()] = it.value();
+    QJsonObject obj{
+        {"tolerance", baseline.tolerance},
+        {"context", baseline.context},
+        {"scenarios", scenarios},
+        {"images", images},
+    };
+    QByteArray data = QJsonDocument{obj}.toJson();
+    QSaveFile out{filename};
+    if (!out.open(QIODevice::WriteOnly) || out.write(data) != data.size() || !out.commit()) {
+        error = out.errorString();
+        return false;
+    }
+    return true;
+}
+
+QString Regression::imageHash(const QImage& image) {
+    const QImage img = image.format() == SnesGFXConverter::TileFormat ? image : image.convertToFormat(SnesGFXConverter::TileFormat);
+    StructuralHash hash;
+    hash.add(static_cast<quint64>(img.width())).add(static_cast<quint64>(img.height()));
+    for (int y = 0; y < img.height(); y++) {
+        auto line = reinterpret_cast<const QRgb*>(img.constScanLine(y));
+        int x = 0;
+        for (; x + 2 <= img.width(); x += 2)
+            hash.add(static_cast<quint64>(line[x]) | static_cast<quint64>(line[x + 1]) << 32);
+        if (x < img.width())
+            hash.add(static_cast<quint64>(line[x]));
+    }
+    return QString::asprintf("%016llx", static_cast<unsigned long long>(hash.value()));
+}
+
+QHash<QString, QString> Regression::imageHashes(const QVector<QPair<QString, QImage>>& images) {
+    QHash<QString, QString> hashes;
+    for (auto& [name, image] : images)
+        hashes.insert(name, imageHash(image));
+    return hashes;
+}
+
+QVector<Regression::Serialization> Regression::serializations(const QVector<QPair<QString, JsonSprite>>& sprites) {
+    QVector<Serialization> result;
+    for (auto& [name, sprite] : sprites) {
+        for (bool compat : {true, false}) {
+            // serialize() fills obj, the copy keeps the case as it was for the other mode
+            JsonSprite tree = sprite;
+            tree.serialize(compat);
+            result.append({name + (compat ? "/compat" : "/plain"), QJsonDocument{tree.obj}.toJson(), sprite.serialize_stream(compat)});
+        }
+    }
+    return result;
+}
+
+QVector<Regression::BlendCheck> Regression::blendChecks() {
+    constexpr int rows = 4;
+    QVector<BlendCheck> checks;
+    for (const auto& kernels : AlphaBlend::availableKernels()) {
+        for (bool half : {false, true}) {
+            BlendCheck check{QString{kernels.name} + (half ? "/half" : "/over")};
+            QRandomGenerator rng{0x31};
+            const auto blend = half ? kernels.half : kernels.over;
+            // every width up to past the 8 pixel AVX2 vectors several times, so each tail length comes up,
+            // with source and destination misaligned by different amounts
+            for (int width = 1; width <= 37; width++) {
+                for (int offset = 0; offset < 8; offset++) {
+                    const int srcOffset = (offset * 3 + 1) % 8;
+                    const QImage src = randomImage(rng, width + 8, rows);
+                    QImage dst = randomImage(rng, width + 8, rows);
+                    const QImage expected = painted(dst, QPoint{offset, 0}, src, QRect{srcOffset, 0, width, rows}, half);
+                    for (int y = 0; y < rows; y++)
+                        blend(reinterpret_cast<quint32*>(dst.scanLine(y)) + offset,
+                              reinterpret_cast<const quint32*>(src.constScanLine(y)) + srcOffset, width);
+                    check.pixels += static_cast<qint64>(dst.width()) * rows;
+                    check.different += differentPixels(expected, dst);
+                }
+            }
+            checks.append(check);
+        }
+    }
+    // the kernel the cpu picked, with tiles partly outside of the canvas and source rects partly outside of the tile
+    for (bool half : {false, true}) {
+        BlendCheck check{half ? "blendImage/half" : "blendImage/over"};
+        QRandomGenerator rng{0x32};
+        for (int i = 0; i < 256; i++) {
+            const QImage src = randomImage(rng, 16, 16);
+            QImage dst = randomImage(rng, 24, 24);
+            const QPoint pos{rng.bounded(-12, 28), rng.bounded(-12, 28)};
+            const QRect srcRect{rng.bounded(-4, 12), rng.bounded(-4, 12), rng.bounded(1, 21), rng.bounded(1, 21)};
+            const QImage expected = painted(dst, pos, src, srcRect, half);
+            AlphaBlend::blendImage(dst, pos, src, srcRect, half);
+            check.pixels += static_cast<qint64>(dst.width()) * dst.height();
+            check.different += differentPixels(expected, dst);
+        }
+        checks.append(check);
+    }
+    return checks;
+}
+
+bool Regression::isSlower(const Baseline& baseline, const Benchmark::Measurement& m) {
+    const QString id = m.id();
+    auto it = baseline.medians.constFind(id);
+    if (it == baseline.medians.cend() || *it <= 0)
+        return false;
+    return m.medianNs > *it * (1 + baseline.toleranceFor(id));
+}
+
+Regression::Report Regression::compare(const Baseline& baseline, const QVector<Benchmark::Measurement>& results,
+                                       const QHash<QString, QString>& images, const QVector<Serialization>& serializations,
+                                       const QVector<BlendCheck>& blends, QTextStream& out) {
+    Report report;
+    out << QString::asprintf("%-44s %10s %10s %8s %5s  %s\n", "scenario", "baseline", "current", "change", "tol", "status");
+    for (auto& m : results) {
+        const QString id = m.id();
+        const double tolerance = baseline.toleranceFor(id);
+        report.scenarios++;
+        auto it = baseline.medians.constFind(id);
+        if (it == baseline.medians.cend() || *it <= 0) {
+            report.unrecorded++;
+            out << QString::asprintf("%-44s %10s %10s %8s %4.0f%%  NEW\n", qPrintable(id), "-",
+                                     qPrintable(Benchmark::formatNs(m.medianNs)), "-", tolerance * 100);
+            continue;
+        }
+        const double change = m.medianNs / *it - 1;
+        const char* status = "ok";
+        if (change > tolerance) {
+            report.slower++;
+            status = "SLOWER";
+        } else if (change < -tolerance) {
+            report.faster++;
+            status = "faster";
+        }
+        out << QString::asprintf("%-44s %10s %10s %+7.1f%% %4.0f%%  %s\n", qPrintable(id),
+                                 qPrintable(Benchmark::formatNs(*it)), qPrintable(Benchmark::formatNs(m.medianNs)),
+                                 change * 100, tolerance * 100, status);
+    }
+
+    // images recorded in the baseline but no longer produced are reported as changed as well
+    QStringList names = images.keys();
+    for (auto it = baseline.images.constBegin(); it != baseline.images.constEnd(); ++it) {
+        if (!images.contains(it.key()))
+            names.append(it.key());
+    }
+    std::sort(names.begin(), names.end());
+    out << '\n' << QString::asprintf("%-44s %16s %16s  %s\n", "image", "baseline", "current", "status");
+    for (auto& name : names) {
+        const QString expected = baseline.images.value(name);
+        const QString actual = images.value(name);
+        const char* status = "ok";
+        report.images++;
+        if (expected.isEmpty()) {
+            report.unrecordedImages++;
+            status = "NEW";
+        } else if (expected != actual) {
+            report.changedImages++;
+            status = actual.isEmpty() ? "MISSING" : "CHANGED";
+        }
+        out << QString::asprintf("%-44s %16s %16s  %s\n", qPrintable(name), expected.isEmpty() ? "-" : qPrintable(expected),
+                                 actual.isEmpty() ? "-" : qPrintable(actual), status);
+    }
+
+    out << '\n' << QString::asprintf("%-44s %10s %10s  %s\n", "serialization", "bytes", "differs at", "status");
+    for (auto& s : serializations) {
+        report.serializations++;
+        const auto mismatch = std::mismatch(s.expected.cbegin(), s.expected.cend(), s.actual.cbegin(), s.actual.cend());
+        const bool same = s.expected == s.actual;
+        if (!same)
+            report.differentSerializations++;
+        out << QString::asprintf("%-44s %10lld %10s  %s\n", qPrintable(s.name), static_cast<long long>(s.actual.size()),
+                                 same ? "-" : qPrintable(QString::number(mismatch.first - s.expected.cbegin())), same ? "ok" : "DIFFERENT");
+    }
+
+    out << '\n' << QString::asprintf("%-44s %10s %10s  %s\n", "blend", "pixels", "different", "status");
+    for (auto& b : blends) {
+        report.blends++;
+        if (b.different > 0)
+            report.differentBlends++;
+        out << QString::asprintf("%-44s %10lld %10lld  %s\n", qPrintable(b.name), static_cast<long long>(b.pixels),
+                                 static_cast<long long>(b.different), b.different > 0 ? "DIFFERENT" : "ok");
+    }
+    out << '\n' << QString::asprintf("%d scenarios: %d slower, %d faster, %d not recorded. %d images: %d changed, %d not recorded. "
+                                     "%d serializations: %d different. %d blend checks: %d different.\n",
+                                     report.scenarios, report.slower, report.faster, report.unrecorded,
+                                     report.images, report.changedImages, report.unrecordedImages,
+                                     report.serializations, report.differentSerializations, report.blends, report.differentBlends);
+    return report;
+}
+
+void Regression::update(Baseline& baseline, const QVector<Benchmark::Measurement>& results,
+                        const QHash<QString, QString>& images) {
+    for (auto& m : results)
+        baseline.medians.insert(m.id(), m.medianNs);
+    updateImages(baseline, images);
+    baseline.context = Benchmark::context();
+}
+
+void Regression::updateImages(Baseline& baseline, const QHash<QString, QString>& images) {
+    // images that aren't drawn anymore would otherwise fail every check as MISSING
+    baseline.images = images;
+}
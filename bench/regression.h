@@ -0,0 +1,79 @@
+#ifndef REGRESSION_H
+#define REGRESSION_H
+
+#include "benchmark.h"
+#include "jsonsprite.h"
+#include <QHash>
+#include <QImage>
+#include <QJsonObject>
+#include <QPair>
+#include <QTextStream>
+
+// Checks a run against a stored baseline: every median has to stay within its tolerance of the recorded one and
+// every golden image has to hash the same, so a change can't get faster by drawing something different, and the
+// streaming sprite writer has to write the same bytes as QJsonDocument. Every AlphaBlend kernel this cpu can run
+// has to blend exactly like QPainter.
+class Regression
+{
+public:
+    struct Baseline {
+        // allowed slowdown as a fraction of the recorded median, scenarios can override it
+        double tolerance = 0.15;
+        QHash<QString, double> tolerances;
+        // median per call in ns, keyed by Scenario::id()
+        QHash<QString, double> medians;
+        QHash<QString, QString> images;
+        // the machine the medians were recorded on, only there for whoever reads the file
+        QJsonObject context;
+        double toleranceFor(const QString& id) const;
+    };
+    struct Report {
+        int scenarios = 0;
+        int slower = 0;
+        int faster = 0;
+        int unrecorded = 0;
+        int images = 0;
+        int changedImages = 0;
+        int unrecordedImages = 0;
+        int serializations = 0;
+        int differentSerializations = 0;
+        int blends = 0;
+        int differentBlends = 0;
+        bool failed() const;
+    };
+    // one sprite written by JsonSprite::serialize_stream and by QJsonDocument from serialize()'s object
+    struct Serialization {
+        QString name;
+        QByteArray expected;
+        QByteArray actual;
+    };
+    // random premultiplied pixels blended by one kernel and by QPainter's SourceOver, opacity 0.5 for "/half"
+    struct BlendCheck {
+        QString name;
+        qint64 pixels = 0;
+        qint64 different = 0;
+    };
+    // a missing "median_ns" or image just means that entry hasn't been recorded yet
+    static bool readBaseline(const QString& filename, Baseline& baseline, QString& error);
+    static bool writeBaseline(const QString& filename, const Baseline& baseline, QString& error);
+    // stable across machines and Qt versions, only the size and the premultiplied pixels go in
+    static QString imageHash(const QImage& image);
+    static QHash<QString, QString> imageHashes(const QVector<QPair<QString, QImage>>& images);
+    // every sprite in both translucency modes, named "<sprite>/compat" and "<sprite>/plain"
+    static QVector<Serialization> serializations(const QVector<QPair<QString, JsonSprite>>& sprites);
+    // "<kernel>/over" and "<kernel>/half" for every kernel, then AlphaBlend::blendImage with clipping
+    static QVector<BlendCheck> blendChecks();
+    static bool isSlower(const Baseline& baseline, const Benchmark::Measurement& m);
+    // prints a table with one line per scenario, image, serialization and blend check followed by a summary line
+    // the serializations and blend checks don't need a baseline, they have to match exactly
+    static Report compare(const Baseline& baseline, const QVector<Benchmark::Measurement>& results,
+                          const QHash<QString, QString>& images, const QVector<Serialization>& serializations,
+                          const QVector<BlendCheck>& blends, QTextStream& out);
+    // records the medians and hashes of this run, the tolerances are kept
+    static void update(Baseline& baseline, const QVector<Benchmark::Measurement>& results,
+                       const QHash<QString, QString>& images);
+    // records only the hashes, they are the same on every machine so they can be recorded anywhere
+    static void updateImages(Baseline& baseline, const QHash<QString, QString>& images);
+};
+
+#endif // REGRESSION_H
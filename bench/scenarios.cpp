@@ -0,0 +1,270 @@
+#include "scenarios.h"
+#include "cfgeditor.h"
+#include "clipboardtile.h"
+#include "corpusgenerator.h"
+#include "displayrenderer.h"
+#include "map16format.h"
+#include "map16graphicsview.h"
+#include "map16provider.h"
+#include "snesgfxconverter.h"
+#include "spritepalettecreator.h"
+#include <QJsonArray>
+#include <memory>
+
+namespace {
+// the state the editor starts with: sprite palettes and the forest GFX set
+void loadDefaultGraphics() {
+    SpritePaletteCreator::ReadPaletteFile(0, 16);
+    SnesGFXConverter::populateFullMap16Data({"GFX00", "GFX01", "GFX13", "GFX02"});
+}
+
+std::shared_ptr<Map16GraphicsView> defaultMap16View() {
+    loadDefaultGraphics();
+    auto view = std::make_shared<Map16GraphicsView>();
+    view->readInternalMap16File();
+    return view;
+}
+
+QVector<FullTile> internalTiles() {
+    Map16Format::Table table;
+    QString error;
+    Map16Format::readFile(":/Resources/spriteMapData.map16", table, error);
+    QVector<FullTile> tiles;
+    tiles.reserve(table.tiles.size());
+    for (auto& t : table.tiles)
+        tiles.append(FullTile{t[0], t[1], t[2], t[3], false});
+    return tiles;
+}
+
+void addMicro(QVector<Benchmark::Scenario>& list, const QString& name, int scale, std::function<Benchmark::Body()> setup) {
+    list.append({name, "micro", scale, std::move(setup)});
+}
+
+void addMacro(QVector<Benchmark::Scenario>& list, const QString& name, int scale, std::function<Benchmark::Body()> setup) {
+    list.append({name, "macro", scale, std::move(setup)});
+}
+}
+
+QVector<Benchmark::Scenario> allScenarios(Fixtures& fixtures) {
+    QVector<Benchmark::Scenario> list;
+    constexpr int spriteScales[]{1, 16, 128};
+    constexpr int tileScales[]{16, 64, 256};
+
+    // 8x8 decoding, scale is the number of tiles decoded per call
+    addMicro(list, "decode.get8x8TileFromVect", 512, []() -> Benchmark::Body {
+        loadDefaultGraphics();
+        return []() {
+            const auto& palette = SpritePaletteCreator::getPalette(8);
+            for (int i = 0; i < 512; i++)
+                doNotOptimize(SnesGFXConverter::get8x8TileFromVect(i, palette));
+        };
+    });
+    addMicro(list, "decode.get8x8TileFromExternal", 1024, [&fixtures]() -> Benchmark::Body {
+        loadDefaultGraphics();
+        SnesGFXConverter::populateExternalMap16Data({fixtures.externalGfxFile()});
+        return []() {
+            const auto& palette = SpritePaletteCreator::getPalette(8);
+            for (int i = 0; i < 1024; i++)
+                doNotOptimize(SnesGFXConverter::get8x8TileFromExternal(i, palette, 0));
+        };
+    });
+    for (bool translucent : {false, true}) {
+        addMicro(list, translucent ? "tile.getFullTile.translucent" : "tile.getFullTile", Map16Format::InternalTiles, [translucent]() -> Benchmark::Body {
+            loadDefaultGraphics();
+            auto tiles = std::make_shared<QVector<FullTile>>(internalTiles());
+            return [tiles, translucent]() {
+                for (auto& t : *tiles)
+                    doNotOptimize(t.getFullTile(translucent));
+            };
+        });
+    }
+    addMicro(list, "gfx.fromResource", 1, []() -> Benchmark::Body {
+        loadDefaultGraphics();
+        return []() {
+            doNotOptimize(SnesGFXConverter::fromResource(":/Resources/Graphics/GFX00.bin", SpritePaletteCreator::getPalette(8)));
+        };
+    });
+
+    // map16 parsing and the sprite's Map16 field, scale is in 16x16 tiles
+    addMicro(list, "map16.parse", Map16Format::InternalTiles, []() -> Benchmark::Body {
+        return []() {
+            Map16Format::Table table;
+            QString error;
+            Map16Format::readFile(":/Resources/spriteMapData.map16", table, error);
+            doNotOptimize(table);
+        };
+    });
+    for (int pages : {4, 16, 64}) {
+        addMicro(list, "map16.parseFile", pages * CorpusGenerator::TilesPerPage, [&fixtures, pages]() -> Benchmark::Body {
+            auto path = fixtures.map16File(pages);
+            return [path]() {
+                Map16Format::Table table;
+                QString error;
+                Map16Format::readFile(path, table, error);
+                doNotOptimize(table);
+            };
+        });
+    }
+    // loading a custom map16 into the editor's sheet, which draws every tile
+    for (int pages : {4, 16}) {
+        addMicro(list, "map16.readExternalMap16File", pages * CorpusGenerator::TilesPerPage, [&fixtures, pages]() -> Benchmark::Body {
+            auto view = defaultMap16View();
+            auto path = fixtures.map16File(pages);
+            return [view, path]() {
+                view->readExternalMap16File(path);
+            };
+        });
+    }
+    addMicro(list, "map16.readInternalMap16File", Map16Format::InternalTiles, []() -> Benchmark::Body {
+        auto view = defaultMap16View();
+        return [view]() {
+            view->readInternalMap16File();
+        };
+    });
+    for (int tiles : tileScales) {
+        addMicro(list, "map16.setMap16", tiles, [tiles]() -> Benchmark::Body {
+            auto view = defaultMap16View();
+            auto data = Fixtures::map16Base64(tiles);
+            return [view, data]() {
+                view->setMap16(data);
+            };
+        });
+        addMicro(list, "map16.getMap16", tiles, [tiles]() -> Benchmark::Body {
+            auto view = defaultMap16View();
+            view->setMap16(Fixtures::map16Base64(tiles));
+            return [view]() {
+                doNotOptimize(view->getMap16());
+            };
+        });
+        // getMap16 is cached until a tile changes, this is what a miss costs
+        addMicro(list, "map16.encodeBase64", tiles, [tiles]() -> Benchmark::Body {
+            QVector<Map16Tile> decoded;
+            QString error;
+            Map16Format::decodeBase64(Fixtures::map16Base64(tiles), decoded, error);
+            return [decoded]() {
+                doNotOptimize(Map16Format::encodeBase64(decoded));
+            };
+        });
+    }
+
+    // sprite files, scale is the number of displays (16 tiles each) with a full page of Map16
+    for (const char* ext : {".json", ".cfg"}) {
+        const QString extension{ext};
+        const QString suffix = extension.mid(1);
+        for (int displays : spriteScales) {
+            addMicro(list, "sprite.load." + suffix, displays, [&fixtures, extension, displays]() -> Benchmark::Body {
+                auto path = fixtures.spriteFile(extension, displays, 16, 256);
+                return [path]() {
+                    JsonSprite sprite;
+                    QString error;
+                    sprite.load_file(path, error);
+                    doNotOptimize(sprite.displays);
+                };
+            });
+            addMicro(list, "sprite.save." + suffix, displays, [&fixtures, extension, displays]() -> Benchmark::Body {
+                auto sprite = std::make_shared<JsonSprite>(Fixtures::sprite(displays, 16, 256, displays));
+                auto path = fixtures.scratchFile(QString::asprintf("save_%d", displays) + extension);
+                return [sprite, path]() {
+                    sprite->to_file(path, false);
+                };
+            });
+        }
+    }
+
+    // display composition, scale is the number of tiles in the display
+    for (int tiles : tileScales) {
+        addMicro(list, "provider.redraw", tiles, [tiles]() -> Benchmark::Body {
+            auto view = defaultMap16View();
+            auto provider = std::make_shared<Map16Provider>();
+            provider->attachMap16View(view.get());
+            JsonSprite sprite = Fixtures::sprite(1, tiles, 0, 0);
+            provider->deserializeDisplays(sprite.displays, view.get());
+            provider->changeDisplay(0);
+            // the provider keeps a pointer to the view, so the body holds on to both
+            return [view, provider]() {
+                provider->redraw();
+            };
+        });
+        addMicro(list, "renderer.display", tiles, [tiles]() -> Benchmark::Body {
+            auto sprite = std::make_shared<JsonSprite>(Fixtures::sprite(1, tiles, 0, 0));
+            return [sprite]() {
+                // a new renderer every call, so its tile cache doesn't hide the decoding
+                DisplayRenderer renderer;
+                QString error;
+                renderer.setGraphics(GFXInfo{}, error);
+                doNotOptimize(renderer.render(sprite->displays.first()));
+            };
+        });
+    }
+
+    // whole user actions
+    addMacro(list, "editor.loadFullbitmap", 1, []() -> Benchmark::Body {
+        auto editor = std::make_shared<CFGEditor>(QStringList{});
+        return [editor]() {
+            editor->loadFullbitmap();
+        };
+    });
+    for (int displays : {16, 128}) {
+        addMacro(list, "editor.openSprite", displays, [&fixtures, displays]() -> Benchmark::Body {
+            auto path = fixtures.spriteFile(".json", displays, 16, 256);
+            return [path]() {
+                CFGEditor editor{QStringList{path}};
+            };
+        });
+    }
+    return list;
+}
+
+QVector<QPair<QString, QImage>> goldenImages() {
+    QVector<QPair<QString, QImage>> images;
+    JsonSprite sprite = Fixtures::sprite(16, 16, 256, 0);
+    auto view = defaultMap16View();
+    images.append({"map16.sheet.internal", view->sheetImage()});
+    view->setMap16(sprite.map16);
+    images.append({"map16.sheet.custom", view->sheetImage()});
+
+    Map16Provider provider;
+    provider.attachMap16View(view.get());
+    provider.deserializeDisplays(sprite.displays, view.get());
+    DisplayRenderer renderer;
+    QString error;
+    renderer.setMap16(sprite.map16, error);
+    for (int i = 0; i < sprite.displays.size(); i++) {
+        const auto& display = sprite.displays[i];
+        // text displays are drawn on a separate layer, the canvas only has the tiles
+        if (!display.useText)
+            images.append({QString::asprintf("provider.canvas/%d", i), provider.canvas(i)});
+        renderer.setGraphics(display.gfxinfo, error);
+        images.append({QString::asprintf("renderer.display/%d", i), renderer.render(display)});
+    }
+    return images;
+}
+
+QVector<QPair<QString, JsonSprite>> serializerCases(Fixtures& fixtures) {
+    QVector<QPair<QString, JsonSprite>> cases;
+    for (int displays : {1, 16, 128})
+        cases.append({QString::asprintf("corpus/%d", displays), Fixtures::sprite(displays, 16, 256, displays)});
+    for (const char* ext : {".json", ".cfg"}) {
+        JsonSprite loaded;
+        QString error;
+        if (loaded.load_file(fixtures.spriteFile(ext, 16, 16, 256), error))
+            cases.append({QString{"loaded"} + ext, loaded});
+    }
+
+    cases.append({"empty", JsonSprite{}});
+
+    JsonSprite odd = Fixtures::sprite(4, 4, 16, 2);
+    odd.asmfile = "  sprites/ünïcödé \"quoted\" \\ path.asm  ";
+    odd.dispType = DisplayType::ExtraByte;
+    // the display text goes through the same escaping as every other string
+    odd.addDisplay(JSONDisplay{"Text \u00e9\u20ac\U0001F600", {}, true, 3, 0xFF, true,
+                               "line 1\nline 2\ttab \x01\x1f\x7f </script> \u2028", GFXInfo{}});
+    odd.addDisplay(JSONDisplay{"", {Tile{-128, 127, 0x3FF, true}, Tile{0, 0, 0, false}}, false, 0, 0, false, "", GFXInfo{}});
+    odd.collections.first().name = QString::fromUtf8("Colecci\xc3\xb3n \"1\"\r\n");
+    // keys the editor doesn't know about, before, between and after its own
+    odd.obj["$0000"] = QJsonArray{1, 2.5, "x", QJsonValue::Null, true};
+    odd.obj["Author"] = QJsonObject{{"name", QString::fromUtf8("J\xc3\xb6rg")}, {"nested", QJsonObject{{"empty", QJsonArray{}}}}};
+    odd.obj["Zzz"] = 1e300;
+    cases.append({"hand-made", odd});
+    return cases;
+}
@@ -0,0 +1,21 @@
+#ifndef SCENARIOS_H
+#define SCENARIOS_H
+
+#include "benchmark.h"
+#include "fixtures.h"
+#include <QImage>
+#include <QPair>
+
+// Every benchmark of the suite. The scenarios only reference the fixtures, so the returned list has to be
+// used while fixtures is alive. Widget scenarios need a QApplication.
+QVector<Benchmark::Scenario> allScenarios(Fixtures& fixtures);
+// Pictures a performance change must not alter: the map16 sheet with and without a sprite's own tiles and the
+// display canvases of a generated sprite, drawn by both Map16Provider and DisplayRenderer. Starts from the
+// default graphics, so it can be called before or after the scenarios ran.
+QVector<QPair<QString, QImage>> goldenImages();
+// Sprites JsonSprite::serialize_stream has to write byte for byte like QJsonDocument writes the object serialize()
+// builds: the corpus fixtures, loaded back from their files, and hand made ones with text displays, unknown
+// top level keys and strings with non-ASCII and control characters.
+QVector<QPair<QString, JsonSprite>> serializerCases(Fixtures& fixtures);
+
+#endif // SCENARIOS_H
@@ -1,25 +1,46 @@
 #include "cfgeditor.h"
 #include "./ui_cfgeditor.h"
 #include "eightbyeightview.h"
+#include "tracing.h"
 #include <QStyledItemDelegate>
 
 CFGEditor::CFGEditor(const QStringList& argv, QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::CFGEditor)
     , sprite(new JsonSprite)
-    , original(new JsonSprite)
     , hexValidator(new QRegularExpressionValidator{QRegularExpression(R"([A-Fa-f0-9]+)")})
     , hexNumberList(new QStringList(0x100))
     , copiedTile()
-    , displays()
 {
     setWindowIcon(QIcon{":/VioletEgg.ico"});
     ui->setupUi(this);
     statusBar()->setSizeGripEnabled(false);
+    perfHud = new PerfHud(this);
+    statusBar()->addPermanentWidget(perfHud, 1);
+    // CFGEDITOR_HUD turns it on from the start, e.g. to see what loading a sprite costs
+    perfHud->setActive(qEnvironmentVariableIsSet("CFGEDITOR_HUD"));
     setUpImages();
     view8x8Container = new EightByEightViewContainer(new EightByEightView(new QGraphicsScene), this->ui->paletteComboBox);
     paletteContainer = new PaletteContainer(new PaletteView(new QGraphicsScene));
     ui->labelDisplayTilesGrid->attachMap16View(ui->map16GraphicsView);
+    recorder = new InteractionRecorder(interactionTargets(), this);
+    saver = new SpriteSaver(this);
+    QObject::connect(saver, &SpriteSaver::saved, this, [this](const QString& name, bool written, quint64) {
+        statusBar()->showMessage(written ? "Saved " + name : name + " is already up to date", 3000);
+    });
+    QObject::connect(saver, &SpriteSaver::failed, this, [this](const QString& name, const QString& error, quint64 saved) {
+        // a later save that is still running has the same changes, it decides
+        // after New or Open the failed save was of another sprite, the one open now is as unmodified as it was
+        if (saved == document && !saver->isSaving())
+            tracker.markUnsaved();
+        DefaultAlertImpl(this, "Could not save " + name + ": " + error)();
+    });
+    QObject::connect(ui->labelDisplayTilesGrid, &Map16Provider::displayTilesEdited, this, [this]() {
+        tracker.touch(SpriteSection::Displays);
+    });
+    QObject::connect(ui->map16GraphicsView, &Map16GraphicsView::map16Edited, this, [this]() {
+        tracker.touch(SpriteSection::Map16);
+    });
     loadFullbitmap();
     ui->map16GraphicsView->setControllingLabel(ui->labelTileNo);
     QMenuBar* mb = menuBar();
@@ -39,15 +60,15 @@ CFGEditor::CFGEditor(const QStringList& argv, QWidget *parent)
     if (argv.size() > 0) {
         sprite->from_file(argv[0]);
         resetTweaks();
-        std::for_each(sprite->collections.cbegin(), sprite->collections.cend(), [&](auto& coll) {
-            collectionModel->appendRow(CollectionDataModel::fromCollection(coll));
-        });
+        collectionModel->setCollections(sprite->collections);
         ui->checkBoxDisplayExtraByte->setChecked(sprite->dispType == DisplayType::ExtraByte);
         ui->map16GraphicsView->setMap16(sprite->map16);
         ui->labelDisplayTilesGrid->deserializeDisplays(sprite->displays, ui->map16GraphicsView);
         populateDisplays();
-        *original = *sprite;
     }
+    // the first sheet is drawn before the window shows, later redraws (palette, GFX) don't hold up the editor
+    ui->map16GraphicsView->setBackgroundRendering(true);
+    markSaved();
 }
 
 void CFGEditor::deleteInstaller() {
@@ -66,7 +87,7 @@ void CFGEditor::closeEvent(QCloseEvent *event) {
 
         if (reply == QMessageBox::Save) {
             saveSprite();
-            sprite->to_file("", ui->compatForTranslucencyCheckBox->isChecked());
+            writeSprite();
             event->accept();
         } else if (reply == QMessageBox::Cancel) {
             event->ignore();
@@ -76,6 +97,11 @@ void CFGEditor::closeEvent(QCloseEvent *event) {
     } else {
         event->accept();
     }
+    // the file has to be on disk before the editor goes away, the failure is shown once the event loop gets to it
+    if (event->isAccepted() && !saver->waitForDone()) {
+        event->ignore();
+        return;
+    }
     view8x8Container->close();
     paletteContainer->close();
     QMainWindow::closeEvent(event);
@@ -91,6 +117,7 @@ void CFGEditor::initCompleter() {
 }
 
 void CFGEditor::loadFullbitmap(int index, bool justPalette) {
+    TRACE_SCOPE("CFGEditor::loadFullbitmap");
     if (index == -1)
         index = ui->paletteComboBox->currentIndex();
     QVector<QString> gfxFiles{ui->lineEditGFXSp0->text(), ui->lineEditGFXSp1->text(), ui->lineEditGFXSp2->text(), ui->lineEditGFXSp3->text()};
@@ -98,6 +125,7 @@ void CFGEditor::loadFullbitmap(int index, bool justPalette) {
         delete full8x8Bitmap;
     }
     full8x8Bitmap = new QImage{128, 256, QImage::Format_RGB32};
+    tileBitmapMemory.update(full8x8Bitmap->sizeInBytes());
     QPainter p{full8x8Bitmap};
     p.setCompositionMode(QPainter::CompositionMode::CompositionMode_SourceOver);
     int i = 0;
@@ -121,16 +149,37 @@ void CFGEditor::loadFullbitmap(int index, bool justPalette) {
 }
 
 bool CFGEditor::hasModification() {
-    JsonSprite tmp{*sprite};
-    tmp.displays.clear();
-    tmp.collections.clear();
-    QVector<DisplayData> tmpdisplays{displays};
-    ui->labelDisplayTilesGrid->serializeDisplays(tmpdisplays);
-    for (auto& disp : tmpdisplays)
-        tmp.addDisplay(createDisplay(disp));
-    tmp.setMap16(ui->map16GraphicsView->getMap16());
-    tmp.addCollections(ui->tableView);
-    return tmp.is_different(*original);
+    TRACE_SCOPE("CFGEditor::hasModification");
+    if (!tracker.anyDirty())
+        return false;
+    // only the sections edited since the last save get hashed, cheapest first
+    if (tracker.isModified(SpriteSection::Tweaks, [this]() { return sprite->tweaks_hash(); }))
+        return true;
+    if (tracker.isModified(SpriteSection::Map16, [this]() {
+            JsonSprite tmp{};
+            tmp.setMap16(ui->map16GraphicsView->getMap16());
+            return tmp.map16_hash();
+        }))
+        return true;
+    if (tracker.isModified(SpriteSection::Collections, [this]() {
+            JsonSprite tmp{};
+            tmp.collections = collectionModel->collections();
+            return tmp.collections_hash();
+        }))
+        return true;
+    return tracker.isModified(SpriteSection::Displays, [this]() {
+        JsonSprite tmp{};
+        tmp.dispType = sprite->dispType;
+        QVector<DisplayData> tmpdisplays{displayModel->displays()};
+        ui->labelDisplayTilesGrid->serializeDisplays(tmpdisplays);
+        for (auto& disp : tmpdisplays)
+            tmp.addDisplay(createDisplay(disp));
+        return tmp.displays_hash();
+    });
+}
+
+void CFGEditor::markSaved() {
+    tracker.markSaved({sprite->tweaks_hash(), sprite->displays_hash(), sprite->collections_hash(), sprite->map16_hash()});
 }
 
 void CFGEditor::setUpMenuBar(QMenuBar* mb) {
@@ -144,14 +193,14 @@ void CFGEditor::setUpMenuBar(QMenuBar* mb) {
                                              QMessageBox::Save | QMessageBox::No | QMessageBox::Cancel );
             if (res == QMessageBox::Save) {
                 saveSprite();
-                sprite->to_file("", ui->compatForTranslucencyCheckBox->isChecked());
+                writeSprite();
             } else if (res == QMessageBox::Cancel) {
                 return;
             }
         }
         resetAll();
         resetTweaks();
-        *original = *sprite;
+        markSaved();
     });
 
     file->addSeparator();
@@ -164,7 +213,7 @@ void CFGEditor::setUpMenuBar(QMenuBar* mb) {
                                              QMessageBox::Save | QMessageBox::No | QMessageBox::Cancel );
             if (res == QMessageBox::Save) {
                 saveSprite();
-                sprite->to_file("", ui->compatForTranslucencyCheckBox->isChecked());
+                writeSprite();
             } else if (res == QMessageBox::Cancel) {
                 return;
             }
@@ -173,20 +222,19 @@ void CFGEditor::setUpMenuBar(QMenuBar* mb) {
         auto file = QFileDialog::getOpenFileName(this, tr("Open file"), "", tr("JSON (*.json);;CFG (*.cfg)"));
         sprite->from_file(file);
         resetTweaks();
-        std::for_each(sprite->collections.cbegin(), sprite->collections.cend(), [&](auto& coll) {
-            collectionModel->appendRow(CollectionDataModel::fromCollection(coll));
-        });
+        collectionModel->setCollections(sprite->collections);
         ui->checkBoxDisplayExtraByte->setChecked(sprite->dispType == DisplayType::ExtraByte);
         ui->map16GraphicsView->setMap16(sprite->map16);
         ui->labelDisplayTilesGrid->deserializeDisplays(sprite->displays, ui->map16GraphicsView);
         populateDisplays();
-        *original = *sprite;
+        markSaved();
     });
 
     file->addAction("&Save", Qt::CTRL | Qt::Key_S, qApp, [&]() {
         saveSprite();
-        sprite->to_file("", ui->compatForTranslucencyCheckBox->isChecked());
-        *original = *sprite;
+        // cancelling the file dialog leaves the changes unsaved
+        if (writeSprite())
+            markSaved();
     });
 
     file->addAction("&Save As", Qt::CTRL | Qt::ALT | Qt::Key_S, qApp, [&]() {
@@ -194,8 +242,8 @@ void CFGEditor::setUpMenuBar(QMenuBar* mb) {
         auto filename = QFileDialog::getSaveFileName(this, tr("Save file"), sprite->name(), tr("JSON (*.json);;CFG (*.cfg)"));
         if (filename.size() == 0)
             return;
-        sprite->to_file(filename, ui->compatForTranslucencyCheckBox->isChecked());
-        *original = *sprite;
+        saver->save(*sprite, filename, ui->compatForTranslucencyCheckBox->isChecked(), document);
+        markSaved();
     });
 
     display->addAction("&Load Custom Map16", qApp, [&]() {
@@ -227,17 +275,47 @@ void CFGEditor::setUpMenuBar(QMenuBar* mb) {
         qDebug() << "Opening external gfx file loader";
         ui->map16GraphicsView->loadExternalGraphics();
     });
+    display->addSeparator();
+    QAction* hud = display->addAction("Performance &HUD");
+    hud->setCheckable(true);
+    hud->setChecked(perfHud->isActive());
+    QObject::connect(hud, &QAction::toggled, perfHud, &PerfHud::setActive);
+    display->addAction("&Memory Usage", qApp, [&]() {
+        const QString dump = MemoryAccounting::dump();
+        qInfo().noquote() << dump;
+        QMessageBox box{QMessageBox::Information, "Memory usage", "<pre>" + dump.toHtmlEscaped() + "</pre>", QMessageBox::Ok | QMessageBox::Reset, this};
+        box.button(QMessageBox::Reset)->setText("Reset peaks");
+        if (box.exec() == QMessageBox::Reset)
+            MemoryAccounting::resetPeaks();
+    });
+    QAction* record = display->addAction("&Record Interactions");
+    record->setCheckable(true);
+    QObject::connect(record, &QAction::toggled, this, [this](bool on) {
+        if (on) {
+            recorder->start(spriteSnapshot(), currentDisplay(), size());
+            statusBar()->showMessage("Recording interactions");
+            return;
+        }
+        auto recording = recorder->stop();
+        statusBar()->clearMessage();
+        QString name = QFileDialog::getSaveFileName(this, tr("Save recording"), "", tr("Recording (*.json)"));
+        if (name.length() == 0)
+            return;
+        QString error;
+        if (!InteractionRecorder::write(name, recording, error))
+            DefaultAlertImpl(this, "Could not save the recording: " + error)();
+    });
 
     mb->addMenu(file);
     mb->addMenu(display);
 }
 
 void CFGEditor::resetAll() {
+    // New and Open both start here, saves started before are of the previous sprite
+    document++;
     sprite->reset();
-    ui->tableView->model()->removeRows(0, ui->tableView->model()->rowCount());
-    ui->tableViewDisplays->model()->removeRows(0, ui->tableViewDisplays->model()->rowCount());
-    ui->tableViewGfxInfo->model()->removeRows(0, ui->tableViewGfxInfo->model()->rowCount());
-    displays.clear();
+    collectionModel->setCollections({});
+    displayModel->setDisplays({});
     currentDisplayIndex = -1;
     ui->labelDisplayTilesGrid->reset();
     ui->checkBoxDisplayExtraByte->setChecked(false);
@@ -245,23 +323,56 @@ void CFGEditor::resetAll() {
 
 void CFGEditor::saveSprite() {
     sprite->displays.clear();
-    sprite->collections.clear();
-    ui->labelDisplayTilesGrid->serializeDisplays(displays);
-    for (auto& disp : displays)
+    ui->labelDisplayTilesGrid->serializeDisplays(displayModel->editDisplays());
+    displayModel->updateMemory();
+    for (auto& disp : displayModel->displays())
         sprite->addDisplay(createDisplay(disp));
     sprite->setMap16(ui->map16GraphicsView->getMap16());
-    sprite->addCollections(ui->tableView);
+    sprite->collections = collectionModel->collections();
+}
+
+bool CFGEditor::writeSprite() {
+    QString name = sprite->name();
+    if (name.length() == 0)
+        name = QFileDialog::getSaveFileName(this, tr("Save file"), "", tr("JSON (*.json);;CFG (*.cfg)"));
+    if (name.length() == 0)
+        return false;
+    return saver->save(*sprite, name, ui->compatForTranslucencyCheckBox->isChecked(), document);
+}
+
+QVector<QPair<QString, QWidget*>> CFGEditor::interactionTargets() const {
+    // scroll areas get mouse events on their viewport and key events on themselves
+    return {
+        {"display", ui->labelDisplayTilesGrid},
+        {"map16", ui->map16GraphicsView->viewport()},
+        {"map16.keys", ui->map16GraphicsView},
+        {"text", ui->textEditDisplayText->viewport()},
+        {"text.keys", ui->textEditDisplayText},
+    };
+}
+
+void CFGEditor::selectDisplay(int index) {
+    if (index >= 0 && index < displayModel->rowCount())
+        ui->tableViewDisplays->setCurrentIndex(displayModel->index(index, 0));
+}
+
+int CFGEditor::currentDisplay() const {
+    return currentDisplayIndex;
+}
+
+QByteArray CFGEditor::spriteSnapshot() {
+    saveSprite();
+    return sprite->to_text("snapshot.json", ui->compatForTranslucencyCheckBox->isChecked());
 }
 
 void CFGEditor::populateDisplays() {
     currentDisplayIndex = -1;
-    for (auto& d : sprite->displays) {
-        DisplayData display{d};
-        displays.append(display);
-        displayModel->appendRow(display.itemsFromDisplay());
-        gfxinfoModel->appendRow(display.GFXInfo().itemsFromGFXInfo());
-    }
-    if (!displays.isEmpty())
+    QVector<DisplayData> loaded;
+    loaded.reserve(sprite->displays.size());
+    for (auto& d : sprite->displays)
+        loaded.emplaceBack(d);
+    displayModel->setDisplays(std::move(loaded));
+    if (displayModel->rowCount() > 0)
         ui->tableViewDisplays->setCurrentIndex(displayModel->index(0, 0));
     else
         refreshDisplayPanels();
@@ -282,109 +393,67 @@ JSONDisplay CFGEditor::createDisplay(const DisplayData& data) {
     return {data.Description(), tiles, data.ExtraBit(), data.XOrIndex(), data.YOrValue(), data.UseText(), data.DisplayText(), info};
 }
 
-QVector<QStandardItem*> CollectionDataModel::getRow(void* ui) {
-    QVector<QStandardItem*> data{};
-    if (ui == nullptr) {
-        data.append(new QStandardItem(m_name));
-        data.append(new QStandardItem(m_extrabit ? "True" : "False"));
-        for (int i = 0; i < 12; i++) {
-            data.append(new QStandardItem(QString::asprintf("%02X", m_bytes[i])));
-        }
-    } else {
-        // this is horrific
-        auto ed = (Ui::CFGEditor*)ui;
-        data.append(new QStandardItem(ed->lineEditCollName->text()));
-        data.append(new QStandardItem(ed->checkBoxCollExtrabit->isChecked() ? "True" : "False"));
-        data.append(new QStandardItem(ed->lineEditCollExByte1->text()));
-        data.append(new QStandardItem(ed->lineEditCollExByte2->text()));
-        data.append(new QStandardItem(ed->lineEditCollExByte3->text()));
-        data.append(new QStandardItem(ed->lineEditCollExByte4->text()));
-        data.append(new QStandardItem(ed->lineEditCollExByte5->text()));
-        data.append(new QStandardItem(ed->lineEditCollExByte6->text()));
-        data.append(new QStandardItem(ed->lineEditCollExByte7->text()));
-        data.append(new QStandardItem(ed->lineEditCollExByte8->text()));
-        data.append(new QStandardItem(ed->lineEditCollExByte9->text()));
-        data.append(new QStandardItem(ed->lineEditCollExByte10->text()));
-        data.append(new QStandardItem(ed->lineEditCollExByte11->text()));
-        data.append(new QStandardItem(ed->lineEditCollExByte12->text()));
-    }
-    return data;
-}
-
 void CFGEditor::setDisplayModel() {
     ui->textEditDisplayText->setReadOnly(true);
-    displayModel = new QStandardItemModel;
-    QStringList labelList{"ExtraBit", "X", "Y"};
-    displayModel->setHorizontalHeaderLabels(labelList);
+    displayModel = new DisplayTableModel;
     ui->tableViewDisplays->setModel(displayModel);
+    for (int column = DisplayTableModel::Sp0; column < DisplayTableModel::ColumnCount; column++)
+        ui->tableViewDisplays->setColumnHidden(column, true);
     ui->tableViewDisplays->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
-    ui->tableViewDisplays->horizontalHeader()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
+    ui->tableViewDisplays->horizontalHeader()->setSectionResizeMode(DisplayTableModel::ExtraBit, QHeaderView::ResizeToContents);
     ui->tableViewDisplays->setHorizontalScrollBarPolicy(Qt::ScrollBarPolicy::ScrollBarAlwaysOff);
     ui->tableViewDisplays->setVerticalScrollBarPolicy(Qt::ScrollBarPolicy::ScrollBarAsNeeded);
+    QObject::connect(displayModel, &DisplayTableModel::dataChanged, this, [this]() {
+        tracker.touch(SpriteSection::Displays);
+    });
+    QObject::connect(displayModel, &DisplayTableModel::rowsMoved, this, [this](const QModelIndex&, int first, int last, const QModelIndex&, int before) {
+        const int count = last - first + 1;
+        ui->labelDisplayTilesGrid->moveDisplays(first, count, before);
+        if (currentDisplayIndex != -1)
+            currentDisplayIndex = static_cast<int>(movedIndex(currentDisplayIndex, first, count, before));
+        tracker.touch(SpriteSection::Displays);
+    });
 }
 
+// hex line edits for the GFX file numbers, the separate check boxes keep the default editor
 class CustomItemDelegate : public QStyledItemDelegate {
     QValidator* m_validator = nullptr;
-    QStandardItemModel* m_model = nullptr;
 public:
-    CustomItemDelegate(QStandardItemModel* model, QObject* parent = nullptr, QValidator* validator = nullptr) : QStyledItemDelegate(parent) {
+    CustomItemDelegate(QObject* parent = nullptr, QValidator* validator = nullptr) : QStyledItemDelegate(parent) {
         m_validator = validator;
-        m_model = model;
     }
-    QWidget* createEditor(QWidget* parent, const QStyleOptionViewItem& option, const QModelIndex& index) const {
-        if (index.column() % 2 == 1) {
-            return static_cast<const QStyledItemDelegate*>(this)->createEditor(parent, option, index);
-        } else {
-            QLineEdit* lineEdit = new QLineEdit{index.data().toString(), parent};
-            lineEdit->setValidator(m_validator);
-            QObject::connect(lineEdit, &QLineEdit::editingFinished, this, [index, this, lineEdit]() {
-                auto newString = "0x" + lineEdit->text().toUpper();
-                m_model->item(index.row(), index.column())->setText(newString);
-            });
-            return lineEdit;
-        }
+    QWidget* createEditor(QWidget* parent, const QStyleOptionViewItem& option, const QModelIndex& index) const override {
+        if (DisplayTableModel::isSeparateColumn(index.column()))
+            return QStyledItemDelegate::createEditor(parent, option, index);
+        // the text goes back through DisplayTableModel::setData, which reads it as hex
+        QLineEdit* lineEdit = new QLineEdit{parent};
+        lineEdit->setValidator(m_validator);
+        return lineEdit;
     }
 };
 
 void CFGEditor::setGFXInfoModel() {
-    gfxinfoModel = new QStandardItemModel;
-    QStringList labelList{"Sp0", "Sep.", "Sp1", "Sep.", "Sp2", "Sep.", "Sp3", "Sep."};
-    gfxinfoModel->setHorizontalHeaderLabels(labelList);
-    ui->tableViewGfxInfo->setModel(gfxinfoModel);
-    ui->tableViewGfxInfo->setItemDelegate(new CustomItemDelegate(gfxinfoModel, ui->tableViewGfxInfo, hexValidator));
+    // same model as the display table, showing the GFX columns instead
+    ui->tableViewGfxInfo->setModel(displayModel);
+    for (int column = 0; column < DisplayTableModel::Sp0; column++)
+        ui->tableViewGfxInfo->setColumnHidden(column, true);
+    ui->tableViewGfxInfo->setItemDelegate(new CustomItemDelegate(ui->tableViewGfxInfo, hexValidator));
     ui->tableViewGfxInfo->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
-    ui->tableViewGfxInfo->horizontalHeader()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
+    ui->tableViewGfxInfo->horizontalHeader()->setSectionResizeMode(DisplayTableModel::Sp0, QHeaderView::ResizeToContents);
     ui->tableViewGfxInfo->setHorizontalScrollBarPolicy(Qt::ScrollBarPolicy::ScrollBarAlwaysOff);
     ui->tableViewGfxInfo->setVerticalScrollBarPolicy(Qt::ScrollBarPolicy::ScrollBarAsNeeded);
-    QObject::connect(gfxinfoModel, &QStandardItemModel::itemChanged, this, [this](QStandardItem* item){
-        auto row = item->index().row();
-        auto col = item->index().column();
-        if (row < 0 || row >= displays.size())
-            return;
-        if (col % 2 == 1) {
-            displays[row].setSeparate(item->checkState() == Qt::Checked, col / 2);
-        } else {
-            auto str = item->text();
-            bool ok = false;
-            int v = str.startsWith(QStringLiteral("0x"), Qt::CaseInsensitive)
-                        ? QStringView{str}.mid(2).toInt(&ok, 16)
-                        : str.toInt(&ok, 16);
-            if (ok)
-                displays[row].setGfxInfoValue(v, col / 2);
-        }
-    });
 }
 
 void CFGEditor::setCollectionModel() {
-    collectionModel = new QStandardItemModel;
-    QStringList labelList{};
-    labelList.append("Name");
-    labelList.append("Extra bit");
-    for (int i = 1; i <= 12; i++) {
-        labelList.append(QString::asprintf("Ex%d", i));
-    }
-    collectionModel->setHorizontalHeaderLabels(labelList);
+    collectionModel = new CollectionTableModel;
     ui->tableView->setModel(collectionModel);
+    auto touchCollections = [this]() {
+        tracker.touch(SpriteSection::Collections);
+    };
+    QObject::connect(collectionModel, &CollectionTableModel::dataChanged, this, touchCollections);
+    QObject::connect(collectionModel, &CollectionTableModel::rowsInserted, this, touchCollections);
+    QObject::connect(collectionModel, &CollectionTableModel::rowsRemoved, this, touchCollections);
+    QObject::connect(collectionModel, &CollectionTableModel::rowsMoved, this, touchCollections);
     ui->tableView->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
     ui->tableView->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
     ui->tableView->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Fixed);
@@ -548,38 +617,30 @@ void CFGEditor::bindGFXSelector() {
 
 void CFGEditor::addCloneRow() {
     int target = currentDisplayIndex + 1;
-    DisplayData display(displays[currentDisplayIndex]);
-    displays.insert(target, display);
-    displayModel->insertRow(target, display.itemsFromDisplay());
-    gfxinfoModel->insertRow(target, display.GFXInfo().itemsFromGFXInfo());
+    displayModel->insertDisplay(target, displayModel->display(currentDisplayIndex));
     ui->tableViewDisplays->setCurrentIndex(displayModel->index(target, 0));
 }
 
 void CFGEditor::addBlankRow() {
     int target = currentDisplayIndex + 1;
-    DisplayData display = DisplayData::blankData();
-    displays.insert(target, display);
-    displayModel->insertRow(target, display.itemsFromDisplay());
-    gfxinfoModel->insertRow(target, display.GFXInfo().itemsFromGFXInfo());
+    displayModel->insertDisplay(target, DisplayData::blankData());
     ui->tableViewDisplays->setCurrentIndex(displayModel->index(target, 0));
 }
 
 void CFGEditor::removeExistingRow() {
     int row = currentDisplayIndex;
-    if (row < 0 || row >= displays.size())
+    if (row < 0 || row >= displayModel->rowCount())
         return;
     syncingSelection = true;
-    displays.removeAt(row);
     displayModel->removeRow(row);
-    gfxinfoModel->removeRow(row);
     syncingSelection = false;
-    if (displays.isEmpty()) {
+    if (displayModel->rowCount() == 0) {
         currentDisplayIndex = -1;
         ui->tableViewDisplays->clearSelection();
         ui->tableViewGfxInfo->clearSelection();
         refreshDisplayPanels();
     } else {
-        int newRow = std::min(row, static_cast<int>(displays.size()) - 1);
+        int newRow = std::min(row, displayModel->rowCount() - 1);
         ui->tableViewDisplays->setCurrentIndex(displayModel->index(newRow, 0));
     }
 }
@@ -591,7 +652,7 @@ void CFGEditor::refreshDisplayPanels() {
     QSignalBlocker bDispText{ui->textEditDisplayText};
     QSignalBlocker bX{ui->spinBoxXPos};
     QSignalBlocker bY{ui->spinBoxYPos};
-    if (currentDisplayIndex < 0 || currentDisplayIndex >= displays.size()) {
+    if (currentDisplayIndex < 0 || currentDisplayIndex >= displayModel->rowCount()) {
         ui->checkBoxDisplayExtraBit->setChecked(false);
         ui->checkBoxUseText->setChecked(false);
         ui->spinBoxXPos->setValue(0);
@@ -602,7 +663,7 @@ void CFGEditor::refreshDisplayPanels() {
         ui->labelDisplayTilesGrid->changeDisplay(-1);
         return;
     }
-    const DisplayData& d = displays[currentDisplayIndex];
+    const DisplayData& d = displayModel->display(currentDisplayIndex);
     ui->checkBoxDisplayExtraBit->setChecked(d.ExtraBit());
     ui->spinBoxXPos->setValue(d.XOrIndex());
     ui->spinBoxYPos->setValue(d.YOrValue());
@@ -649,11 +710,13 @@ void CFGEditor::bindDisplayButtons() {
         if (syncingSelection)
             return;
         int row = now.row() == -1 ? pre.row() : now.row();
-        if (row < 0 || row >= displays.size())
+        if (row < 0 || row >= displayModel->rowCount())
             return;
         currentDisplayIndex = row;
         syncingSelection = true;
-        int column = peer->currentIndex().isValid() ? peer->currentIndex().column() : 0;
+        // both tables show the same model, each its own columns
+        int firstColumn = peer == ui->tableViewGfxInfo ? DisplayTableModel::Sp0 : DisplayTableModel::ExtraBit;
+        int column = peer->currentIndex().isValid() ? peer->currentIndex().column() : firstColumn;
         peer->setCurrentIndex(peer->model()->index(row, column));
         syncingSelection = false;
         refreshDisplayPanels();
@@ -686,9 +749,10 @@ void CFGEditor::bindDisplayButtons() {
         ui->textEditDisplayText->setPalette(readOnlyPalette);
         if (currentDisplayIndex == -1)
             return;
-        displays[currentDisplayIndex].setUseText(isChecked);
+        displayModel->editDisplay(currentDisplayIndex).setUseText(isChecked);
         if (!isChecked)
-            displays[currentDisplayIndex].setDisplayText("");
+            displayModel->editDisplay(currentDisplayIndex).setDisplayText("");
+        tracker.touch(SpriteSection::Displays);
     });
 
     QObject::connect(ui->singleTileTranslucentCheckBox, &QCheckBox::checkStateChanged, this, [&](Qt::CheckState state) {
@@ -706,57 +770,55 @@ void CFGEditor::bindDisplayButtons() {
     ui->spinBoxYPos->setDisplayIntegerBase(16);
     QObject::connect(ui->checkBoxDisplayExtraByte, &QCheckBox::checkStateChanged, this, [&](Qt::CheckState state) {
         if (state == Qt::CheckState::Checked) {
-            QStringList labelList{"ExtraBit", "Index", "Value"};
-            displayModel->setHorizontalHeaderLabels(labelList);
+            displayModel->setExtraByteLabels(true);
             sprite->dispType = DisplayType::ExtraByte;
             ui->labelDisplayX->setText("ExByte Index:");
             ui->labelDisplayY->setText("Value:");
             ui->spinBoxXPos->setMaximum(12);
             ui->spinBoxYPos->setMaximum(0xFF);
         } else {
-            QStringList labelList{"ExtraBit", "X", "Y"};
-            displayModel->setHorizontalHeaderLabels(labelList);
+            displayModel->setExtraByteLabels(false);
             sprite->dispType = DisplayType::XY;
             ui->labelDisplayX->setText("X");
             ui->labelDisplayY->setText("Y");
             ui->spinBoxXPos->setMaximum(15);
             ui->spinBoxYPos->setMaximum(15);
         }
+        tracker.touch(SpriteSection::Displays);
     });
     QObject::connect(ui->checkBoxDisplayExtraBit, &QCheckBox::checkStateChanged, this, [&]() {
         if (!ui->tableViewDisplays->currentIndex().isValid()) {
             return;
         }
-        auto realIndex = ui->tableViewDisplays->model()->index(ui->tableViewDisplays->currentIndex().row(), 0);
-        ui->tableViewDisplays->model()->setData(realIndex, ui->checkBoxDisplayExtraBit->isChecked() ? Qt::Checked : Qt::Unchecked, Qt::CheckStateRole);
-        displays[currentDisplayIndex].setExtraBit(ui->checkBoxDisplayExtraBit->isChecked());
+        auto realIndex = displayModel->index(ui->tableViewDisplays->currentIndex().row(), DisplayTableModel::ExtraBit);
+        displayModel->setData(realIndex, ui->checkBoxDisplayExtraBit->isChecked() ? Qt::Checked : Qt::Unchecked, Qt::CheckStateRole);
     });
     QObject::connect(ui->spinBoxXPos, QOverload<int>::of(&QSpinBox::valueChanged), this, [&](int value) {
         if (!ui->tableViewDisplays->currentIndex().isValid())
             return;
-        auto realIndex = displayModel->index(ui->tableViewDisplays->currentIndex().row(), 1);
-        displayModel->setData(realIndex, QString::asprintf("%02X", value));
-        displays[currentDisplayIndex].setXOrIndex(value);
+        auto realIndex = displayModel->index(ui->tableViewDisplays->currentIndex().row(), DisplayTableModel::XOrIndex);
+        displayModel->setData(realIndex, value);
     });
     QObject::connect(ui->spinBoxYPos, QOverload<int>::of(&QSpinBox::valueChanged), this, [&](int value) {
         if (!ui->tableViewDisplays->currentIndex().isValid())
             return;
-        auto realIndex = displayModel->index(ui->tableViewDisplays->currentIndex().row(), 2);
-        displayModel->setData(realIndex, QString::asprintf("%02X", value));
-        displays[currentDisplayIndex].setYOrValue(value);
+        auto realIndex = displayModel->index(ui->tableViewDisplays->currentIndex().row(), DisplayTableModel::YOrValue);
+        displayModel->setData(realIndex, value);
     });
 
     // description or displaytext get updated
     QObject::connect(ui->textEditLMDescription, &QTextEdit::textChanged, this, [&]() {
         if (currentDisplayIndex == -1)
             return;
-        displays[currentDisplayIndex].setDescription(ui->textEditLMDescription->toPlainText());
+        displayModel->editDisplay(currentDisplayIndex).setDescription(ui->textEditLMDescription->toPlainText());
+        tracker.touch(SpriteSection::Displays);
     });
     QObject::connect(ui->textEditDisplayText, &QTextEdit::textChanged, this, [&]() {
         if (currentDisplayIndex == -1)
             return;
-        qDebug() << currentDisplayIndex << " " << displays.length();
-        displays[currentDisplayIndex].setDisplayText(ui->textEditDisplayText->toPlainText());
+        qDebug() << currentDisplayIndex << " " << displayModel->rowCount();
+        displayModel->editDisplay(currentDisplayIndex).setDisplayText(ui->textEditDisplayText->toPlainText());
+        tracker.touch(SpriteSection::Displays);
         ui->labelDisplayTilesGrid->insertText(ui->textEditDisplayText->toPlainText());
     });
 
@@ -875,7 +937,15 @@ void CFGEditor::setTilePropGroupState(FullTile tileInfo) {
 void CFGEditor::bindCollectionButtons() {
     QObject::connect(ui->newCollButton, &QPushButton::clicked, this, [&]() {
         qDebug() << "New collection button clicked";
-        collectionModel->appendRow(CollectionDataModel().getRow(ui));
+        Collection coll;
+        coll.name = ui->lineEditCollName->text();
+        coll.extrabit = ui->checkBoxCollExtrabit->isChecked();
+        const QLineEdit* bytes[12]{ui->lineEditCollExByte1, ui->lineEditCollExByte2, ui->lineEditCollExByte3, ui->lineEditCollExByte4,
+                                   ui->lineEditCollExByte5, ui->lineEditCollExByte6, ui->lineEditCollExByte7, ui->lineEditCollExByte8,
+                                   ui->lineEditCollExByte9, ui->lineEditCollExByte10, ui->lineEditCollExByte11, ui->lineEditCollExByte12};
+        for (int i = 0; i < 12; i++)
+            coll.prop[i] = static_cast<uint8_t>(bytes[i]->text().toUInt(nullptr, 16));
+        collectionModel->appendCollection(coll);
     });
     QObject::connect(ui->cloneCollButton, &QPushButton::clicked, this, [&]() {
         if (!ui->tableView->currentIndex().isValid()) {
@@ -883,8 +953,8 @@ void CFGEditor::bindCollectionButtons() {
             return;
         }
         qDebug() << "Clone collection button clicked";
-        CollectionDataModel model = CollectionDataModel::fromIndex(ui->tableView->currentIndex().row(), ui->tableView);
-        collectionModel->appendRow(model.getRow());
+        const Collection coll = collectionModel->collections()[ui->tableView->currentIndex().row()];
+        collectionModel->appendCollection(coll);
     });
     QObject::connect(ui->deleteCollButton, &QPushButton::clicked, this, [&]() {
         if (!ui->tableView->currentIndex().isValid()) {
@@ -892,7 +962,7 @@ void CFGEditor::bindCollectionButtons() {
             return;
         }
         qDebug() << "Delete collection button clicked";
-        ui->tableView->model()->removeRow(ui->tableView->currentIndex().row());
+        collectionModel->removeRow(ui->tableView->currentIndex().row());
     });
 }
 
@@ -1053,9 +1123,11 @@ void CFGEditor::bindSpriteProp() {
     ui->lineEditExtraProp2->setCompleter(hexCompleter);
     QObject::connect(ui->lineEditExtraProp1, &QLineEdit::editingFinished, this, [&]() {
         sprite->extraProp1 = (uint8_t)ui->lineEditExtraProp1->text().toUInt(nullptr, 16);
+        tracker.touch(SpriteSection::Tweaks);
     });
     QObject::connect(ui->lineEditExtraProp2, &QLineEdit::editingFinished, this, [&]() {
         sprite->extraProp2 = (uint8_t)ui->lineEditExtraProp2->text().toUInt(nullptr, 16);
+        tracker.touch(SpriteSection::Tweaks);
         {
             QSignalBlocker blocker1{ui->extraPropByte2Bit6CheckBox};
             QSignalBlocker blocker2{ui->extraPropByte2Bit7CheckBox};
@@ -1067,6 +1139,7 @@ void CFGEditor::bindSpriteProp() {
     QObject::connect(ui->comboBoxType, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [&](int index) {
         // disable stuff
         sprite->type = index;
+        tracker.touch(SpriteSection::Tweaks);
         switch (index) {
         case 0:
             setupForNormal();
@@ -1088,19 +1161,23 @@ void CFGEditor::bindSpriteProp() {
     ui->lineEditActLike->setCompleter(hexCompleter);
     QObject::connect(ui->lineEditActLike, &QLineEdit::editingFinished, this, [&]() {
         sprite->actlike = ui->lineEditActLike->text().toUInt(nullptr, 16);
+        tracker.touch(SpriteSection::Tweaks);
     });
     // AsmFile
     QObject::connect(ui->lineEditAsmFile, &QLineEdit::editingFinished, this, [&]() {
         sprite->asmfile = ui->lineEditAsmFile->text();
+        tracker.touch(SpriteSection::Tweaks);
     });
     // Additional byte count
     QObject::connect(ui->spinBoxextraBitClear, QOverload<int>::of(&QSpinBox::valueChanged), this, [&](int value) {
         qDebug() << "Extra byte (clear) changed to " << value;
         sprite->addbcountclear = value;
+        tracker.touch(SpriteSection::Tweaks);
     });
     QObject::connect(ui->spinBoxextraBitSet, QOverload<int>::of(&QSpinBox::valueChanged), this, [&](int value) {
         qDebug() << "Extra byte (set) changed to " << value;
         sprite->addbcountset = value;
+        tracker.touch(SpriteSection::Tweaks);
     });
     setupForNormal();
     // 1656
@@ -1122,6 +1199,7 @@ void CFGEditor::bindSpriteProp() {
         } else {
             sprite->extraProp2 &= ~0x40;
         }
+        tracker.touch(SpriteSection::Tweaks);
         ui->lineEditExtraProp2->setText(QString::asprintf("%02X", sprite->extraProp2));
     });
 
@@ -1131,6 +1209,7 @@ void CFGEditor::bindSpriteProp() {
         } else {
             sprite->extraProp2 &= ~0x80;
         }
+        tracker.touch(SpriteSection::Tweaks);
         ui->lineEditExtraProp2->setText(QString::asprintf("%02X", sprite->extraProp2));
     });
 }
@@ -1143,6 +1222,7 @@ void CFGEditor::bindTweak1656() {
     QObject::connect(ui->lineEdit1656, &QLineEdit::editingFinished, this, [&]() {
         qDebug() << "Value changed";
         sprite->t1656.from_byte((uint8_t)ui->lineEdit1656->text().toUInt(nullptr, 16));
+        tracker.touch(SpriteSection::Tweaks);
         ui->checkBox1656DiesJumped->setChecked(sprite->t1656.diesjumped);
         ui->checkBox1656Hopin->setChecked(sprite->t1656.hopin);
         ui->checkBox1656JumpedOn->setChecked(sprite->t1656.canbejumped);
@@ -1158,6 +1238,7 @@ void CFGEditor::bindTweak1656() {
         ui->objClippingLabel->setPixmap(objClipImages[index]);
         ui->objClippingLabel->setFixedSize(objClipImages[index].width(), objClipImages[index].height());
         sprite->t1656.objclip = index;
+        tracker.touch(SpriteSection::Tweaks);
         ui->lineEdit1656->setText(QString::asprintf("%02X", sprite->t1656.to_byte()));
     });
 
@@ -1170,6 +1251,7 @@ void CFGEditor::bindTweak1662() {
     QObject::connect(ui->lineEdit1662, &QLineEdit::editingFinished, this, [&]() {
         qDebug() << "Value changed";
         sprite->t1662.from_byte((uint8_t)ui->lineEdit1662->text().toUInt(nullptr, 16));
+        tracker.touch(SpriteSection::Tweaks);
         ui->checkBox1662deathframe->setChecked(sprite->t1662.deathframe);
         ui->checkBox1662strdown->setChecked(sprite->t1662.strdown);
         ui->sprClipCmbBox->setCurrentIndex(sprite->t1662.sprclip);
@@ -1179,6 +1261,7 @@ void CFGEditor::bindTweak1662() {
     QObject::connect(ui->sprClipCmbBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [&](int index) {
         qDebug() << "Index changed";
         sprite->t1662.sprclip = index;
+        tracker.touch(SpriteSection::Tweaks);
         ui->sprClippingLabel->setPixmap(sprClipImages[index]);
         ui->sprClippingLabel->setFixedSize(sprClipImages[index].width(), sprClipImages[index].height());
         ui->lineEdit1662->setText(QString::asprintf("%02X", sprite->t1662.to_byte()));
@@ -1192,6 +1275,7 @@ void CFGEditor::bindTweak166E() {
     QObject::connect(ui->lineEdit166E, &QLineEdit::editingFinished, this, [&]() {
         qDebug() << "Value changed";
         sprite->t166e.from_byte((uint8_t)ui->lineEdit166E->text().toUInt(nullptr, 16));
+        tracker.touch(SpriteSection::Tweaks);
         ui->checkBox166ecape->setChecked(sprite->t166e.cape);
         ui->checkBox166efireball->setChecked(sprite->t166e.fireball);
         ui->checkBox166esecondpage->setChecked(sprite->t166e.secondpage);
@@ -1208,6 +1292,7 @@ void CFGEditor::bindTweak166E() {
         qDebug() << "Index changed";
         ui->label->setPixmap(paletteImages[index].scaled(ui->label->size(), Qt::AspectRatioMode::KeepAspectRatio));
         sprite->t166e.palette = index;
+        tracker.touch(SpriteSection::Tweaks);
         ui->lineEdit166E->setText(QString::asprintf("%02X", sprite->t166e.to_byte()));
         loadFullbitmap(-1, true);
     });
@@ -1219,6 +1304,7 @@ void CFGEditor::bindTweak167A() {
     QObject::connect(ui->lineEdit167a, &QLineEdit::editingFinished, this, [&]() {
         qDebug() << "Value changed";
         sprite->t167a.from_byte((uint8_t)ui->lineEdit167a->text().toUInt(nullptr, 16));
+        tracker.touch(SpriteSection::Tweaks);
         ui->checkBox167astar->setChecked(sprite->t167a.star);
         ui->checkBox167ablk->setChecked(sprite->t167a.blk);
         ui->checkBox167aoffscr->setChecked(sprite->t167a.offscr);
@@ -1244,6 +1330,7 @@ void CFGEditor::bindTweak1686() {
     QObject::connect(ui->lineEdit1686, &QLineEdit::editingFinished, this, [&]() {
         qDebug() << "Value changed";
         sprite->t1686.from_byte((uint8_t)ui->lineEdit1686->text().toUInt(nullptr, 16));
+        tracker.touch(SpriteSection::Tweaks);
         ui->checkBox1686Inedible->setChecked(sprite->t1686.inedible);
         ui->checkBox1686mouth->setChecked(sprite->t1686.mouth);
         ui->checkBox1686ground->setChecked(sprite->t1686.ground);
@@ -1269,6 +1356,7 @@ void CFGEditor::bindTweak190F() {
     QObject::connect(ui->lineEdit190f, &QLineEdit::editingFinished, this, [&]() {
         qDebug() << "Value changed";
         sprite->t190f.from_byte((uint8_t)ui->lineEdit190f->text().toUInt(nullptr, 16));
+        tracker.touch(SpriteSection::Tweaks);
         ui->checkBox190fbelow->setChecked(sprite->t190f.below);
         ui->checkBox190fgoalpass->setChecked(sprite->t190f.goal);
         ui->checkBox190fsliding->setChecked(sprite->t190f.slidekill);
@@ -1290,7 +1378,6 @@ void CFGEditor::bindTweak190F() {
 
 CFGEditor::~CFGEditor()
 {
-    displays.clear();
     delete collectionModel;
     delete displayModel;
     delete full8x8Bitmap;
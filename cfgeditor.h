@@ -9,15 +9,21 @@
 #include <QLineEdit>
 #include <QCheckBox>
 #include <QRegularExpressionValidator>
-#include <QStandardItemModel>
 #include <QDir>
 #include <QMap>
 #include "utils.h"
+#include "messageboxreporter.h"
 #include "jsonsprite.h"
 #include "snesgfxconverter.h"
 #include "eightbyeightviewcontainer.h"
 #include "palettecontainer.h"
 #include "map16provider.h"
+#include "spritedatamodel.h"
+#include "memoryaccounting.h"
+#include "modificationtracker.h"
+#include "perfhud.h"
+#include "interactionrecorder.h"
+#include "spritesaver.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class CFGEditor; }
@@ -43,6 +49,8 @@ public:
     void resetTweaks();
     void resetAll();
     void saveSprite();
+    // writes the sprite to the file it was opened from, asks for a name if it has none
+    bool writeSprite();
     void setCollectionModel();
     void setDisplayModel();
     void setGFXInfoModel();
@@ -63,42 +71,53 @@ public:
     void populateDisplays();
     void populateGFXFiles();
     bool hasModification();
+    void markSaved();
 
     void changeAllCheckBoxState(bool state);
     void setupForNormal();
     void setupForCustom();
 	void setupForGenShootOther();
 
-    QStandardItemModel* getGfxInfoModel() {
-        return gfxinfoModel;
-    }
+    // the widgets interactions are recorded on and replayed to, keyed by the names used in recordings
+    QVector<QPair<QString, QWidget*>> interactionTargets() const;
+    void selectDisplay(int index);
+    int currentDisplay() const;
+    // the sprite as it is in the editor right now, in JSON
+    QByteArray spriteSnapshot();
 
     template <typename J>
     void connectCheckBox(QLineEdit* edit, QCheckBox* box, J* tweak, bool& tochange) {
         QObject::connect(box, &QCheckBox::checkStateChanged, this, [=, &tochange](Qt::CheckState state) mutable {
             qDebug() << "Checkbox " << box->objectName() << " changed";
             tochange = state == Qt::CheckState::Checked;
+            tracker.touch(SpriteSection::Tweaks);
             edit->setText(QString::asprintf("%02X", tweak->to_byte()));
         });
     }
 private:
     Ui::CFGEditor *ui;
     JsonSprite* sprite;
-    JsonSprite* original;
+    ModificationTracker tracker;
     QRegularExpressionValidator* hexValidator;
     QStringList* hexNumberList;
     QCompleter* hexCompleter;
     QVector<QPixmap> paletteImages;
     QVector<QPixmap> objClipImages;
     QVector<QPixmap> sprClipImages;
-    QStandardItemModel* collectionModel = nullptr;
-    QStandardItemModel* displayModel = nullptr;
-    QStandardItemModel* gfxinfoModel = nullptr;
+    CollectionTableModel* collectionModel = nullptr;
+    // the displays, shown by both the display and the GFX info table
+    DisplayTableModel* displayModel = nullptr;
     QImage* full8x8Bitmap = nullptr;
 	EightByEightViewContainer* view8x8Container = nullptr;
 	PaletteContainer* paletteContainer = nullptr;
+    PerfHud* perfHud = nullptr;
+    InteractionRecorder* recorder = nullptr;
+    // every save goes through it, closing waits for the ones still running
+    SpriteSaver* saver = nullptr;
+    // counts the sprites opened with New or Open, saves are tagged with it
+    quint64 document = 0;
+    MemoryAccount tileBitmapMemory{MemoryAccounting::TileBitmap};
     ClipboardTile copiedTile;
-    QVector<DisplayData> displays;
     QAtomicInteger<int> currentDisplayIndex = -1;
     int currentGFXFileIndex = -1;
     bool syncingSelection = false;
@@ -1,4 +1,5 @@
 #include "clipboardtile.h"
+#include "alphablend.h"
 #include <QFileSystemWatcher>
 
 
@@ -119,7 +120,7 @@ void FullTile::SetTranslucent(bool translucent) {
 
 QImage TileInfo::get8x8Tile(int offset) {
     if (!isThisTile()) {
-        QImage tile(8, 8, QImage::Format::Format_ARGB32);
+        QImage tile(8, 8, SnesGFXConverter::TileFormat);
         tile.fill(Qt::transparent);
         return tile;
     }
@@ -166,37 +167,28 @@ quint16 TileInfo::TileValue() {
 
 QImage FullTile::getFullTile(bool translucent) {
     if (isFullTile()) {
-        QImage img{16, 16, QImage::Format::Format_ARGB32};
+        QImage img{16, 16, SnesGFXConverter::TileFormat};
         img.fill(Qt::transparent);
-        QPainter p{&img};
-        if (this->translucent || translucent) {
-            p.setOpacity(0.5);
-        }
-        p.setCompositionMode(QPainter::CompositionMode_SourceOver);
-        p.drawImage(QRect{0, 0, 8, 8}, topleft.get8x8Tile(offset));
-        p.drawImage(QRect{0, 8, 8, 8}, bottomleft.get8x8Tile(offset));
-        p.drawImage(QRect{8, 0, 8, 8}, topright.get8x8Tile(offset));
-        p.drawImage(QRect{8, 8, 8, 8}, bottomright.get8x8Tile(offset));
-        p.end();
+        bool half = this->translucent || translucent;
+        AlphaBlend::blendImage(img, QPoint{0, 0}, topleft.get8x8Tile(offset), half);
+        AlphaBlend::blendImage(img, QPoint{0, 8}, bottomleft.get8x8Tile(offset), half);
+        AlphaBlend::blendImage(img, QPoint{8, 0}, topright.get8x8Tile(offset), half);
+        AlphaBlend::blendImage(img, QPoint{8, 8}, bottomright.get8x8Tile(offset), half);
         return img;
     } else {
-        QImage img{8, 8, QImage::Format::Format_ARGB32};
+        QImage img{8, 8, SnesGFXConverter::TileFormat};
         img.fill(Qt::transparent);
-        QPainter p{&img};
-        if (this->translucent || translucent) {
-            p.setOpacity(0.5);
-        }
-        QRect area{0, 0, 8, 8};
+        bool half = this->translucent || translucent;
+        QPoint origin{0, 0};
         if (topleft.isThisTile()) {
-            p.drawImage(area, topleft.get8x8Tile(offset));
+            AlphaBlend::blendImage(img, origin, topleft.get8x8Tile(offset), half);
         } else if (topright.isThisTile()) {
-            p.drawImage(area, topright.get8x8Tile(offset));
+            AlphaBlend::blendImage(img, origin, topright.get8x8Tile(offset), half);
         } else if (bottomleft.isThisTile()) {
-            p.drawImage(area, bottomleft.get8x8Tile(offset));
+            AlphaBlend::blendImage(img, origin, bottomleft.get8x8Tile(offset), half);
         } else if (bottomright.isThisTile()) {
-            p.drawImage(area, bottomright.get8x8Tile(offset));
+            AlphaBlend::blendImage(img, origin, bottomright.get8x8Tile(offset), half);
         }
-        p.end();
         return img;
     }
 }
@@ -206,7 +198,7 @@ QImage FullTile::getScaled(int width, bool translucent) {
 }
 
 bool FullTile::isEmpty() {
-    return topleft.isEmpty() && topright.isEmpty() && bottomleft.isEmpty() && topleft.isEmpty();
+    return topleft.isEmpty() && topright.isEmpty() && bottomleft.isEmpty() && bottomright.isEmpty();
 }
 
 bool FullTile::isFullTile() {
@@ -0,0 +1,242 @@
+#include "corpusgenerator.h"
+#include "headlesstool.h"
+#include "map16format.h"
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QLocale>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <QtEndian>
+
+using namespace HeadlessTool;
+
+namespace {
+// a tile word with a random graphic out of the four SP files, palette and flips
+quint16 randomTileWord(QRandomGenerator& rng) {
+    return static_cast<quint16>(rng.bounded(0x200) | (rng.bounded(8) << 10) | (rng.bounded(4) << 14));
+}
+
+void appendDword(QByteArray& data, quint32 value) {
+    char bytes[4];
+    qToLittleEndian(value, bytes);
+    data.append(bytes, 4);
+}
+
+// max, max / 2, max / 4, ... smallest first, without repeats
+QVector<int> ladder(int max, int steps) {
+    QVector<int> sizes;
+    for (int s = steps - 1; s >= 0; s--) {
+        int size = qMax(1, max >> s);
+        if (sizes.isEmpty() || sizes.last() != size)
+            sizes.append(size);
+    }
+    return sizes;
+}
+}
+
+bool CorpusGenerator::requested(int argc, char* argv[]) {
+    return hasFlag(argc, argv, "--generate-corpus");
+}
+
+int CorpusGenerator::run(const QStringList& arguments) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Writes seeded stress inputs: large map16 files, ExGFX folders and sprites.");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"generate-corpus", "Directory the corpus is written to.", "dir"},
+        {"seed", "Seed of the random data, defaults to 1.", "n", "1"},
+        {"map16-pages", "Pages of the largest map16 file, defaults to 64.", "n", "64"},
+        {"exgfx", "Number of ExGFX files, defaults to 32.", "n", "32"},
+        {"displays", "Displays of the largest sprite, defaults to 512.", "n", "512"},
+        {"tiles", "Tiles per display, defaults to 32.", "n", "32"},
+        {"sprite-map16-pages", "Pages of custom Map16 in the largest sprite, defaults to 16.", "n", "16"},
+        {"collections", "Collections of the largest sprite, defaults to 256.", "n", "256"},
+        {"steps", "Sizes of every kind of file, each half of the next one, defaults to 4.", "n", "4"},
+    });
+    if (!parser.parse(arguments)) {
+        QTextStream(stderr) << parser.errorText() << '\n';
+        return ExitUsage;
+    }
+    if (parser.isSet("help")) {
+        QTextStream(stdout) << parser.helpText();
+        return ExitOk;
+    }
+
+    Options options;
+    options.outputDir = parser.value("generate-corpus");
+    bool ok = true;
+    auto number = [&](const QString& name, int minimum) {
+        bool valid = false;
+        int value = parser.value(name).toInt(&valid);
+        if (!valid || value < minimum) {
+            QTextStream(stderr) << "--" << name << " expects a number of at least " << minimum << '\n';
+            ok = false;
+        }
+        return value;
+    };
+    bool validSeed = false;
+    options.seed = parser.value("seed").toUInt(&validSeed);
+    if (!validSeed) {
+        QTextStream(stderr) << "--seed expects a non-negative number\n";
+        return ExitUsage;
+    }
+    options.map16Pages = number("map16-pages", 1);
+    options.exgfxFiles = number("exgfx", 0);
+    options.displays = number("displays", 1);
+    options.tilesPerDisplay = number("tiles", 0);
+    options.spriteMap16Pages = number("sprite-map16-pages", 0);
+    options.collections = number("collections", 0);
+    options.steps = number("steps", 1);
+    if (!ok)
+        return ExitUsage;
+
+    QElapsedTimer timer;
+    timer.start();
+    QStringList files;
+    QString error;
+    if (!generate(options, files, error)) {
+        QTextStream(stderr) << "FAIL " << error << '\n';
+        return ExitFailures;
+    }
+    qint64 bytes = 0;
+    for (auto& file : files)
+        bytes += QFileInfo{file}.size();
+    QTextStream(stdout) << "Wrote " << files.size() << " files (" << QLocale{}.formattedDataSize(bytes) << ") to "
+                        << QDir{options.outputDir}.absolutePath() << " in " << timer.elapsed() << " ms\n";
+    return ExitOk;
+}
+
+bool CorpusGenerator::generate(const Options& options, QStringList& files, QString& error) {
+    QDir out{options.outputDir};
+    for (const char* dir : {"map16", "rom/ExternalGraphics", "sprites"}) {
+        if (!out.mkpath(dir)) {
+            error = "could not create " + out.filePath(dir);
+            return false;
+        }
+    }
+    auto write = [&](const QString& name, const QByteArray& data) {
+        const QString file = out.filePath(name);
+        if (!writeAtomically(file, data, error)) {
+            error = file + ": " + error;
+            return false;
+        }
+        files.append(file);
+        return true;
+    };
+
+    for (int pages : ladder(options.map16Pages, options.steps)) {
+        if (!write(QString::asprintf("map16/stress_%dp.map16", pages), map16File(pages, options.seed)))
+            return false;
+    }
+
+    // only the folder of the ROM and its name are used, the ROM itself is never read
+    if (!write("rom/stress.smc", {}) || !write("rom/stress.ssc", sscFile(options.exgfxFiles)))
+        return false;
+    for (int i = 0; i < options.exgfxFiles; i++) {
+        // zero padded, the files are loaded in name order and each one's place decides its base tile
+        if (!write(QString::asprintf("rom/ExternalGraphics/ExSpriteGFX%03X.bin", i), exgfxFile(options.seed + i)))
+            return false;
+    }
+
+    for (int displays : ladder(options.displays, options.steps)) {
+        // everything else grows along with the displays
+        const int map16Tiles = static_cast<int>(static_cast<qint64>(options.spriteMap16Pages) * TilesPerPage * displays / options.displays);
+        const int collections = static_cast<int>(static_cast<qint64>(options.collections) * displays / options.displays);
+        const QString name = QString::asprintf("sprites/stress_%dd.json", displays);
+        JsonSprite s = sprite(displays, options.tilesPerDisplay, map16Tiles, collections, options.seed);
+        if (!write(name, s.to_text(name, false)))
+            return false;
+    }
+    return true;
+}
+
+QByteArray CorpusGenerator::map16Tiles(int tiles, quint32 seed) {
+    QRandomGenerator rng{seed};
+    QByteArray data;
+    data.reserve(tiles * 8);
+    for (int i = 0; i < tiles; i++) {
+        for (int w = 0; w < 4; w++) {
+            quint16 word = randomTileWord(rng);
+            data.append(static_cast<char>(word & 0xFF));
+            data.append(static_cast<char>(word >> 8));
+        }
+    }
+    return data;
+}
+
+QString CorpusGenerator::map16Base64(int tiles, quint32 seed) {
+    return QString::fromLatin1(map16Tiles(tiles, seed).toBase64());
+}
+
+QByteArray CorpusGenerator::map16File(int pages, quint32 seed) {
+    // same header as the files Lunar Magic writes, with a table of contents that only has the tile data
+    constexpr quint32 TableOffset = 0x70;
+    constexpr quint32 DataOffset = TableOffset + 8;
+    const QByteArray tiles = map16Tiles(pages * TilesPerPage, seed);
+    QByteArray data{"LM16"};
+    data.append("\x00\x01\x01\x00\x21\x03\x01\x00\x00\x00\x00\x00", 12);
+    appendDword(data, TableOffset);
+    appendDword(data, 8);
+    appendDword(data, 16);
+    appendDword(data, static_cast<quint32>(pages) * 16);
+    data.append(0x40 - data.size(), '\0');
+    data.append(QByteArray{"CFGEditor stress corpus"}.leftJustified(TableOffset - 0x40, ' '));
+    appendDword(data, DataOffset);
+    appendDword(data, static_cast<quint32>(tiles.size()));
+    data.append(tiles);
+    return data;
+}
+
+QByteArray CorpusGenerator::exgfxFile(quint32 seed) {
+    QRandomGenerator rng{seed};
+    QByteArray data(ExGfxFileSize, 0);
+    for (auto& b : data)
+        b = static_cast<char>(rng.bounded(256));
+    return data;
+}
+
+QByteArray CorpusGenerator::sscFile(int exgfxFiles) {
+    // "10000 <n>" followed by start-end,basetile entries, all in hex
+    QByteArray line = "10000 0";
+    constexpr int TilesPerFile = ExGfxFileSize / 32;
+    for (int i = 0; i < exgfxFiles; i++) {
+        const int start = Map16Format::InternalTiles + i * TilesPerPage;
+        line += QString::asprintf(" %X-%X,%X", start, start + TilesPerPage - 1, i * TilesPerFile).toLatin1();
+    }
+    return line + '\n';
+}
+
+JsonSprite CorpusGenerator::sprite(int displays, int tilesPerDisplay, int map16Tiles, int collections, quint32 seed) {
+    QRandomGenerator rng{seed};
+    JsonSprite sprite;
+    sprite.asmfile = "stress.asm";
+    sprite.actlike = 0x36;
+    sprite.t1656.from_byte(static_cast<quint8>(rng.bounded(256)));
+    sprite.t1662.from_byte(static_cast<quint8>(rng.bounded(256)));
+    sprite.t166e.from_byte(static_cast<quint8>(rng.bounded(256)));
+    sprite.t167a.from_byte(static_cast<quint8>(rng.bounded(256)));
+    sprite.t1686.from_byte(static_cast<quint8>(rng.bounded(256)));
+    sprite.t190f.from_byte(static_cast<quint8>(rng.bounded(256)));
+    sprite.setMap16(map16Base64(map16Tiles, seed));
+    const int tileRange = Map16Format::InternalTiles + map16Tiles;
+    for (int d = 0; d < displays; d++) {
+        QVector<Tile> tiles;
+        tiles.reserve(tilesPerDisplay);
+        for (int t = 0; t < tilesPerDisplay; t++)
+            tiles.append(Tile{rng.bounded(-80, 81), rng.bounded(-80, 81), rng.bounded(tileRange), rng.bounded(8) == 0});
+        bool useText = d % 16 == 15;
+        sprite.addDisplay(JSONDisplay{QString::asprintf("Display %d", d), useText ? QVector<Tile>{} : tiles, d % 2 == 1, d % 16, d / 16,
+                                      useText, useText ? "Text display used to stress the text layer" : "", GFXInfo{}});
+    }
+    for (int c = 0; c < collections; c++) {
+        Collection coll;
+        coll.name = QString::asprintf("Collection %d", c);
+        coll.extrabit = c % 2 == 1;
+        for (auto& p : coll.prop)
+            p = static_cast<uint8_t>(rng.bounded(256));
+        sprite.collections.append(coll);
+    }
+    return sprite;
+}
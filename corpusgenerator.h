@@ -0,0 +1,55 @@
+#ifndef CORPUSGENERATOR_H
+#define CORPUSGENERATOR_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include "jsonsprite.h"
+
+// Headless generator of stress inputs, started with --generate-corpus.
+// Everything is derived from a seed, the same options always write the same bytes. Each kind of input is
+// written as a ladder of sizes (halving down from the maximum) so timings can be plotted against the size:
+//   map16/stress_<pages>p.map16   Lunar Magic map16 files with many pages
+//   rom/                          a placeholder stress.smc with stress.ssc and ExternalGraphics/ExSpriteGFX*.bin,
+//                                 laid out the way "Load External GFX Files" reads them
+//   sprites/stress_<displays>d.json  sprites with many displays, collections and a large Map16 field
+// The building blocks are public, the benchmarks generate their fixtures with them.
+class CorpusGenerator
+{
+public:
+    struct Options {
+        QString outputDir;
+        quint32 seed = 1;
+        // largest map16 file, in pages of 16x16 tiles
+        int map16Pages = 64;
+        int exgfxFiles = 32;
+        // largest sprite: displays, tiles per display, pages of custom Map16 and collections
+        int displays = 512;
+        int tilesPerDisplay = 32;
+        int spriteMap16Pages = 16;
+        int collections = 256;
+        // entries of each ladder, the largest one is the size above
+        int steps = 4;
+    };
+    static constexpr int TilesPerPage = 16 * 16;
+    static constexpr int ExGfxFileSize = 0x8000;
+    static bool requested(int argc, char* argv[]);
+    static int run(const QStringList& arguments);
+    // writes the whole corpus, files lists every file written
+    static bool generate(const Options& options, QStringList& files, QString& error);
+
+    // raw tile data in the layout of Map16Format, with random graphics, palettes and flips
+    static QByteArray map16Tiles(int tiles, quint32 seed = 1);
+    // the base64 "Map16" field of a sprite with this many custom tiles
+    static QString map16Base64(int tiles, quint32 seed = 1);
+    // a .map16 file with a Lunar Magic header, 16 tiles wide
+    static QByteArray map16File(int pages, quint32 seed = 1);
+    // 32KB of random 4bpp graphics, the largest ExGFX file the editor accepts
+    static QByteArray exgfxFile(quint32 seed = 1);
+    // maps map16 page 3 + n (the first custom page is at 0x300) onto the 8x8 tiles of ExGFX file n
+    static QByteArray sscFile(int exgfxFiles);
+    // every 16th display is a text display, tiles use both the built in and the sprite's own map16
+    static JsonSprite sprite(int displays, int tilesPerDisplay, int map16Tiles, int collections, quint32 seed = 1);
+};
+
+#endif // CORPUSGENERATOR_H
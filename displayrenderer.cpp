@@ -0,0 +1,253 @@
+#include "displayrenderer.h"
+#include "alphablend.h"
+#include "snesgfxconverter.h"
+#include <QDir>
+#include <QFile>
+
+namespace {
+// Letters.png is a single 8x8 glyph atlas: a-z on the first row, A-Z on the second, then 0-9 and punctuation
+constexpr quint8 glyphSpace = 67;
+constexpr std::array<quint8, 256> makeGlyphTable() {
+    std::array<quint8, 256> table{};
+    for (auto& g : table)
+        g = glyphSpace;
+    for (int c = 0; c < 26; c++) {
+        table['a' + c] = static_cast<quint8>(c);
+        table['A' + c] = static_cast<quint8>(26 + c);
+    }
+    for (int c = 0; c < 10; c++)
+        table['0' + c] = static_cast<quint8>(52 + c);
+    constexpr char punctuation[] = ",.!?- '\"&";
+    for (int c = 0; c < 9; c++)
+        table[static_cast<unsigned char>(punctuation[c])] = static_cast<quint8>(62 + c);
+    return table;
+}
+constexpr std::array<quint8, 256> glyphTable = makeGlyphTable();
+static_assert(glyphTable['?'] == 65 && glyphTable['&'] == 70 && glyphTable['~'] == glyphSpace);
+
+constexpr QRect glyphRect(quint8 glyph) {
+    int row = glyph < 26 ? 0 : glyph < 52 ? 1 : 2;
+    return QRect{(glyph - row * 26) * 8, row * 8, 8, 8};
+}
+
+// size of the graphics of one SP slot
+constexpr qsizetype slotSize = 0x1000;
+
+QByteArray readAll(const QString& name) {
+    QFile file{name};
+    if (!file.open(QFile::OpenModeFlag::ReadOnly))
+        return {};
+    return file.readAll();
+}
+
+// read-only data every renderer starts from, loaded once by whichever thread gets there first
+struct SharedResources {
+    QVector<Map16Tile> map16;
+    DisplayRenderer::Palette palette;
+    QByteArray exanimation;
+    // the glyphs are blended straight out of it, see glyphRect
+    QImage letters;
+};
+
+const SharedResources& shared() {
+    static const SharedResources resources = [] {
+        SharedResources r;
+        QString error;
+        Map16Format::Table table;
+        Map16Format::readFile(":/Resources/spriteMapData.map16", table, error);
+        // tiles 0x000-0x2FF come from spriteMapData.map16, the sprite's own tiles follow
+        r.map16 = std::move(table.tiles);
+        r.map16.resize(Map16Format::InternalTiles);
+        DisplayRenderer::readPalette(":/Resources/sprites_palettes.pal", r.palette, error);
+        r.exanimation = readAll(":/Resources/Graphics/GFX33.bin");
+        r.letters = QImage{":/Resources/Text/Letters.png"}.convertToFormat(SnesGFXConverter::TileFormat);
+        return r;
+    }();
+    return resources;
+}
+}
+
+QImage DisplayRenderer::createCanvas() {
+    QImage img{CanvasSize, CanvasSize, SnesGFXConverter::TileFormat};
+    img.fill(Qt::transparent);
+    return img;
+}
+
+QPoint DisplayRenderer::tilePosition(const Tile& tile) {
+    return QPoint{tile.xoff, tile.yoff} + Origin;
+}
+
+QVector<QByteArray> DisplayRenderer::wrapParagraph(const QString& paragraph) {
+    constexpr int cpl = 24; // 26 is a whole line
+    QString str{paragraph.trimmed()};
+    int max = str.length();
+    if (max <= cpl)
+        return {paragraph.toUtf8()};
+    QVector<QByteArray> lines;
+    int curr = 0;
+    while (max - curr > cpl) {
+        auto slice = str.sliced(curr, (curr + cpl >= max) ? (max - curr) : cpl).trimmed();
+        auto space = slice.lastIndexOf(' ');
+        if (space == -1) {
+            lines.append(slice.toUtf8());
+            curr += cpl;
+        }
+        else {
+            lines.append(slice.sliced(0, space).toUtf8());
+            curr += (space + 1);
+        }
+    }
+    lines.append(str.sliced(curr).toUtf8());
+    return lines;
+}
+
+QVector<QByteArray> DisplayRenderer::layoutText(const QString& text) {
+    QVector<QByteArray> lines;
+    for (auto& paragraph : text.split("\n", Qt::SkipEmptyParts))
+        lines.append(wrapParagraph(paragraph));
+    return lines;
+}
+
+void DisplayRenderer::drawText(QImage& canvas, const QVector<QByteArray>& lines) {
+    const QImage& letters = shared().letters;
+    int count = static_cast<int>(lines.length());
+    int vmargin = (CanvasSize - (count * 8)) / 2;
+    for (int row = 0; row < count; row++) {
+        const QByteArray& str = lines[row];
+        int hmargin = static_cast<int>((CanvasSize - (str.length() * 8)) / 2);
+        for (int col = 0; col < (int)str.length(); col++) {
+            quint8 glyph = glyphTable[static_cast<unsigned char>(str[col])];
+            AlphaBlend::blendImage(canvas, QPoint{hmargin + (col * 8), vmargin + (row * 8)}, letters, glyphRect(glyph));
+        }
+    }
+}
+
+bool DisplayRenderer::readPalette(const QString& filename, Palette& palette, QString& error) {
+    constexpr int columns = 16;
+    QFile pal{filename};
+    if (!pal.open(QFile::OpenModeFlag::ReadOnly)) {
+        error = pal.errorString();
+        return false;
+    }
+    auto bytes = pal.readAll();
+    if (bytes.size() < 16 * columns * 3) {
+        error = QString::asprintf("palette file is %lld bytes, expected at least %d", static_cast<long long>(bytes.size()), 16 * columns * 3);
+        return false;
+    }
+    palette.clear();
+    palette.reserve(8);
+    for (int row = 8; row < 16; row++) {
+        std::array<QRgb, 15> colors{};
+        for (int col = 1; col < columns; col++) {
+            auto at = columns * 3 * row + 3 * col;
+            colors[col - 1] = qRgba(bytes[at] & 0xFF, bytes[at + 1] & 0xFF, bytes[at + 2] & 0xFF, 255);
+        }
+        palette.append(colors);
+    }
+    return true;
+}
+
+DisplayRenderer::DisplayRenderer() : m_palette(shared().palette), m_map16(shared().map16) {
+
+}
+
+void DisplayRenderer::setGraphicsDirectory(const QString& dir) {
+    m_graphicsDir = dir;
+}
+
+void DisplayRenderer::setPalette(const Palette& palette) {
+    m_palette = palette;
+    m_tiles.clear();
+}
+
+QByteArray DisplayRenderer::readGraphicsFile(int value, QString& error) const {
+    QStringList candidates{QString::asprintf(":/Resources/Graphics/GFX%02X.bin", value)};
+    if (!m_graphicsDir.isEmpty()) {
+        QDir dir{m_graphicsDir};
+        candidates.append(dir.filePath(QString::asprintf("GFX%02X.bin", value)));
+        candidates.append(dir.filePath(QString::asprintf("ExGFX%02X.bin", value)));
+        candidates.append(dir.filePath(QString::asprintf("ExGFX%X.bin", value)));
+    }
+    for (auto& name : candidates) {
+        QFile file{name};
+        if (file.open(QFile::OpenModeFlag::ReadOnly))
+            return file.readAll();
+    }
+    error = QString::asprintf("GFX%02X.bin was not found", value);
+    return {};
+}
+
+bool DisplayRenderer::setGraphics(const GFXInfo& info, QString& error) {
+    if (m_hasGraphics && info == m_gfxInfo)
+        return true;
+    const SingleGFXFile* slots[4]{&info.sp0, &info.sp1, &info.sp2, &info.sp3};
+    QByteArray gfx;
+    gfx.reserve(4 * slotSize + shared().exanimation.size());
+    for (int i = 0; i < 4; i++) {
+        int value = slots[i]->value == 0x7F ? DefaultGraphics[i] : slots[i]->value;
+        auto data = readGraphicsFile(value, error);
+        if (data.isEmpty())
+            return false;
+        // keep every slot at the same size, so a short file doesn't move the tiles of the next ones
+        gfx.append(data.leftJustified(slotSize, 0, true));
+    }
+    gfx.append(shared().exanimation);
+    m_gfx = std::move(gfx);
+    m_gfxInfo = info;
+    m_hasGraphics = true;
+    m_tiles.clear();
+    return true;
+}
+
+bool DisplayRenderer::setMap16(const QString& base64, QString& error) {
+    QVector<Map16Tile> tiles = shared().map16;
+    const bool ok = Map16Format::decodeBase64(base64, tiles, error);
+    m_map16 = std::move(tiles);
+    m_tiles.clear();
+    return ok;
+}
+
+QImage DisplayRenderer::tile8x8(quint16 value) const {
+    // same bits as TileInfo
+    int tilenum = value & 0x3FF;
+    int pal = (value & 0x1C00) >> 10;
+    QImage img{8, 8, SnesGFXConverter::TileFormat};
+    img.fill(Qt::transparent);
+    // out of bounds tiles stay transparent, there's nobody to show an alert to
+    if (pal < m_palette.size())
+        SnesGFXConverter::decode8x8(img, m_gfx, tilenum * 8 * 4, m_palette[pal].data());
+    Qt::Orientations flipOr{};
+    if (value & 0x8000) flipOr |= Qt::Vertical;
+    if (value & 0x4000) flipOr |= Qt::Horizontal;
+    img.flip(flipOr);
+    return img;
+}
+
+const QImage& DisplayRenderer::tileImage(int map16tile, bool translucent) {
+    int key = (map16tile << 1) | (translucent ? 1 : 0);
+    auto it = m_tiles.constFind(key);
+    if (it != m_tiles.cend())
+        return *it;
+    // same composition as FullTile::getFullTile
+    QImage img{16, 16, SnesGFXConverter::TileFormat};
+    img.fill(Qt::transparent);
+    if (map16tile >= 0 && map16tile < m_map16.size()) {
+        const auto& words = m_map16[map16tile];
+        AlphaBlend::blendImage(img, QPoint{0, 0}, tile8x8(words[0]), translucent);
+        AlphaBlend::blendImage(img, QPoint{0, 8}, tile8x8(words[1]), translucent);
+        AlphaBlend::blendImage(img, QPoint{8, 0}, tile8x8(words[2]), translucent);
+        AlphaBlend::blendImage(img, QPoint{8, 8}, tile8x8(words[3]), translucent);
+    }
+    return *m_tiles.insert(key, img);
+}
+
+QImage DisplayRenderer::render(const JSONDisplay& display) {
+    QImage canvas = createCanvas();
+    if (display.useText) {
+        drawText(canvas, layoutText(display.displaytext));
+        return canvas;
+    }
+    for (auto& t : display.tiles)
+        AlphaBlend::blendImage(canvas, tilePosition(t), tileImage(t.tilenumber, t.translucent));
+    return canvas;
+}
@@ -0,0 +1,60 @@
+#ifndef DISPLAYRENDERER_H
+#define DISPLAYRENDERER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QImage>
+#include <QPoint>
+#include <QVector>
+#include <array>
+#include "jsonsprite.h"
+#include "map16format.h"
+
+// Composes displays the same way the display editor does, without widgets and without the static
+// SnesGFXConverter/SpritePaletteCreator state: every renderer owns its graphics, palette and map16,
+// so several of them can work on different threads.
+class DisplayRenderer
+{
+public:
+    // colors 1-15 of the 8 sprite palettes (rows 8-F of a .pal file), color 0 is always transparent
+    using Palette = QVector<std::array<QRgb, 15>>;
+    // displays are drawn on a CanvasSize square with the sprite's position at Origin
+    static constexpr int CanvasSize = 208;
+    static constexpr QPoint Origin{96, 96};
+    // the GFX set used by the editor at startup, "00 01 13 02 (Forest)"
+    static constexpr std::array<int, 4> DefaultGraphics{0x00, 0x01, 0x13, 0x02};
+
+    static QImage createCanvas();
+    static QPoint tilePosition(const Tile& tile);
+    // text displays: each paragraph is wrapped on its own and the lines are drawn centered on the canvas
+    static QVector<QByteArray> wrapParagraph(const QString& paragraph);
+    static QVector<QByteArray> layoutText(const QString& text);
+    static void drawText(QImage& canvas, const QVector<QByteArray>& lines);
+    // same layout as SpritePaletteCreator::ReadPaletteFile(0, 16)
+    static bool readPalette(const QString& filename, Palette& palette, QString& error);
+
+    DisplayRenderer();
+    // GFX files that aren't part of the resources are looked up here as GFXxx.bin or ExGFXxx.bin
+    void setGraphicsDirectory(const QString& dir);
+    void setPalette(const Palette& palette);
+    // loads the SP0-SP3 files, slots left at 0x7F use the file of DefaultGraphics
+    bool setGraphics(const GFXInfo& info, QString& error);
+    // the base64 "Map16" field of a sprite, its tiles start at 0x300
+    // a field that doesn't decode cleanly returns false, but what could be read is used, like the editor does
+    bool setMap16(const QString& base64, QString& error);
+    QImage render(const JSONDisplay& display);
+private:
+    QByteArray readGraphicsFile(int value, QString& error) const;
+    const QImage& tileImage(int map16tile, bool translucent);
+    QImage tile8x8(quint16 value) const;
+    QString m_graphicsDir;
+    Palette m_palette;
+    GFXInfo m_gfxInfo;
+    bool m_hasGraphics = false;
+    QByteArray m_gfx;
+    QVector<Map16Tile> m_map16;
+    // 16x16 pictures of the map16 tiles drawn so far, keyed by tile number and translucency
+    QHash<int, QImage> m_tiles;
+};
+
+#endif // DISPLAYRENDERER_H
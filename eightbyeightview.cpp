@@ -85,7 +85,7 @@ void EightByEightView::updateForChange(QImage* image) {
         scene()->removeItem(currentItem);
 		delete currentItem;
     }
-    currentItem = new QGraphicsPixmapItem(QPixmap::fromImage(*image).scaled(image->size() * 2));
+    currentItem = new QGraphicsPixmapItem(QPixmap::fromImage(image->scaled(image->size() * 2)));
     currentItem->setAcceptHoverEvents(true);
     scene()->addItem(currentItem);
     setFixedSize(256 + 18, 256);
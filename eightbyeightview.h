@@ -2,6 +2,7 @@
 #define EIGHTBYEIGHTVIEW_H
 
 #include <QGraphicsView>
+#include <QGraphicsScene>
 #include <QCloseEvent>
 #include <QGraphicsItem>
 #include <QTimer>
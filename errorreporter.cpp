@@ -0,0 +1,18 @@
+#include "errorreporter.h"
+#include <QDebug>
+#include <atomic>
+
+namespace {
+std::atomic<ErrorReporter*> installedReporter{nullptr};
+}
+
+void ErrorReporter::install(ErrorReporter* reporter) {
+    installedReporter.store(reporter);
+}
+
+void ErrorReporter::error(const QString& message) {
+    if (auto reporter = installedReporter.load())
+        reporter->report(message);
+    else
+        qWarning().noquote() << message;
+}
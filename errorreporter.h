@@ -0,0 +1,20 @@
+#ifndef ERRORREPORTER_H
+#define ERRORREPORTER_H
+
+#include <QString>
+
+// Where the core code sends errors it has nobody to return them to (e.g. a tile past the end of the loaded GFX)
+// instead of opening a dialog itself. The editor installs a reporter that shows a message box, headless tools
+// keep the default one, which logs the message with qWarning.
+class ErrorReporter
+{
+public:
+    virtual ~ErrorReporter() = default;
+    // can be called from any thread
+    virtual void report(const QString& message) = 0;
+    // the reporter has to outlive every later call to error, nullptr restores the default
+    static void install(ErrorReporter* reporter);
+    static void error(const QString& message);
+};
+
+#endif // ERRORREPORTER_H
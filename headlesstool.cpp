@@ -0,0 +1,36 @@
+#include "headlesstool.h"
+#include <QDirIterator>
+#include <QSaveFile>
+#include <algorithm>
+#include <cstring>
+
+bool HeadlessTool::hasFlag(int argc, char* argv[], const char* flag) {
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], flag) == 0)
+            return true;
+    }
+    return false;
+}
+
+bool HeadlessTool::writeAtomically(const QString& name, const QByteArray& data, QString& error) {
+    return writeAtomically(name, [&data](QIODevice& out) { return out.write(data) == data.size(); }, error);
+}
+
+bool HeadlessTool::writeAtomically(const QString& name, const std::function<bool(QIODevice&)>& write, QString& error) {
+    QSaveFile out{name};
+    // a failed write isn't committed, QSaveFile drops the temporary file
+    if (!out.open(QIODevice::WriteOnly) || !write(out) || !out.commit()) {
+        error = out.errorString();
+        return false;
+    }
+    return true;
+}
+
+QStringList HeadlessTool::findFiles(const QString& dir, const QStringList& nameFilters) {
+    QStringList files;
+    QDirIterator it{dir, nameFilters, QDir::Files | QDir::CaseSensitive, QDirIterator::Subdirectories};
+    while (it.hasNext())
+        files.append(it.next());
+    std::sort(files.begin(), files.end());
+    return files;
+}
@@ -0,0 +1,62 @@
+#ifndef HEADLESSTOOL_H
+#define HEADLESSTOOL_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+#include <functional>
+
+// What the command line modes of the editor (--convert, --lint, --render-previews, --generate-corpus, --replay)
+// have in common: their exit codes, how main() tells they were asked for, how they find their input files
+// and how they write and report their output.
+namespace HeadlessTool
+{
+constexpr int ExitOk = 0;
+// some of the inputs failed, or the linter found issues
+constexpr int ExitFailures = 1;
+constexpr int ExitUsage = 2;
+
+// checked on the raw arguments, before main() decides which QApplication to create
+bool hasFlag(int argc, char* argv[], const char* flag);
+// the file is only replaced once everything was written, an interrupted run leaves no half files
+bool writeAtomically(const QString& name, const QByteArray& data, QString& error);
+// same, for writers that need the device, e.g. QImage::save
+bool writeAtomically(const QString& name, const std::function<bool(QIODevice&)>& write, QString& error);
+// the files under dir matching nameFilters, recursively and sorted, so the results don't depend on the filesystem
+QStringList findFiles(const QString& dir, const QStringList& nameFilters);
+
+// One line per result in their order and a line with the totals on stdout, returns the exit code.
+// Result needs source, target and message, and a status whose enum has Skipped and Failed, every other value
+// counts as done. details is appended to the line of a file that was done, e.g. how many displays it had.
+template <typename Result, typename Details>
+int printResults(const QVector<Result>& results, const char* done, qint64 elapsedMs, Details details) {
+    using Status = decltype(Result::status);
+    QTextStream out{stdout};
+    int finished = 0;
+    int skipped = 0;
+    int failed = 0;
+    for (auto& r : results) {
+        if (r.status == Status::Failed) {
+            failed++;
+            out << "FAIL " << r.source;
+        } else if (r.status == Status::Skipped) {
+            skipped++;
+            out << "SKIP " << r.source;
+        } else {
+            finished++;
+            out << "OK   " << r.source << " -> " << r.target << details(r);
+        }
+        if (!r.message.isEmpty())
+            out << ": " << r.message;
+        out << '\n';
+    }
+    out << QString::asprintf("%d %s, %d skipped, %d failed in %lld ms\n", finished, done, skipped, failed,
+                             static_cast<long long>(elapsedMs));
+    return failed > 0 ? ExitFailures : ExitOk;
+}
+}
+
+#endif // HEADLESSTOOL_H
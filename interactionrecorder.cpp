@@ -0,0 +1,164 @@
+#include "interactionrecorder.h"
+#include "headlesstool.h"
+#include <QFile>
+#include <QJsonDocument>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QWheelEvent>
+#include <QWidget>
+#include <utility>
+
+namespace {
+const QHash<QEvent::Type, QString>& typeNames() {
+    static const QHash<QEvent::Type, QString> names{
+        {QEvent::MouseButtonPress, "press"},
+        {QEvent::MouseButtonRelease, "release"},
+        {QEvent::MouseButtonDblClick, "dblclick"},
+        {QEvent::MouseMove, "move"},
+        {QEvent::Wheel, "wheel"},
+        {QEvent::KeyPress, "keypress"},
+        {QEvent::KeyRelease, "keyrelease"},
+    };
+    return names;
+}
+}
+
+InteractionRecorder::InteractionRecorder(const QVector<QPair<QString, QWidget*>>& targets, QObject* parent)
+    : QObject(parent) {
+    for (auto& [name, widget] : targets) {
+        m_targets.insert(widget, name);
+        widget->installEventFilter(this);
+    }
+}
+
+void InteractionRecorder::start(const QByteArray& sprite, int display, const QSize& window) {
+    m_recording = Recording{};
+    m_recording.sprite = QJsonDocument::fromJson(sprite).object();
+    m_recording.display = display;
+    m_recording.window = window;
+    m_clock.start();
+    m_active = true;
+}
+
+InteractionRecorder::Recording InteractionRecorder::stop() {
+    m_active = false;
+    return std::exchange(m_recording, Recording{});
+}
+
+bool InteractionRecorder::isRecording() const {
+    return m_active;
+}
+
+bool InteractionRecorder::eventFilter(QObject* watched, QEvent* event) {
+    if (!m_active || !typeNames().contains(event->type()))
+        return false;
+    auto it = m_targets.constFind(watched);
+    if (it != m_targets.cend())
+        m_recording.events.append(fromEvent(*it, event));
+    // only watching, the widget still gets the event
+    return false;
+}
+
+QJsonObject InteractionRecorder::fromEvent(const QString& target, const QEvent* event) const {
+    QJsonObject obj{
+        {"ms", m_clock.elapsed()},
+        {"target", target},
+        {"type", typeNames().value(event->type())},
+    };
+    switch (event->type()) {
+    case QEvent::Wheel: {
+        auto e = static_cast<const QWheelEvent*>(event);
+        obj["x"] = e->position().x();
+        obj["y"] = e->position().y();
+        obj["dx"] = e->angleDelta().x();
+        obj["dy"] = e->angleDelta().y();
+        obj["buttons"] = static_cast<int>(e->buttons());
+        obj["modifiers"] = static_cast<int>(e->modifiers());
+        break;
+    }
+    case QEvent::KeyPress:
+    case QEvent::KeyRelease: {
+        auto e = static_cast<const QKeyEvent*>(event);
+        obj["key"] = e->key();
+        obj["modifiers"] = static_cast<int>(e->modifiers());
+        obj["text"] = e->text();
+        obj["repeat"] = e->isAutoRepeat();
+        break;
+    }
+    default: {
+        auto e = static_cast<const QMouseEvent*>(event);
+        obj["x"] = e->position().x();
+        obj["y"] = e->position().y();
+        obj["button"] = static_cast<int>(e->button());
+        obj["buttons"] = static_cast<int>(e->buttons());
+        obj["modifiers"] = static_cast<int>(e->modifiers());
+        break;
+    }
+    }
+    return obj;
+}
+
+std::unique_ptr<QEvent> InteractionRecorder::toEvent(const QJsonObject& event, const QWidget* target) {
+    const QEvent::Type type = typeNames().key(event["type"].toString(), QEvent::None);
+    const QPointF pos{event["x"].toDouble(), event["y"].toDouble()};
+    const QPointF global = target->mapToGlobal(pos);
+    const auto buttons = Qt::MouseButtons::fromInt(event["buttons"].toInt());
+    const auto modifiers = Qt::KeyboardModifiers::fromInt(event["modifiers"].toInt());
+    switch (type) {
+    case QEvent::None:
+        return nullptr;
+    case QEvent::Wheel:
+        return std::make_unique<QWheelEvent>(pos, global, QPoint{}, QPoint{event["dx"].toInt(), event["dy"].toInt()},
+                                             buttons, modifiers, Qt::NoScrollPhase, false);
+    case QEvent::KeyPress:
+    case QEvent::KeyRelease:
+        return std::make_unique<QKeyEvent>(type, event["key"].toInt(), modifiers, event["text"].toString(), event["repeat"].toBool());
+    default:
+        return std::make_unique<QMouseEvent>(type, pos, global, static_cast<Qt::MouseButton>(event["button"].toInt()), buttons, modifiers);
+    }
+}
+
+QString InteractionRecorder::kind(const QJsonObject& event) {
+    const QString type = event["type"].toString();
+    // moving with a button held is a drag, it's usually far more expensive than hovering
+    if (type == "move" && event["buttons"].toInt() != 0)
+        return "drag";
+    return type;
+}
+
+bool InteractionRecorder::write(const QString& filename, const Recording& recording, QString& error) {
+    QJsonObject obj{
+        {"version", Version},
+        {"sprite", recording.sprite},
+        {"display", recording.display},
+        {"window", QJsonArray{recording.window.width(), recording.window.height()}},
+        {"events", recording.events},
+    };
+    QByteArray data = QJsonDocument{obj}.toJson(QJsonDocument::Compact);
+    return HeadlessTool::writeAtomically(filename, data, error);
+}
+
+bool InteractionRecorder::read(const QString& filename, Recording& recording, QString& error) {
+    QFile file{filename};
+    if (!file.open(QFile::OpenModeFlag::ReadOnly)) {
+        error = file.errorString();
+        return false;
+    }
+    QJsonParseError parseError{};
+    QJsonObject obj = QJsonDocument::fromJson(file.readAll(), &parseError).object();
+    if (parseError.error != QJsonParseError::NoError) {
+        error = QString::asprintf("Malformed JSON at offset %d: ", static_cast<int>(parseError.offset)) + parseError.errorString();
+        return false;
+    }
+    if (obj["version"].toInt() != Version) {
+        error = QString::asprintf("Unsupported recording version %d", obj["version"].toInt());
+        return false;
+    }
+    recording = Recording{};
+    recording.sprite = obj["sprite"].toObject();
+    recording.display = obj["display"].toInt(-1);
+    const QJsonArray window = obj["window"].toArray();
+    recording.window = QSize{window.at(0).toInt(), window.at(1).toInt()};
+    recording.events = obj["events"].toArray();
+    return true;
+}
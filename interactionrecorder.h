@@ -0,0 +1,55 @@
+#ifndef INTERACTIONRECORDER_H
+#define INTERACTIONRECORDER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QObject>
+#include <QSize>
+#include <QVector>
+#include <memory>
+
+class QEvent;
+class QWidget;
+
+// Captures the mouse, wheel and key events delivered to the editor's interactive widgets, together with the
+// sprite they were made on, so the interaction can be replayed headlessly (see InteractionReplayer).
+// A recording is a JSON file:
+//   {"version": 1, "sprite": {...}, "display": 3, "window": [w, h],
+//    "events": [{"ms": 12, "target": "display", "type": "press", "x": 40, "y": 18, "button": 1, ...}, ...]}
+// Targets are named by the editor (CFGEditor::interactionTargets), positions are local to the target.
+class InteractionRecorder : public QObject
+{
+    Q_OBJECT
+public:
+    static constexpr int Version = 1;
+    struct Recording {
+        QJsonObject sprite;
+        int display = -1;
+        QSize window;
+        QJsonArray events;
+    };
+    explicit InteractionRecorder(const QVector<QPair<QString, QWidget*>>& targets, QObject* parent = nullptr);
+    // sprite is the editor's state at the start, as written by JsonSprite::to_text
+    void start(const QByteArray& sprite, int display, const QSize& window);
+    // stops and returns what was recorded since start
+    Recording stop();
+    bool isRecording() const;
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+    static bool write(const QString& filename, const Recording& recording, QString& error);
+    static bool read(const QString& filename, Recording& recording, QString& error);
+    // the event to send to target, null for an object that isn't a recorded event
+    static std::unique_ptr<QEvent> toEvent(const QJsonObject& event, const QWidget* target);
+    // the group an event's latency is reported in, e.g. "press", "drag" or "wheel"
+    static QString kind(const QJsonObject& event);
+private:
+    QJsonObject fromEvent(const QString& target, const QEvent* event) const;
+    QHash<QObject*, QString> m_targets;
+    Recording m_recording;
+    QElapsedTimer m_clock;
+    bool m_active = false;
+};
+
+#endif // INTERACTIONRECORDER_H
@@ -0,0 +1,168 @@
+#include "interactionreplayer.h"
+#include "cfgeditor.h"
+#include "headlesstool.h"
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+using namespace HeadlessTool;
+
+namespace {
+double percentile(const QVector<qint64>& sorted, double p) {
+    const auto rank = static_cast<qsizetype>(std::ceil(p * sorted.size()));
+    return static_cast<double>(sorted[qBound<qsizetype>(0, rank - 1, sorted.size() - 1)]);
+}
+}
+
+bool InteractionReplayer::requested(int argc, char* argv[]) {
+    return hasFlag(argc, argv, "--replay");
+}
+
+int InteractionReplayer::run(const QStringList& arguments) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Replays recorded interactions on an offscreen editor and reports their latency.");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"replay", "Recording made with Display > Record Interactions.", "file"},
+        {"repeat", "Times the recording is replayed, defaults to 5.", "n", "5"},
+        {"output", "File the JSON latencies are written to.", "file"},
+    });
+    if (!parser.parse(arguments)) {
+        QTextStream(stderr) << parser.errorText() << '\n';
+        return ExitUsage;
+    }
+    if (parser.isSet("help")) {
+        QTextStream(stdout) << parser.helpText();
+        return ExitOk;
+    }
+    bool ok = false;
+    const int repeat = parser.value("repeat").toInt(&ok);
+    if (!ok || repeat < 1) {
+        QTextStream(stderr) << "--repeat expects a number of at least 1\n";
+        return ExitUsage;
+    }
+
+    InteractionRecorder::Recording recording;
+    QString error;
+    if (!InteractionRecorder::read(parser.value("replay"), recording, error)) {
+        QTextStream(stderr) << "FAIL " << parser.value("replay") << ": " << error << '\n';
+        return ExitFailures;
+    }
+    QMap<QString, QVector<qint64>> samples;
+    if (!replay(recording, repeat, samples, error)) {
+        QTextStream(stderr) << "FAIL " << error << '\n';
+        return ExitFailures;
+    }
+
+    QMap<QString, Latencies> groups;
+    for (auto it = samples.constBegin(); it != samples.constEnd(); ++it)
+        groups.insert(it.key(), summarize(it.value()));
+    QTextStream out{stdout};
+    out << QString::asprintf("%-24s %7s %10s %10s %10s %10s %10s %10s\n", "group (us)", "events", "mean", "p50", "p90", "p95", "p99", "max");
+    for (auto it = groups.constBegin(); it != groups.constEnd(); ++it) {
+        const Latencies& l = it.value();
+        out << QString::asprintf("%-24s %7d %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n", qPrintable(it.key()), l.count,
+                                 l.meanNs / 1e3, l.p50Ns / 1e3, l.p90Ns / 1e3, l.p95Ns / 1e3, l.p99Ns / 1e3, l.maxNs / 1e3);
+    }
+
+    if (parser.isSet("output")) {
+        QJsonObject obj = toJson(groups);
+        obj["recording"] = parser.value("replay");
+        obj["repeat"] = repeat;
+        QByteArray data = QJsonDocument{obj}.toJson();
+        if (!writeAtomically(parser.value("output"), data, error)) {
+            QTextStream(stderr) << "FAIL " << parser.value("output") << ": " << error << '\n';
+            return ExitFailures;
+        }
+    }
+    return ExitOk;
+}
+
+bool InteractionReplayer::replay(const InteractionRecorder::Recording& recording, int repeat, QMap<QString, QVector<qint64>>& samples, QString& error) {
+    // the editor only opens sprites from files
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        error = "could not create a temporary directory: " + dir.errorString();
+        return false;
+    }
+    const QString spriteFile = dir.filePath("sprite.json");
+    if (!writeAtomically(spriteFile, QJsonDocument{recording.sprite}.toJson(QJsonDocument::Compact), error)) {
+        error = spriteFile + ": " + error;
+        return false;
+    }
+
+    for (int r = 0; r < repeat; r++) {
+        // a fresh editor every time, the recorded events expect the state they were recorded on
+        CFGEditor editor{QStringList{spriteFile}};
+        if (recording.window.isValid())
+            editor.resize(recording.window);
+        editor.show();
+        editor.selectDisplay(recording.display);
+        QCoreApplication::processEvents();
+
+        QHash<QString, QWidget*> targets;
+        for (auto& [name, widget] : editor.interactionTargets())
+            targets.insert(name, widget);
+        QElapsedTimer timer;
+        for (const auto& value : recording.events) {
+            const QJsonObject event = value.toObject();
+            const QString target = event["target"].toString();
+            QWidget* widget = targets.value(target);
+            if (!widget) {
+                error = "the recording has events for an unknown target " + target;
+                return false;
+            }
+            auto e = InteractionRecorder::toEvent(event, widget);
+            if (!e) {
+                error = "the recording has an unknown event type " + event["type"].toString();
+                return false;
+            }
+            timer.start();
+            QCoreApplication::sendEvent(widget, e.get());
+            // the updates are posted, processing them draws what the event changed
+            QCoreApplication::processEvents();
+            const qint64 ns = timer.nsecsElapsed();
+            samples[target + "/" + InteractionRecorder::kind(event)].append(ns);
+            samples["all"].append(ns);
+        }
+    }
+    return true;
+}
+
+InteractionReplayer::Latencies InteractionReplayer::summarize(QVector<qint64> samples) {
+    Latencies l;
+    if (samples.isEmpty())
+        return l;
+    std::sort(samples.begin(), samples.end());
+    l.count = static_cast<int>(samples.size());
+    l.meanNs = std::accumulate(samples.cbegin(), samples.cend(), 0.0) / samples.size();
+    l.p50Ns = percentile(samples, 0.50);
+    l.p90Ns = percentile(samples, 0.90);
+    l.p95Ns = percentile(samples, 0.95);
+    l.p99Ns = percentile(samples, 0.99);
+    l.maxNs = static_cast<double>(samples.last());
+    return l;
+}
+
+QJsonObject InteractionReplayer::toJson(const QMap<QString, Latencies>& groups) {
+    QJsonObject obj;
+    for (auto it = groups.constBegin(); it != groups.constEnd(); ++it) {
+        const Latencies& l = it.value();
+        obj[it.key()] = QJsonObject{
+            {"count", l.count},
+            {"mean_ns", l.meanNs},
+            {"p50_ns", l.p50Ns},
+            {"p90_ns", l.p90Ns},
+            {"p95_ns", l.p95Ns},
+            {"p99_ns", l.p99Ns},
+            {"max_ns", l.maxNs},
+        };
+    }
+    return QJsonObject{{"groups", obj}};
+}
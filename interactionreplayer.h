@@ -0,0 +1,37 @@
+#ifndef INTERACTIONREPLAYER_H
+#define INTERACTIONREPLAYER_H
+
+#include <QJsonObject>
+#include <QMap>
+#include <QStringList>
+#include <QVector>
+#include "interactionrecorder.h"
+
+// Headless replay of recorded interactions, started with --replay <recording>.
+// The recorded sprite is opened in an editor window on the offscreen platform and every event is sent to its
+// target as fast as possible, ignoring the recorded timing. An event's latency is the time until it and
+// everything it caused (repaints included) has been processed. Latencies are reported as percentiles per
+// target and kind of event, e.g. "display/drag" or "map16/move".
+class InteractionReplayer
+{
+public:
+    struct Latencies {
+        int count = 0;
+        double meanNs = 0;
+        double p50Ns = 0;
+        double p90Ns = 0;
+        double p95Ns = 0;
+        double p99Ns = 0;
+        double maxNs = 0;
+    };
+    static bool requested(int argc, char* argv[]);
+    static int run(const QStringList& arguments);
+    // replays the recording repeat times, each on a freshly opened editor, and returns the latencies in ns per group,
+    // "all" has every event
+    static bool replay(const InteractionRecorder::Recording& recording, int repeat, QMap<QString, QVector<qint64>>& samples, QString& error);
+    // nearest rank percentiles
+    static Latencies summarize(QVector<qint64> samples);
+    static QJsonObject toJson(const QMap<QString, Latencies>& groups);
+};
+
+#endif // INTERACTIONREPLAYER_H
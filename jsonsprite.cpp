@@ -1,5 +1,27 @@
 #include "jsonsprite.h"
 #include "utils.h"
+#include "errorreporter.h"
+#include "spritesaver.h"
+#include "tracing.h"
+#include <array>
+#include <algorithm>
+
+using namespace std::string_view_literals;
+
+namespace {
+// "Extra Property Byte N" for N = 1..12, indexed by N - 1
+constexpr std::array<std::string_view, 12> collectionPropKeys = {
+    "Extra Property Byte 1"sv, "Extra Property Byte 2"sv, "Extra Property Byte 3"sv, "Extra Property Byte 4"sv,
+    "Extra Property Byte 5"sv, "Extra Property Byte 6"sv, "Extra Property Byte 7"sv, "Extra Property Byte 8"sv,
+    "Extra Property Byte 9"sv, "Extra Property Byte 10"sv, "Extra Property Byte 11"sv, "Extra Property Byte 12"sv
+};
+// the same indices in the order QJsonObject sorts the keys
+constexpr std::array<int, 12> collectionPropSortedOrder = {0, 9, 10, 11, 1, 2, 3, 4, 5, 6, 7, 8};
+
+QLatin1String latin1(std::string_view str) {
+    return QLatin1String{str.data(), static_cast<qsizetype>(str.size())};
+}
+}
 
 JSONDisplay::JSONDisplay(const QJsonObject& d, DisplayType type) {
     description = d["Description"].toString();
@@ -67,6 +89,16 @@ QJsonObject JSONDisplay::toJson(DisplayType type, bool translucencyCompatibility
     return obj;
 }
 
+quint64 JSONDisplay::hash() const {
+    StructuralHash h{};
+    h.add(description).add(extrabit).add(x_or_index).add(y_or_value).add(useText).add(displaytext);
+    h.add(gfxinfo.hash());
+    h.add(tiles.size());
+    for (auto& t : tiles)
+        h.add(t.hash());
+    return h.value();
+}
+
 SingleGFXFile::SingleGFXFile(bool separate, int value) : separate{separate}, value{value} {
 
 }
@@ -80,6 +112,9 @@ QJsonObject SingleGFXFile::toJson() const {
     obj["Value"] = value;
     return obj;
 }
+quint64 SingleGFXFile::hash() const {
+    return StructuralHash{}.add(separate).add(value).value();
+}
 
 GFXInfo::GFXInfo(SingleGFXFile s0, SingleGFXFile s1, SingleGFXFile s2, SingleGFXFile s3) :
     sp0(s0),
@@ -118,6 +153,10 @@ QJsonObject GFXInfo::toJson() const {
     return obj;
 }
 
+quint64 GFXInfo::hash() const {
+    return StructuralHash{}.add(sp0.hash()).add(sp1.hash()).add(sp2.hash()).add(sp3.hash()).value();
+}
+
 
 Tile::Tile(const QJsonObject& t) {
     xoff = t["X offset"].toInt();
@@ -128,6 +167,10 @@ Tile::Tile(const QJsonObject& t) {
     } else {
         translucent = false;
     }
+    foldTranslucency();
+}
+
+void Tile::foldTranslucency() {
     if ((tilenumber & 0x8000) == 0x8000) {
         tilenumber -= 0x8000;
         translucent = true;
@@ -155,15 +198,19 @@ QJsonObject Tile::toJson(bool translucencyCompatibility) const {
     return obj;
 }
 
+quint64 Tile::hash() const {
+    return StructuralHash{}.add(xoff).add(yoff).add(tilenumber).add(translucent).value();
+}
+
 Collection::Collection(const QJsonObject& c) {
     name = c["Name"].toString();
     extrabit = c["ExtraBit"].toBool();
-    for (int i = 1; i <= 12; i++) {
-        QString str = QString::asprintf("Extra Property Byte %d", i);
-        if (c.contains(str))
-            prop[i - 1] = c[str].toInt();
+    for (int i = 0; i < 12; i++) {
+        auto key = latin1(collectionPropKeys[i]);
+        if (c.contains(key))
+            prop[i] = c[key].toInt();
         else
-            prop[i - 1] = 0;
+            prop[i] = 0;
     }
 }
 
@@ -171,14 +218,22 @@ QJsonObject Collection::toJson() const {
     QJsonObject obj{};
     obj["Name"] = name;
     obj["ExtraBit"] = extrabit;
-    for (int i = 1; i <= 12; i++) {
-        QString str = QString::asprintf("Extra Property Byte %d", i);
-        obj[str] = prop[i - 1];
+    for (int i = 0; i < 12; i++) {
+        obj[latin1(collectionPropKeys[i])] = prop[i];
     }
     return obj;
 }
 
+quint64 Collection::hash() const {
+    StructuralHash h{};
+    h.add(name).add(extrabit);
+    for (auto p : prop)
+        h.add(p);
+    return h.value();
+}
+
 bool JsonSprite::from_file(const QString& name) {
+    TRACE_SCOPE("JsonSprite::from_file");
     if (name.length() == 0)
         return false;
     qDebug() << "Reading from " << name;
@@ -186,28 +241,60 @@ bool JsonSprite::from_file(const QString& name) {
     QFile file{m_name};
     TRY_OPEN(file.open(QFile::OpenModeFlag::ReadOnly));
     if (name.endsWith(".json")) {
-        auto doc = QJsonDocument::fromJson(file.readAll());
-        obj = doc.object();
-        deserialize();
+        auto data = file.readAll();
+        if (!deserialize_stream(data)) {
+            // anything the streaming reader doesn't accept goes through QJsonDocument, so malformed files load like they always did
+            obj = QJsonDocument::fromJson(data).object();
+            deserialize();
+        }
     }
     else if (name.endsWith(".cfg")) {
-        deserialize_cfg(file);
+        QString error;
+        if (!deserialize_cfg(file, error))
+            ErrorReporter::error(error);
     }
     else {
-        QMessageBox::warning(nullptr, "Error", "Unrecognized file extension, valid extensions are: .cfg, .json", QMessageBox::Ok );
+        ErrorReporter::error("Unrecognized file extension, valid extensions are: .cfg, .json");
         return false;
     }
     return true;
 
 }
 
-void JsonSprite::deserialize_cfg(QFile& file) {
+bool JsonSprite::load_file(const QString& name, QString& error) {
+    TRACE_SCOPE("JsonSprite::load_file");
+    m_name = name;
+    QFile file{m_name};
+    if (!file.open(QFile::OpenModeFlag::ReadOnly)) {
+        error = file.errorString();
+        return false;
+    }
+    if (name.endsWith(".json")) {
+        auto data = file.readAll();
+        if (deserialize_stream(data))
+            return true;
+        QJsonParseError parseError{};
+        obj = QJsonDocument::fromJson(data, &parseError).object();
+        if (parseError.error != QJsonParseError::NoError) {
+            error = QString::asprintf("Malformed JSON at offset %d: ", parseError.offset) + parseError.errorString();
+            return false;
+        }
+        deserialize();
+        return true;
+    }
+    if (name.endsWith(".cfg"))
+        return deserialize_cfg(file, error);
+    error = "Unrecognized file extension, valid extensions are: .cfg, .json";
+    return false;
+}
+
+bool JsonSprite::deserialize_cfg(QIODevice& file, QString& error) {
     type = QString{file.readLine()}.toInt(nullptr, 16);
     actlike = QString{file.readLine()}.toInt(nullptr, 16);
     auto tweaks = QString{file.readLine()}.split(" ", Qt::SplitBehaviorFlags::SkipEmptyParts);
     if (tweaks.length() != 6) {
-        QMessageBox::warning(nullptr, "Error", "CFG has unrecognized format", QMessageBox::Ok);
-        return;
+        error = "CFG has unrecognized format";
+        return false;
     }
     t1656.from_byte(tweaks[0].toInt(nullptr, 16));
     t1662.from_byte(tweaks[1].toInt(nullptr, 16));
@@ -217,8 +304,8 @@ void JsonSprite::deserialize_cfg(QFile& file) {
     t190f.from_byte(tweaks[5].toInt(nullptr, 16));
     auto props = QString{file.readLine()}.split(" ", Qt::SplitBehaviorFlags::SkipEmptyParts);
     if (props.length() != 2) {
-        QMessageBox::warning(nullptr, "Error", "CFG has unrecognized format", QMessageBox::Ok);
-        return;
+        error = "CFG has unrecognized format";
+        return false;
     }
     extraProp1 = props[0].toInt(nullptr, 16);
     extraProp2 = props[1].toInt(nullptr, 16);
@@ -231,6 +318,7 @@ void JsonSprite::deserialize_cfg(QFile& file) {
         addbcountclear = bytecount[0].toInt(nullptr, 16);
         addbcountset = bytecount[1].toInt(nullptr, 16);
     }
+    return true;
 }
 
 QByteArray JsonSprite::serialize_cfg() {
@@ -349,9 +437,7 @@ QByteArray JsonSprite::to_text(const QString& filename, bool translucencyCompati
     if (filename.endsWith(".cfg")) {
         return serialize_cfg();
     } else {
-        serialize(translucencyCompatibility);
-        QJsonDocument doc{obj};
-        return doc.toJson();
+        return serialize_stream(translucencyCompatibility);
     }
 }
 
@@ -359,68 +445,459 @@ QString& JsonSprite::name() {
     return m_name;
 }
 
+quint64 JsonSprite::tweaks_hash() const {
+    StructuralHash h{};
+    h.add(t1656.hash()).add(t1662.hash()).add(t166e.hash()).add(t167a.hash()).add(t1686.hash()).add(t190f.hash());
+    h.add(asmfile).add(actlike).add(type).add(extraProp1).add(extraProp2).add(addbcountclear).add(addbcountset);
+    return h.value();
+}
 
-bool JsonSprite::is_different(const JsonSprite& other) const {
-    const bool dt1656 = other.t1656 != t1656;
-    const bool dt1662 = other.t1662 != t1662;
-    const bool dt166e = other.t166e != t166e;
-    const bool dt167a = other.t167a != t167a;
-    const bool dt1686 = other.t1686 != t1686;
-    const bool dt190f = other.t190f != t190f;
-    const bool dfile = other.asmfile != asmfile;
-    const bool dal = other.actlike != actlike;
-    const bool dt = other.type != type;
-    const bool dep1 = other.extraProp1 != extraProp1;
-    const bool dep2 = other.extraProp2 != extraProp2;
-    const bool dcc = addbcountclear != other.addbcountclear;
-    const bool dcs = addbcountset != other.addbcountset;
-
-    if (dt1656 || dt1662 || dt166e || dt167a || dt1686 || dt190f) return true;
-    if (dfile || dal || dt || dep1 || dep2 || dcc || dcs) return true;
+quint64 JsonSprite::displays_hash() const {
+    StructuralHash h{};
+    h.add(static_cast<quint64>(dispType)).add(displays.size());
+    for (auto& d : displays)
+        h.add(d.hash());
+    return h.value();
+}
 
-    if (map16 != other.map16 || m_name != other.m_name || dispType != other.dispType) return true;
+quint64 JsonSprite::collections_hash() const {
+    StructuralHash h{};
+    h.add(collections.size());
+    for (auto& c : collections)
+        h.add(c.hash());
+    return h.value();
+}
 
-    if (displays != other.displays || collections != other.collections) return true;
+quint64 JsonSprite::map16_hash() const {
+    return StructuralHash{}.add(map16).value();
+}
 
-    return false;
+quint64 JsonSprite::hash() const {
+    return StructuralHash{}.add(tweaks_hash()).add(displays_hash()).add(collections_hash()).add(map16_hash()).value();
 }
 
 bool JsonSprite::to_file(QString name, bool translucencyCompatibility) {
-    if (name.length() == 0) {
-        if (m_name.length() == 0)
-            name = QFileDialog::getSaveFileName(nullptr, "Save file", "", "JSON (*.json);;CFG (*.cfg)");
+    TRACE_SCOPE("JsonSprite::to_file");
+    if (name.length() == 0)
+        name = m_name;
+    if (name.length() == 0)
+        return false;
+    bool written = false;
+    QString error;
+    return SpriteSaver::writeFile(name, to_text(name, translucencyCompatibility), written, error);
+}
+
+void JsonSprite::addDisplay(const JSONDisplay& display) {
+    displays.append(display);
+}
+
+void JsonSprite::setMap16(const QString& mapdata) {
+    map16 = mapdata;
+}
+
+namespace {
+SingleGFXFile readGFXFile(JsonStreamReader& r) {
+    // a present but empty entry reads as {false, 0}, same as SingleGFXFile(QJsonObject)
+    SingleGFXFile file{false, 0};
+    if (!r.enterObject())
+        return file;
+    std::string_view key;
+    while (r.nextMember(key)) {
+        if (key == "Separate"sv)
+            file.separate = r.readBool();
+        else if (key == "Value"sv)
+            file.value = r.readInt();
         else
-            name = m_name;
-        if (name.length() == 0)
-            return false;
-        QFile outFile{name};
-        TRY_OPEN(outFile.open(QFile::OpenModeFlag::Truncate | QFile::OpenModeFlag::Text | QFile::OpenModeFlag::WriteOnly));
-        outFile.write(to_text(name, translucencyCompatibility));
-    } else {
-        QFile outFile{name};
-        TRY_OPEN(outFile.open(QFile::OpenModeFlag::Truncate | QFile::OpenModeFlag::Text | QFile::OpenModeFlag::WriteOnly));
-        outFile.write(to_text(name, translucencyCompatibility));
+            r.readRaw();
     }
-    return true;
+    return file;
+}
+
+GFXInfo readGFXInfo(JsonStreamReader& r) {
+    GFXInfo info{};
+    if (!r.enterObject())
+        return info;
+    std::string_view key;
+    while (r.nextMember(key)) {
+        if (key == "0"sv)
+            info.sp0 = readGFXFile(r);
+        else if (key == "1"sv)
+            info.sp1 = readGFXFile(r);
+        else if (key == "2"sv)
+            info.sp2 = readGFXFile(r);
+        else if (key == "3"sv)
+            info.sp3 = readGFXFile(r);
+        else
+            r.readRaw();
+    }
+    return info;
 }
 
-void JsonSprite::addCollections(QTableView* view) {
-    auto model = view->model();
-    for (int i = 0; i < model->rowCount(); i++) {
-        QJsonObject obj;
-        obj["Name"] = model->index(i, 0).data().toString();
-        obj["ExtraBit"] = model->index(i, 1).data().toBool();
-        for (int j = 0; j < 12; j++) {
-            obj[QString::asprintf("Extra Property Byte %d", j + 1)] = model->index(i, j + 2).data().toString().toInt(nullptr, 16);
+Tile readTile(JsonStreamReader& r) {
+    Tile tile{0, 0, 0, false};
+    if (r.enterObject()) {
+        std::string_view key;
+        while (r.nextMember(key)) {
+            if (key == "X offset"sv)
+                tile.xoff = r.readInt();
+            else if (key == "Y offset"sv)
+                tile.yoff = r.readInt();
+            else if (key == "map16 tile"sv)
+                tile.tilenumber = r.readInt();
+            else if (key == "Translucent"sv)
+                tile.translucent = r.readBool();
+            else
+                r.readRaw();
         }
-        collections.append(Collection{obj});
     }
+    tile.foldTranslucency();
+    return tile;
 }
 
-void JsonSprite::addDisplay(const JSONDisplay& display) {
-    displays.append(display);
+// X/Y and Index/Value are both kept because "DisplayType" may come after "Displays" in the file
+struct PendingDisplay {
+    QString description;
+    QVector<Tile> tiles;
+    bool extrabit = false;
+    int x = 0;
+    int y = 0;
+    int index = 0;
+    int value = 0;
+    bool useText = false;
+    QString displaytext;
+    GFXInfo gfxinfo{};
+};
+
+PendingDisplay readDisplay(JsonStreamReader& r) {
+    PendingDisplay d;
+    if (!r.enterObject())
+        return d;
+    std::string_view key;
+    while (r.nextMember(key)) {
+        if (key == "Description"sv)
+            d.description = r.readString();
+        else if (key == "DisplayText"sv)
+            d.displaytext = r.readString();
+        else if (key == "ExtraBit"sv)
+            d.extrabit = r.readBool();
+        else if (key == "GFXInfo"sv)
+            d.gfxinfo = readGFXInfo(r);
+        else if (key == "X"sv)
+            d.x = r.readInt();
+        else if (key == "Y"sv)
+            d.y = r.readInt();
+        else if (key == "Index"sv)
+            d.index = r.readInt();
+        else if (key == "Value"sv)
+            d.value = r.readInt();
+        else if (key == "UseText"sv)
+            d.useText = r.readBool();
+        else if (key == "Tiles"sv) {
+            d.tiles.clear();
+            if (r.enterArray()) {
+                while (r.nextElement())
+                    d.tiles.append(readTile(r));
+            }
+        }
+        else
+            r.readRaw();
+    }
+    return d;
 }
 
-void JsonSprite::setMap16(const QString& mapdata) {
-    map16 = mapdata;
+JSONDisplay toDisplay(PendingDisplay& p, DisplayType type) {
+    bool xy = type == DisplayType::XY;
+    JSONDisplay display{p.description, {}, p.extrabit, xy ? p.x : p.index, xy ? p.y : p.value, p.useText, p.useText ? p.displaytext : QString{}, p.gfxinfo};
+    if (p.useText)
+        display.tiles.append(p.tiles.isEmpty() ? Tile{0, 0, 0, false} : p.tiles.first());
+    else
+        display.tiles = std::move(p.tiles);
+    return display;
+}
+
+Collection readCollection(JsonStreamReader& r) {
+    Collection c{};
+    if (!r.enterObject())
+        return c;
+    std::string_view key;
+    while (r.nextMember(key)) {
+        if (key == "Name"sv) {
+            c.name = r.readString();
+        } else if (key == "ExtraBit"sv) {
+            c.extrabit = r.readBool();
+        } else {
+            auto it = std::find(collectionPropKeys.cbegin(), collectionPropKeys.cend(), key);
+            if (it != collectionPropKeys.cend())
+                c.prop[it - collectionPropKeys.cbegin()] = r.readInt();
+            else
+                r.readRaw();
+        }
+    }
+    return c;
+}
+
+QJsonObject readSmallObject(JsonStreamReader& r) {
+    return r.readValue().toObject();
+}
+}
+
+bool JsonSprite::deserialize_stream(const QByteArray& data) {
+    // everything is read into locals and only committed if the whole document parsed,
+    // so on failure the caller can still fall back to QJsonDocument on an untouched sprite
+    JsonStreamReader r{data};
+    if (!r.enterObject())
+        return false;
+    J1656 r1656; r1656.from_json(QJsonObject{});
+    J1662 r1662; r1662.from_json(QJsonObject{});
+    J166E r166e; r166e.from_json(QJsonObject{});
+    J167A r167a; r167a.from_json(QJsonObject{});
+    J1686 r1686; r1686.from_json(QJsonObject{});
+    J190F r190f; r190f.from_json(QJsonObject{});
+    QString rasmfile;
+    int ractlike = 0;
+    int rtype = 0;
+    int rextraProp1 = 0;
+    int rextraProp2 = 0;
+    int raddbcountclear = 0;
+    int raddbcountset = 0;
+    QString rmap16;
+    DisplayType rdispType = DisplayType::XY;
+    QVector<PendingDisplay> pending;
+    QVector<Collection> rcollections;
+    QJsonObject unknown;
+
+    std::string_view key;
+    while (r.nextMember(key)) {
+        if (key == "$1656"sv)
+            r1656.from_json(readSmallObject(r));
+        else if (key == "$1662"sv)
+            r1662.from_json(readSmallObject(r));
+        else if (key == "$166E"sv)
+            r166e.from_json(readSmallObject(r));
+        else if (key == "$167A"sv)
+            r167a.from_json(readSmallObject(r));
+        else if (key == "$1686"sv)
+            r1686.from_json(readSmallObject(r));
+        else if (key == "$190F"sv)
+            r190f.from_json(readSmallObject(r));
+        else if (key == "AsmFile"sv)
+            rasmfile = r.readString();
+        else if (key == "ActLike"sv)
+            ractlike = r.readInt();
+        else if (key == "Type"sv)
+            rtype = r.readInt();
+        else if (key == "Extra Property Byte 1"sv)
+            rextraProp1 = r.readInt();
+        else if (key == "Extra Property Byte 2"sv)
+            rextraProp2 = r.readInt();
+        else if (key == "Additional Byte Count (extra bit clear)"sv)
+            raddbcountclear = r.readInt();
+        else if (key == "Additional Byte Count (extra bit set)"sv)
+            raddbcountset = r.readInt();
+        else if (key == "Map16"sv)
+            rmap16 = r.readString();
+        else if (key == "DisplayType"sv)
+            rdispType = r.readString() == "ExByte" ? DisplayType::ExtraByte : DisplayType::XY;
+        else if (key == "Displays"sv) {
+            pending.clear();
+            if (r.enterArray()) {
+                while (r.nextElement())
+                    pending.append(readDisplay(r));
+            }
+        }
+        else if (key == "Collection"sv) {
+            rcollections.clear();
+            if (r.enterArray()) {
+                while (r.nextElement())
+                    rcollections.append(readCollection(r));
+            }
+        }
+        else {
+            // keep keys we don't know about so saving the file doesn't drop them
+            QString name = QString::fromUtf8(key.data(), static_cast<qsizetype>(key.size()));
+            unknown.insert(name, r.readValue());
+        }
+    }
+    if (!r.atEnd()) {
+        qWarning().noquote() << m_name << "is read again with QJsonDocument, the streaming reader stopped:" << r.errorString();
+        return false;
+    }
+
+    t1656 = r1656;
+    t1662 = r1662;
+    t166e = r166e;
+    t167a = r167a;
+    t1686 = r1686;
+    t190f = r190f;
+    asmfile = rasmfile;
+    actlike = ractlike;
+    type = rtype;
+    extraProp1 = rextraProp1;
+    extraProp2 = rextraProp2;
+    addbcountclear = raddbcountclear;
+    addbcountset = raddbcountset;
+    map16 = rmap16;
+    dispType = rdispType;
+    displays.reserve(displays.size() + pending.size());
+    for (auto& p : pending)
+        displays.push_back(toDisplay(p, dispType));
+    collections.append(rcollections);
+    obj = unknown;
+    return true;
+}
+
+namespace {
+void writeGFXInfo(JsonStreamWriter& w, const GFXInfo& info) {
+    w.beginObject();
+    const SingleGFXFile* files[4] = {&info.sp0, &info.sp1, &info.sp2, &info.sp3};
+    constexpr std::array<std::string_view, 4> keys = {"0"sv, "1"sv, "2"sv, "3"sv};
+    for (int i = 0; i < 4; i++) {
+        if (files[i]->value == 0x7F)
+            continue;
+        w.key(keys[i]);
+        w.beginObject();
+        w.key("Separate"sv);
+        w.value(files[i]->separate);
+        w.key("Value"sv);
+        w.value(files[i]->value);
+        w.endObject();
+    }
+    w.endObject();
+}
+
+void writeTile(JsonStreamWriter& w, const Tile& t, bool translucencyCompatibility) {
+    // same encoding as Tile::toJson
+    w.beginObject();
+    if (!translucencyCompatibility) {
+        w.key("Translucent"sv);
+        w.value(t.translucent);
+    }
+    w.key("X offset"sv);
+    w.value(t.xoff);
+    w.key("Y offset"sv);
+    w.value(t.yoff);
+    w.key("map16 tile"sv);
+    if (translucencyCompatibility)
+        w.value(t.tilenumber + (t.translucent ? 0x8000 : 0) - (t.translucent && t.tilenumber < 0x300 ? 0x100 : 0));
+    else
+        w.value(t.tilenumber);
+    w.endObject();
+}
+
+void writeDisplay(JsonStreamWriter& w, const JSONDisplay& d, DisplayType type, bool translucencyCompatibility) {
+    // keys in the order QJsonObject sorts them, see JSONDisplay::toJson for the content
+    w.beginObject();
+    w.key("Description"sv);
+    w.value(d.description);
+    w.key("DisplayText"sv);
+    w.value(d.useText ? d.displaytext : QString{});
+    w.key("ExtraBit"sv);
+    w.value(d.extrabit);
+    w.key("GFXInfo"sv);
+    writeGFXInfo(w, d.gfxinfo);
+    if (type == DisplayType::ExtraByte) {
+        w.key("Index"sv);
+        w.value(d.x_or_index);
+    }
+    w.key("Tiles"sv);
+    w.beginArray();
+    if (d.useText) {
+        if (!d.tiles.isEmpty())
+            writeTile(w, d.tiles.first(), translucencyCompatibility);
+    } else {
+        for (auto& t : d.tiles)
+            writeTile(w, t, translucencyCompatibility);
+    }
+    w.endArray();
+    w.key("UseText"sv);
+    w.value(d.useText);
+    if (type == DisplayType::XY) {
+        w.key("X"sv);
+        w.value(d.x_or_index);
+        w.key("Y"sv);
+        w.value(d.y_or_value);
+    } else {
+        w.key("Value"sv);
+        w.value(d.y_or_value);
+    }
+    w.endObject();
+}
+
+void writeCollection(JsonStreamWriter& w, const Collection& c) {
+    w.beginObject();
+    for (int i : collectionPropSortedOrder) {
+        w.key(collectionPropKeys[i]);
+        w.value(static_cast<int>(c.prop[i]));
+    }
+    w.key("ExtraBit"sv);
+    w.value(c.extrabit);
+    w.key("Name"sv);
+    w.value(c.name);
+    w.endObject();
+}
+
+using TopLevelWriter = void (*)(std::string_view key, const JsonSprite& s, JsonStreamWriter& w, bool translucencyCompatibility);
+
+void writeTweak(std::string_view key, const QJsonObject& tweak, JsonStreamWriter& w) {
+    // tweak bytes are a handful of small fixed objects, QJsonDocument formats them
+    w.member(QString{latin1(key)}, tweak);
+}
+
+// top level members in the order QJsonObject sorts them, see JsonSprite::serialize for the content
+const std::array<std::pair<std::string_view, TopLevelWriter>, 17> topLevelWriters = {{
+    {"$1656"sv, [](std::string_view k, const JsonSprite& s, JsonStreamWriter& w, bool) { writeTweak(k, s.t1656.to_json(), w); }},
+    {"$1662"sv, [](std::string_view k, const JsonSprite& s, JsonStreamWriter& w, bool) { writeTweak(k, s.t1662.to_json(), w); }},
+    {"$166E"sv, [](std::string_view k, const JsonSprite& s, JsonStreamWriter& w, bool) { writeTweak(k, s.t166e.to_json(), w); }},
+    {"$167A"sv, [](std::string_view k, const JsonSprite& s, JsonStreamWriter& w, bool) { writeTweak(k, s.t167a.to_json(), w); }},
+    {"$1686"sv, [](std::string_view k, const JsonSprite& s, JsonStreamWriter& w, bool) { writeTweak(k, s.t1686.to_json(), w); }},
+    {"$190F"sv, [](std::string_view k, const JsonSprite& s, JsonStreamWriter& w, bool) { writeTweak(k, s.t190f.to_json(), w); }},
+    {"ActLike"sv, [](std::string_view k, const JsonSprite& s, JsonStreamWriter& w, bool) { w.key(k); w.value(static_cast<int>(s.actlike)); }},
+    {"Additional Byte Count (extra bit clear)"sv, [](std::string_view k, const JsonSprite& s, JsonStreamWriter& w, bool) { w.key(k); w.value(s.addbcountclear); }},
+    {"Additional Byte Count (extra bit set)"sv, [](std::string_view k, const JsonSprite& s, JsonStreamWriter& w, bool) { w.key(k); w.value(s.addbcountset); }},
+    {"AsmFile"sv, [](std::string_view k, const JsonSprite& s, JsonStreamWriter& w, bool) { w.key(k); w.value(s.asmfile.trimmed()); }},
+    {"Collection"sv, [](std::string_view k, const JsonSprite& s, JsonStreamWriter& w, bool) {
+        w.key(k);
+        w.beginArray();
+        for (auto& c : s.collections)
+            writeCollection(w, c);
+        w.endArray();
+    }},
+    {"DisplayType"sv, [](std::string_view k, const JsonSprite& s, JsonStreamWriter& w, bool) { w.key(k); w.value(s.dispType == DisplayType::XY ? "XY"sv : "ExByte"sv); }},
+    {"Displays"sv, [](std::string_view k, const JsonSprite& s, JsonStreamWriter& w, bool translucencyCompatibility) {
+        w.key(k);
+        w.beginArray();
+        for (auto& d : s.displays)
+            writeDisplay(w, d, s.dispType, translucencyCompatibility);
+        w.endArray();
+    }},
+    {"Extra Property Byte 1"sv, [](std::string_view k, const JsonSprite& s, JsonStreamWriter& w, bool) { w.key(k); w.value(static_cast<int>(s.extraProp1)); }},
+    {"Extra Property Byte 2"sv, [](std::string_view k, const JsonSprite& s, JsonStreamWriter& w, bool) { w.key(k); w.value(static_cast<int>(s.extraProp2)); }},
+    {"Map16"sv, [](std::string_view k, const JsonSprite& s, JsonStreamWriter& w, bool) { w.key(k); w.value(s.map16); }},
+    {"Type"sv, [](std::string_view k, const JsonSprite& s, JsonStreamWriter& w, bool) { w.key(k); w.value(static_cast<int>(s.type)); }},
+}};
+}
+
+QByteArray JsonSprite::serialize_stream(bool translucencyCompatibility) const {
+    // byte for byte what QJsonDocument{obj}.toJson() gives after serialize(), without building the tree
+    QByteArray out;
+    qsizetype tileCount = 0;
+    for (auto& d : displays)
+        tileCount += d.tiles.size();
+    out.reserve(2048 + map16.size() + displays.size() * 320 + tileCount * 110 + collections.size() * 500);
+    JsonStreamWriter w{out};
+    w.beginObject();
+    // keys from the loaded file we don't know about are merged in sorted order, like serialize() leaves them in obj
+    auto unknown = obj.constBegin();
+    for (auto& [key, write] : topLevelWriters) {
+        auto name = latin1(key);
+        for (; unknown != obj.constEnd() && unknown.key() < name; ++unknown)
+            w.member(unknown.key(), unknown.value());
+        if (unknown != obj.constEnd() && unknown.key() == name)
+            ++unknown;
+        write(key, *this, w, translucencyCompatibility);
+    }
+    for (; unknown != obj.constEnd(); ++unknown)
+        w.member(unknown.key(), unknown.value());
+    w.endObject();
+    return out;
 }
@@ -4,10 +4,9 @@
 #include <QFile>
 #include <QJsonObject>
 #include <QJsonArray>
-#include <QTableView>
-#include <QFileDialog>
-#include <QMessageBox>
 #include "tweak_bytes.h"
+#include "jsonstream.h"
+#include "structuralhash.h"
 
 enum DisplayType {
     XY,
@@ -21,6 +20,7 @@ struct SingleGFXFile {
     SingleGFXFile(bool separate, int value);
     SingleGFXFile(const QJsonObject& g);
     QJsonObject toJson() const;
+    quint64 hash() const;
     constexpr bool operator==(const SingleGFXFile& ) const = default;
 };
 
@@ -33,6 +33,7 @@ struct GFXInfo {
     GFXInfo(SingleGFXFile s0, SingleGFXFile s1, SingleGFXFile s2, SingleGFXFile s3);
     GFXInfo(const QJsonObject& g);
     QJsonObject toJson() const;
+    quint64 hash() const;
     constexpr bool operator==(const GFXInfo& ) const = default;
 };
 
@@ -44,6 +45,9 @@ struct Tile {
     Tile(int x, int y, int tileno, bool translucent);
     Tile(const QJsonObject& d);
     QJsonObject toJson(bool translucencyCompatibility) const;
+    // turns the old 0x8000/0x7F00 translucency encoding of "map16 tile" into the translucent flag
+    void foldTranslucency();
+    quint64 hash() const;
     constexpr bool operator==(const Tile& ) const = default;
 };
 
@@ -59,15 +63,18 @@ struct JSONDisplay {
     JSONDisplay(const QJsonObject& t, DisplayType type);
     JSONDisplay(const QString& d, const QVector<Tile>& ts, bool bit, int xx, int yy, bool text, const QString& disp, const GFXInfo& info);
     QJsonObject toJson(DisplayType type, bool translucencyCompatibility) const;
+    quint64 hash() const;
     bool operator==(const JSONDisplay& ) const = default;
 };
 
 struct Collection {
     QString name;
-    bool extrabit;
-    uint8_t prop[12];
+    bool extrabit{false};
+    uint8_t prop[12]{};
+    Collection() = default;
     Collection(const QJsonObject& c);
     QJsonObject toJson() const;
+    quint64 hash() const;
     bool operator==(const Collection& ) const = default;
 };
 
@@ -78,17 +85,29 @@ public:
     JsonSprite& operator=(const JsonSprite&) = default;
     void reset();
     bool from_file(const QString& name);
+    // from_file without any dialog, also fails on malformed JSON instead of loading an empty sprite
+    bool load_file(const QString& name, QString& error);
     void deserialize();
-    void deserialize_cfg(QFile& file);
+    bool deserialize_stream(const QByteArray& data);
+    bool deserialize_cfg(QIODevice& file, QString& error);
     void serialize(bool translucencyCompatibility);
+    QByteArray serialize_stream(bool translucencyCompatibility) const;
     QByteArray serialize_cfg();
-    void addCollections(QTableView* view);
     void addDisplay(const JSONDisplay& display);
     void setMap16(const QString& mapdata);
     QByteArray to_text(const QString& filename, bool translucencyCompatibility);
+    // an empty name saves to the file the sprite was loaded from, fails if there is none
+    // the file is replaced atomically and left alone if it already has the same contents, see SpriteSaver
     bool to_file(QString name, bool translucencyCompatibility);
     QString& name();
-    bool is_different(const JsonSprite& other) const;
+    // structural hashes, equal sprites (or sections) always hash the same
+    // tweaks_hash covers the tweak bytes and the other sprite properties, displays_hash includes the display type
+    quint64 tweaks_hash() const;
+    quint64 displays_hash() const;
+    quint64 collections_hash() const;
+    quint64 map16_hash() const;
+    // the whole sprite except its file name and unknown keys, meant to find duplicate sprites
+    quint64 hash() const;
     J1656 t1656;
     J1662 t1662;
     J166E t166e;
@@ -0,0 +1,506 @@
+#include "jsonstream.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <charconv>
+#include <limits>
+
+JsonStreamReader::JsonStreamReader(const QByteArray& data) :
+    m_begin(data.constData()),
+    m_cur(data.constData()),
+    m_end(data.constData() + data.size())
+{
+    // QJsonDocument skips a utf8 bom too
+    if (m_end - m_cur >= 3 && std::string_view{m_cur, 3} == "\xEF\xBB\xBF")
+        m_cur += 3;
+}
+
+void JsonStreamReader::fail(const char* what) {
+    if (m_error)
+        return;
+    m_error = true;
+    m_errorString = QString::asprintf("%s at offset %lld", what, static_cast<long long>(m_cur - m_begin));
+    m_cur = m_end;
+}
+
+void JsonStreamReader::skipWhitespace() {
+    while (m_cur != m_end && (*m_cur == ' ' || *m_cur == '\t' || *m_cur == '\n' || *m_cur == '\r'))
+        m_cur++;
+}
+
+char JsonStreamReader::peek() {
+    skipWhitespace();
+    return m_cur == m_end ? '\0' : *m_cur;
+}
+
+bool JsonStreamReader::consume(char c) {
+    if (peek() != c) {
+        fail("unexpected character");
+        return false;
+    }
+    m_cur++;
+    return true;
+}
+
+bool JsonStreamReader::skipString() {
+    // m_cur is on the opening quote
+    m_cur++;
+    while (m_cur != m_end) {
+        unsigned char c = static_cast<unsigned char>(*m_cur++);
+        if (c == '"')
+            return true;
+        if (c < 0x20) {
+            fail("control character in string");
+            return false;
+        }
+        if (c == '\\') {
+            if (m_cur == m_end)
+                break;
+            m_cur++;
+        }
+    }
+    fail("unterminated string");
+    return false;
+}
+
+bool JsonStreamReader::skipNumber() {
+    auto digits = [this] {
+        const char* start = m_cur;
+        while (m_cur != m_end && *m_cur >= '0' && *m_cur <= '9')
+            m_cur++;
+        return m_cur != start;
+    };
+    if (m_cur != m_end && *m_cur == '-')
+        m_cur++;
+    if (m_cur != m_end && *m_cur == '0')
+        m_cur++;
+    else if (!digits()) {
+        fail("invalid number");
+        return false;
+    }
+    if (m_cur != m_end && *m_cur == '.') {
+        m_cur++;
+        if (!digits()) {
+            fail("invalid number");
+            return false;
+        }
+    }
+    if (m_cur != m_end && (*m_cur == 'e' || *m_cur == 'E')) {
+        m_cur++;
+        if (m_cur != m_end && (*m_cur == '+' || *m_cur == '-'))
+            m_cur++;
+        if (!digits()) {
+            fail("invalid number");
+            return false;
+        }
+    }
+    return true;
+}
+
+bool JsonStreamReader::skipLiteral(std::string_view literal) {
+    if (static_cast<size_t>(m_end - m_cur) < literal.size() || std::string_view{m_cur, literal.size()} != literal) {
+        fail("invalid literal");
+        return false;
+    }
+    m_cur += literal.size();
+    return true;
+}
+
+bool JsonStreamReader::skipValue() {
+    switch (peek()) {
+    case '{': {
+        enterObject();
+        std::string_view key;
+        while (nextMember(key))
+            skipValue();
+        return !m_error;
+    }
+    case '[':
+        enterArray();
+        while (nextElement())
+            skipValue();
+        return !m_error;
+    case '"':
+        return skipString();
+    case 't':
+        return skipLiteral("true");
+    case 'f':
+        return skipLiteral("false");
+    case 'n':
+        return skipLiteral("null");
+    case '-':
+    case '0': case '1': case '2': case '3': case '4':
+    case '5': case '6': case '7': case '8': case '9':
+        return skipNumber();
+    default:
+        fail("unexpected character");
+        return false;
+    }
+}
+
+bool JsonStreamReader::decodeString(QByteArray& utf8) {
+    // m_cur is on the opening quote
+    utf8.clear();
+    m_cur++;
+    auto hex4 = [this](char16_t& out) {
+        if (m_end - m_cur < 4)
+            return false;
+        unsigned int value = 0;
+        auto res = std::from_chars(m_cur, m_cur + 4, value, 16);
+        if (res.ptr != m_cur + 4)
+            return false;
+        out = static_cast<char16_t>(value);
+        m_cur += 4;
+        return true;
+    };
+    while (m_cur != m_end) {
+        const char* run = m_cur;
+        while (m_cur != m_end && *m_cur != '"' && *m_cur != '\\' && static_cast<unsigned char>(*m_cur) >= 0x20)
+            m_cur++;
+        utf8.append(run, m_cur - run);
+        if (m_cur == m_end)
+            break;
+        char c = *m_cur++;
+        if (c == '"')
+            return true;
+        if (c != '\\') {
+            fail("control character in string");
+            return false;
+        }
+        if (m_cur == m_end)
+            break;
+        switch (*m_cur++) {
+        case '"': utf8.append('"'); break;
+        case '\\': utf8.append('\\'); break;
+        case '/': utf8.append('/'); break;
+        case 'b': utf8.append('\b'); break;
+        case 'f': utf8.append('\f'); break;
+        case 'n': utf8.append('\n'); break;
+        case 'r': utf8.append('\r'); break;
+        case 't': utf8.append('\t'); break;
+        case 'u': {
+            char16_t units[2];
+            if (!hex4(units[0])) {
+                fail("invalid escape sequence");
+                return false;
+            }
+            qsizetype n = 1;
+            if (QChar::isHighSurrogate(units[0])) {
+                if (m_end - m_cur < 6 || m_cur[0] != '\\' || m_cur[1] != 'u') {
+                    fail("invalid surrogate pair");
+                    return false;
+                }
+                m_cur += 2;
+                if (!hex4(units[1]) || !QChar::isLowSurrogate(units[1])) {
+                    fail("invalid surrogate pair");
+                    return false;
+                }
+                n = 2;
+            } else if (QChar::isLowSurrogate(units[0])) {
+                fail("invalid surrogate pair");
+                return false;
+            }
+            utf8.append(QStringView{units, n}.toUtf8());
+            break;
+        }
+        default:
+            fail("invalid escape sequence");
+            return false;
+        }
+    }
+    fail("unterminated string");
+    return false;
+}
+
+bool JsonStreamReader::enterObject() {
+    if (peek() != '{') {
+        skipValue();
+        return false;
+    }
+    if (m_first.size() >= MaxDepth) {
+        fail("nesting too deep");
+        return false;
+    }
+    m_cur++;
+    m_first.append(true);
+    return true;
+}
+
+bool JsonStreamReader::enterArray() {
+    if (peek() != '[') {
+        skipValue();
+        return false;
+    }
+    if (m_first.size() >= MaxDepth) {
+        fail("nesting too deep");
+        return false;
+    }
+    m_cur++;
+    m_first.append(true);
+    return true;
+}
+
+bool JsonStreamReader::nextMember(std::string_view& key) {
+    if (m_error || m_first.isEmpty())
+        return false;
+    if (peek() == '}') {
+        m_cur++;
+        m_first.removeLast();
+        return false;
+    }
+    if (!m_first.last() && !consume(','))
+        return false;
+    m_first.last() = false;
+    if (peek() != '"') {
+        fail("expected a key");
+        return false;
+    }
+    const char* start = m_cur + 1;
+    if (!skipString())
+        return false;
+    key = std::string_view{start, static_cast<size_t>(m_cur - start - 1)};
+    if (key.find('\\') != std::string_view::npos) {
+        m_cur = start - 1;
+        if (!decodeString(m_keyBuffer))
+            return false;
+        key = std::string_view{m_keyBuffer.constData(), static_cast<size_t>(m_keyBuffer.size())};
+    }
+    return consume(':');
+}
+
+bool JsonStreamReader::nextElement() {
+    if (m_error || m_first.isEmpty())
+        return false;
+    if (peek() == ']') {
+        m_cur++;
+        m_first.removeLast();
+        return false;
+    }
+    if (!m_first.last() && !consume(','))
+        return false;
+    m_first.last() = false;
+    return true;
+}
+
+int JsonStreamReader::readInt() {
+    char c = peek();
+    if (c != '-' && (c < '0' || c > '9')) {
+        skipValue();
+        return 0;
+    }
+    const char* start = m_cur;
+    if (!skipNumber())
+        return 0;
+    std::string_view token{start, static_cast<size_t>(m_cur - start)};
+    // same as QJsonValue::toInt, integers have to fit and doubles have to be integral and in range
+    if (token.find_first_of(".eE") == std::string_view::npos) {
+        qint64 value = 0;
+        auto res = std::from_chars(token.data(), token.data() + token.size(), value);
+        if (res.ec == std::errc{})
+            return qint64(int(value)) == value ? int(value) : 0;
+    }
+    bool ok = false;
+    double d = QByteArray::fromRawData(token.data(), static_cast<qsizetype>(token.size())).toDouble(&ok);
+    if (!ok || d < std::numeric_limits<int>::min() || d > std::numeric_limits<int>::max())
+        return 0;
+    int i = static_cast<int>(d);
+    return i == d ? i : 0;
+}
+
+bool JsonStreamReader::readBool() {
+    if (peek() == 't')
+        return skipLiteral("true");
+    skipValue();
+    return false;
+}
+
+QString JsonStreamReader::readString() {
+    if (peek() != '"') {
+        skipValue();
+        return QString{};
+    }
+    const char* start = m_cur + 1;
+    if (!skipString())
+        return QString{};
+    std::string_view raw{start, static_cast<size_t>(m_cur - start - 1)};
+    if (raw.find('\\') == std::string_view::npos)
+        return QString::fromUtf8(raw.data(), static_cast<qsizetype>(raw.size()));
+    m_cur = start - 1;
+    QByteArray decoded;
+    if (!decodeString(decoded))
+        return QString{};
+    return QString::fromUtf8(decoded);
+}
+
+std::string_view JsonStreamReader::readRaw() {
+    skipWhitespace();
+    const char* start = m_cur;
+    if (!skipValue())
+        return std::string_view{};
+    return std::string_view{start, static_cast<size_t>(m_cur - start)};
+}
+
+QJsonValue JsonStreamReader::readValue() {
+    auto raw = readRaw();
+    if (m_error)
+        return QJsonValue{};
+    QByteArray wrapped;
+    wrapped.reserve(static_cast<qsizetype>(raw.size()) + 2);
+    wrapped.append('[');
+    wrapped.append(raw.data(), static_cast<qsizetype>(raw.size()));
+    wrapped.append(']');
+    return QJsonDocument::fromJson(wrapped).array().at(0);
+}
+
+bool JsonStreamReader::atEnd() {
+    skipWhitespace();
+    return !m_error && m_first.isEmpty() && m_cur == m_end;
+}
+
+bool JsonStreamReader::error() const {
+    return m_error;
+}
+
+const QString& JsonStreamReader::errorString() const {
+    return m_errorString;
+}
+
+JsonStreamWriter::JsonStreamWriter(QByteArray& out) : m_out(out) {
+
+}
+
+void JsonStreamWriter::indent(qsizetype level) {
+    m_out.append(level * 4, ' ');
+}
+
+void JsonStreamWriter::separator() {
+    // a value right after a key goes on the same line, everything else starts a new indented line
+    if (m_afterKey) {
+        m_afterKey = false;
+        return;
+    }
+    if (m_count.isEmpty())
+        return;
+    if (m_count.last()++ > 0)
+        m_out.append(",\n", 2);
+    indent(m_count.size());
+}
+
+void JsonStreamWriter::beginObject() {
+    separator();
+    m_out.append("{\n", 2);
+    m_count.append(0);
+}
+
+void JsonStreamWriter::endObject() {
+    if (m_count.takeLast() > 0)
+        m_out.append('\n');
+    indent(m_count.size());
+    m_out.append('}');
+    if (m_count.isEmpty())
+        m_out.append('\n');
+}
+
+void JsonStreamWriter::beginArray() {
+    separator();
+    m_out.append("[\n", 2);
+    m_count.append(0);
+}
+
+void JsonStreamWriter::endArray() {
+    if (m_count.takeLast() > 0)
+        m_out.append('\n');
+    indent(m_count.size());
+    m_out.append(']');
+    if (m_count.isEmpty())
+        m_out.append('\n');
+}
+
+void JsonStreamWriter::key(std::string_view name) {
+    // schema keys are plain ascii, nothing to escape
+    separator();
+    m_out.append('"');
+    m_out.append(name.data(), static_cast<qsizetype>(name.size()));
+    m_out.append("\": ", 3);
+    m_afterKey = true;
+}
+
+void JsonStreamWriter::value(int v) {
+    separator();
+    m_out.append(QByteArray::number(v));
+}
+
+void JsonStreamWriter::value(bool v) {
+    separator();
+    m_out.append(v ? "true" : "false");
+}
+
+void JsonStreamWriter::value(const QString& v) {
+    separator();
+    m_out.append('"');
+    escaped(v);
+    m_out.append('"');
+}
+
+void JsonStreamWriter::value(std::string_view v) {
+    separator();
+    m_out.append('"');
+    m_out.append(v.data(), static_cast<qsizetype>(v.size()));
+    m_out.append('"');
+}
+
+void JsonStreamWriter::member(const QString& name, const QJsonValue& v) {
+    separator();
+    // let QJsonDocument format it as the only member of a top level object, then move it to our depth
+    QByteArray text = QJsonDocument{QJsonObject{{name, v}}}.toJson(QJsonDocument::Indented);
+    // strip "{\n    " and "\n}\n"
+    text = text.mid(6, text.size() - 6 - 3);
+    if (m_count.size() > 1)
+        text.replace("\n", QByteArray{"\n"} + QByteArray((m_count.size() - 1) * 4, ' '));
+    m_out.append(text);
+}
+
+void JsonStreamWriter::escaped(const QString& str) {
+    // same rules as QJsonDocument: short escapes where json has them, \u00xx for other control characters,
+    // everything else as utf8 and lone surrogates as \uxxxx
+    static constexpr char hexdig[] = "0123456789abcdef";
+    const QChar* it = str.constData();
+    const QChar* end = it + str.size();
+    while (it != end) {
+        char16_t u = it->unicode();
+        if (u < 0x80) {
+            if (u < 0x20 || u == 0x22 || u == 0x5c) {
+                m_out.append('\\');
+                switch (u) {
+                case 0x22: m_out.append('"'); break;
+                case 0x5c: m_out.append('\\'); break;
+                case 0x08: m_out.append('b'); break;
+                case 0x0c: m_out.append('f'); break;
+                case 0x0a: m_out.append('n'); break;
+                case 0x0d: m_out.append('r'); break;
+                case 0x09: m_out.append('t'); break;
+                default:
+                    m_out.append("u00", 3);
+                    m_out.append(hexdig[u >> 4]);
+                    m_out.append(hexdig[u & 0xf]);
+                }
+            } else {
+                m_out.append(static_cast<char>(u));
+            }
+            it++;
+        } else if (QChar::isHighSurrogate(u) && it + 1 != end && (it + 1)->isLowSurrogate()) {
+            m_out.append(QStringView{it, 2}.toUtf8());
+            it += 2;
+        } else if (QChar::isSurrogate(u)) {
+            m_out.append("\\u", 2);
+            m_out.append(hexdig[u >> 12]);
+            m_out.append(hexdig[(u >> 8) & 0xf]);
+            m_out.append(hexdig[(u >> 4) & 0xf]);
+            m_out.append(hexdig[u & 0xf]);
+            it++;
+        } else {
+            m_out.append(QStringView{it, 1}.toUtf8());
+            it++;
+        }
+    }
+}
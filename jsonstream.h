@@ -0,0 +1,84 @@
+#ifndef JSONSTREAM_H
+#define JSONSTREAM_H
+
+#include <QByteArray>
+#include <QString>
+#include <QJsonValue>
+#include <QVector>
+#include <string_view>
+
+// Pull parser over a JSON document held in memory, values are decoded straight into the caller's
+// types without building a QJsonObject tree.
+// Conversions follow QJsonValue (toInt, toBool, toString), a value of the wrong type reads as the default.
+// Once an error is hit every call returns its default and error() stays set.
+class JsonStreamReader {
+public:
+    explicit JsonStreamReader(const QByteArray& data);
+    // consumes '{' or '[', returns false (and skips the value) if the next value is something else
+    bool enterObject();
+    bool enterArray();
+    // steps to the next member of the current object, false when the object is closed
+    bool nextMember(std::string_view& key);
+    // steps to the next element of the current array, false when the array is closed
+    bool nextElement();
+    int readInt();
+    bool readBool();
+    QString readString();
+    // skips the next value and returns its source text
+    std::string_view readRaw();
+    // the next value as a QJsonValue, only meant for small values the schema doesn't know about
+    QJsonValue readValue();
+    // true if the whole input was consumed without errors
+    bool atEnd();
+    bool error() const;
+    const QString& errorString() const;
+private:
+    // same limit as QJsonDocument
+    static constexpr qsizetype MaxDepth = 1024;
+    const char* m_begin;
+    const char* m_cur;
+    const char* m_end;
+    bool m_error = false;
+    QString m_errorString;
+    QByteArray m_keyBuffer;
+    QVector<bool> m_first;
+    void fail(const char* what);
+    void skipWhitespace();
+    char peek();
+    bool consume(char c);
+    bool skipString();
+    bool skipNumber();
+    bool skipLiteral(std::string_view literal);
+    bool skipValue();
+    bool decodeString(QByteArray& utf8);
+};
+
+// Writes JSON in the exact layout of QJsonDocument::toJson(QJsonDocument::Indented).
+// QJsonObject sorts its keys, so object members have to be written in sorted order to match it.
+class JsonStreamWriter {
+public:
+    explicit JsonStreamWriter(QByteArray& out);
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+    void key(std::string_view name);
+    void value(int v);
+    void value(bool v);
+    void value(const QString& v);
+    void value(std::string_view v);
+    // a string literal would silently pick the bool overload
+    void value(const char* v) = delete;
+    // writes a whole member, used for values the writer has no fast path for
+    void member(const QString& name, const QJsonValue& v);
+private:
+    QByteArray& m_out;
+    // members written so far in every open object or array
+    QVector<int> m_count;
+    bool m_afterKey = false;
+    void separator();
+    void indent(qsizetype level);
+    void escaped(const QString& str);
+};
+
+#endif // JSONSTREAM_H
@@ -1,10 +1,49 @@
 #include "cfgeditor.h"
+#include "messageboxreporter.h"
+#include "batchconverter.h"
+#include "spritelinter.h"
+#include "previewrenderer.h"
+#include "corpusgenerator.h"
+#include "interactionreplayer.h"
+#include "tracing.h"
 
 #include <QApplication>
+#include <QCoreApplication>
+#include <QLoggingCategory>
 
 int main(int argc, char *argv[])
 {
+    // before anything else parses the arguments, --trace isn't a sprite to open
+    Tracing::configure(argc, argv);
+    // headless tools never create a QApplication, so they run without a display
+    if (BatchConverter::requested(argc, argv)) {
+        QCoreApplication a(argc, argv);
+        return BatchConverter::run(a.arguments());
+    }
+    if (SpriteLinter::requested(argc, argv)) {
+        QCoreApplication a(argc, argv);
+        return SpriteLinter::run(a.arguments());
+    }
+    if (PreviewRenderer::requested(argc, argv)) {
+        QCoreApplication a(argc, argv);
+        return PreviewRenderer::run(a.arguments());
+    }
+    if (CorpusGenerator::requested(argc, argv)) {
+        QCoreApplication a(argc, argv);
+        return CorpusGenerator::run(a.arguments());
+    }
+    if (InteractionReplayer::requested(argc, argv)) {
+        // replays drive the real widgets, drawn offscreen unless a platform was asked for
+        if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+        QApplication a(argc, argv);
+        // the interactive paths are full of qDebug, the latencies would mostly measure the message handler
+        QLoggingCategory::setFilterRules("*.debug=false");
+        return InteractionReplayer::run(a.arguments());
+    }
     QApplication a(argc, argv);
+    MessageBoxReporter reporter;
+    ErrorReporter::install(&reporter);
     QStringList list;
     // skip the path of the executable
     for (auto i = 1; i < argc; ++i)
@@ -0,0 +1,86 @@
+#include "map16format.h"
+#include <QFile>
+#include <QtEndian>
+
+namespace {
+// like reading through a QDataStream, words past the end of data read as 0
+void readTiles(QVector<Map16Tile>& tiles, const QByteArray& data, qsizetype offset, qsizetype count) {
+    tiles.reserve(tiles.size() + count);
+    auto word = [&](qsizetype at) -> quint16 {
+        return at >= 0 && at + 2 <= data.size() ? qFromLittleEndian<quint16>(data.constData() + at) : 0;
+    };
+    for (qsizetype i = 0; i < count; i++, offset += 8)
+        tiles.append({word(offset), word(offset + 2), word(offset + 4), word(offset + 6)});
+}
+}
+
+bool Map16Format::readFile(const QString& name, Table& table, QString& error) {
+    QFile file{name};
+    if (!file.open(QFile::OpenModeFlag::ReadOnly)) {
+        error = file.errorString();
+        return false;
+    }
+    return parse(file.readAll(), name.endsWith(".map16"), table, error);
+}
+
+bool Map16Format::parse(const QByteArray& data, bool lunarMagicHeader, Table& table, QString& error) {
+    table.tiles.clear();
+    if (!lunarMagicHeader) {
+        table.width = 16;
+        readTiles(table.tiles, data, 0, InternalTiles);
+        return true;
+    }
+    // 16 bytes of metadata, then the offset and size of the table of contents and the size in tiles
+    auto dword = [&](qsizetype at) { return qFromLittleEndian<quint32>(data.constData() + at); };
+    if (data.size() < 0x40) {
+        error = "the file is too short for a map16 header";
+        return false;
+    }
+    qsizetype tableOffset = dword(16);
+    quint32 sizeX = dword(24);
+    quint32 sizeY = dword(28);
+    if (tableOffset + 8 > data.size()) {
+        error = "the table of contents is past the end of the file";
+        return false;
+    }
+    // the first entry of the table of contents is the tile data
+    qsizetype dataOffset = dword(tableOffset);
+    qsizetype dataSize = dword(tableOffset + 4);
+    if (sizeX == 0 || dataSize != static_cast<qsizetype>(sizeX) * sizeY * 8 || dataOffset + dataSize > data.size()) {
+        error = QString::asprintf("the tile data doesn't match the %ux%u tiles in the header", sizeX, sizeY);
+        return false;
+    }
+    table.width = static_cast<int>(sizeX);
+    readTiles(table.tiles, data, dataOffset, static_cast<qsizetype>(sizeX) * sizeY);
+    return true;
+}
+
+void Map16Format::appendTiles(QVector<Map16Tile>& tiles, const QByteArray& data) {
+    // a trailing partial tile is padded with zeros, the way the editor has always read it
+    readTiles(tiles, data, 0, (data.size() + 7) / 8);
+}
+
+bool Map16Format::decodeBase64(const QString& base64, QVector<Map16Tile>& tiles, QString& error) {
+    const QByteArray latin1 = base64.toLatin1();
+    auto decoded = QByteArray::fromBase64Encoding(latin1, QByteArray::AbortOnBase64DecodingErrors);
+    if (!decoded) {
+        // the characters that aren't base64 are skipped, same as the editor always did
+        appendTiles(tiles, QByteArray::fromBase64(latin1));
+        error = "Map16 is not valid base64, the characters that aren't were skipped";
+        return false;
+    }
+    appendTiles(tiles, *decoded);
+    if (decoded->size() % 8 != 0) {
+        error = QString::asprintf("Map16: %lld bytes are not a whole number of tiles, the last one was padded with zeros",
+                                  static_cast<long long>(decoded->size()));
+        return false;
+    }
+    return true;
+}
+
+QString Map16Format::encodeBase64(const QVector<Map16Tile>& tiles) {
+    QByteArray data{static_cast<qsizetype>(tiles.size() * sizeof(Map16Tile)), Qt::Uninitialized};
+    // the words are already in file order, on little endian hosts this is a plain copy
+    qToLittleEndian<quint16>(tiles.constData(), tiles.size() * 4, data.data());
+    return QString::fromLatin1(data.toBase64());
+}
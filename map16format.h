@@ -0,0 +1,34 @@
+#ifndef MAP16FORMAT_H
+#define MAP16FORMAT_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <array>
+
+// one 16x16 tile as stored in .map16/.m16 files and in the "Map16" field of sprites:
+// 4 little endian words in the order top left, bottom left, top right, bottom right
+using Map16Tile = std::array<quint16, 4>;
+
+// Reading and writing of map16 tile data, without anything to draw it with.
+class Map16Format
+{
+public:
+    struct Table {
+        // tiles per row
+        int width = 16;
+        QVector<Map16Tile> tiles;
+    };
+    // tiles the editor always has, three pages of 16x16
+    static constexpr int InternalTiles = 16 * 16 * 3;
+    // .map16 files start with a Lunar Magic header, anything else is raw tile data read as InternalTiles tiles
+    static bool readFile(const QString& name, Table& table, QString& error);
+    static bool parse(const QByteArray& data, bool lunarMagicHeader, Table& table, QString& error);
+    // appends the tiles of raw tile data
+    static void appendTiles(QVector<Map16Tile>& tiles, const QByteArray& data);
+    // the "Map16" field of a sprite, tiles gets everything that could be read even when it returns false
+    static bool decodeBase64(const QString& base64, QVector<Map16Tile>& tiles, QString& error);
+    static QString encodeBase64(const QVector<Map16Tile>& tiles);
+};
+
+#endif // MAP16FORMAT_H
@@ -1,10 +1,66 @@
 #include "map16graphicsview.h"
+#include "alphablend.h"
+#include "errorreporter.h"
+#include "map16format.h"
+#include "tracing.h"
+#include <utility>
+
+Map16SheetItem::Map16SheetItem(Map16GraphicsView* view) : m_view(view) {
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+}
+
+QRectF Map16SheetItem::boundingRect() const {
+    return QRectF{m_view->TileMap.rect()};
+}
+
+void Map16SheetItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) {
+    const QRect exposed = option->exposedRect.toAlignedRect() & m_view->TileMap.rect();
+    if (exposed.isEmpty())
+        return;
+    painter->drawImage(exposed, m_view->TileMap, exposed);
+    if (m_view->useGrid)
+        painter->drawImage(exposed, m_view->Grid, exposed);
+    if (m_view->usePageSep)
+        painter->drawImage(exposed, m_view->PageSep, exposed);
+    if (!m_selection.isNull()) {
+        QPen pen{Qt::white, 1, Qt::DotLine, Qt::SquareCap, Qt::RoundJoin};
+        painter->setPen(pen);
+        painter->drawRect(m_selection);
+    }
+    if (!m_highlight.isNull()) {
+        // same result as halving the alpha of the hovered cell and letting the view background show through
+        painter->setOpacity(0.5);
+        painter->fillRect(m_highlight, widget ? widget->palette().base() : QBrush(Qt::white));
+    }
+}
+
+void Map16SheetItem::sheetChanged() {
+    prepareGeometryChange();
+    update();
+}
+
+void Map16SheetItem::setHighlight(const QRect& rect) {
+    if (rect == m_highlight)
+        return;
+    update(m_highlight);
+    m_highlight = rect;
+    update(m_highlight);
+}
+
+void Map16SheetItem::setSelection(const QRect& rect) {
+    // the 1px outline is drawn on the right and bottom edge of the rect too
+    update(m_selection.adjusted(0, 0, 1, 1));
+    m_selection = rect;
+    update(m_selection.adjusted(0, 0, 1, 1));
+}
 
 
 Map16GraphicsView::Map16GraphicsView(QWidget* parent) : QGraphicsView(parent)
 {
     mapName = ":/Resources/spriteMapData.map16";
     currScene = new QGraphicsScene(this);
+    currentMap16 = new Map16SheetItem(this);
+    currScene->addItem(currentMap16);
     setMouseTracking(true);
     verticalScrollBar()->setFixedWidth(16);
     setScene(currScene);
@@ -29,56 +85,24 @@ void Map16GraphicsView::setControllingLabel(QLabel *tileNoLabel) {
 }
 
 bool Map16GraphicsView::readInternalMap16File() {
-    struct {
-        quint32 offset;
-        quint32 size;
-    } map16DataIndex;
-    struct {
-        quint32 tableOffset;
-        quint32 tableSize;
-        quint32 sizeX;
-        quint32 sizeY;
-    } tableInformation;
-    QFile file{mapName};
-    TRY_OPEN(file.open(QFile::OpenModeFlag::ReadOnly));
-    QDataStream byteStream{file.readAll()};
-    byteStream.setByteOrder(QDataStream::LittleEndian);
-    if (mapName.endsWith(".map16")) {
-        byteStream.skipRawData(16);     // skip metadata
-        byteStream >> tableInformation.tableOffset;
-        byteStream >> tableInformation.tableSize;
-        byteStream >> tableInformation.sizeX;
-        byteStream >> tableInformation.sizeY;
-        tiles.reserve(tableInformation.sizeY);
-        qDebug() << "length before: " << tiles.length();
-        qDebug() << "Table offset = " << tableInformation.tableOffset << " Table size: " << tableInformation.tableSize;
-        qDebug() << "Size X = " << tableInformation.sizeX << " Size Y = " << tableInformation.sizeY;
-        byteStream.skipRawData(12 + 0x14);     // skip base coords, and "various flags" and 0x14 unused bytes
-        // should have read 0x40 bytes at this point
-        byteStream.skipRawData(tableInformation.tableOffset - 0x40);       // skip directly to the data, we don't care about the comment field
-        byteStream >> map16DataIndex.offset;
-        byteStream >> map16DataIndex.size;
-        qDebug() << "Map16 Data offset = " << map16DataIndex.offset << " Map16 Data size: " << map16DataIndex.size;
-        byteStream.skipRawData(tableInformation.tableSize - 8);
-    } else {
-        tableInformation.sizeY = 16 * 3;
-        tableInformation.sizeX = 16;
-        map16DataIndex.size = 16 * 16 * 3 * 4 * 2;
-        tiles.reserve(tableInformation.sizeY);
+    TRACE_SCOPE("Map16GraphicsView::readInternalMap16File");
+    Map16Format::Table table;
+    QString error;
+    if (!Map16Format::readFile(mapName, table, error)) {
+        qDebug() << "Could not read " << mapName << ": " << error;
+        return false;
     }
-    // we're at the data now, hopefully
-    Q_ASSERT(map16DataIndex.size == (tableInformation.sizeX * tableInformation.sizeY * 4 * 2));
-    for (quint32 i = 0; i < tableInformation.sizeY; i++) {
+    const int sizeX = table.width;
+    const int sizeY = static_cast<int>(table.tiles.size() / sizeX);
+    qDebug() << "Size X = " << sizeX << " Size Y = " << sizeY;
+    tiles.reserve(sizeY);
+    for (int i = 0; i < sizeY; i++) {
         QVector<FullTile> subVector{};
-        subVector.reserve(tableInformation.sizeX);
-        for (quint32 j = 0; j < tableInformation.sizeX; j++) {
-            quint16 tl, bl, tr, br;
-            byteStream >> tl;
-            byteStream >> bl;
-            byteStream >> tr;
-            byteStream >> br;
-            int tileIndex = i * tableInformation.sizeX + j;
-            subVector.append({tl, bl, tr, br, false});
+        subVector.reserve(sizeX);
+        for (int j = 0; j < sizeX; j++) {
+            int tileIndex = i * sizeX + j;
+            const auto& t = table.tiles[tileIndex];
+            subVector.append({t[0], t[1], t[2], t[3], false});
             subVector.last().offset = getExternalOffset(tileIndex);
         }
         if (tiles.length() <= i)
@@ -89,18 +113,19 @@ bool Map16GraphicsView::readInternalMap16File() {
     qDebug() << "length: " << tiles.length();
     if (tiles.length() < 16 * 4) {
         qDebug() << "Adding tiles of padding...";
-        for (quint32 i = 0; i < tableInformation.sizeX; i++) {
+        for (int i = 0; i < sizeX; i++) {
             QVector<FullTile> subVector{};
             subVector.reserve(16);
-            for (quint32 j = 0; j < 16; j++) {
+            for (int j = 0; j < 16; j++) {
                 subVector.append({0x00, 0x00, 0x00, 0x00, false});
             }
             tiles.append(subVector);
         }
     }
     qDebug() << "length at end: " << tiles.length();
-    imageWidth = (int)tableInformation.sizeX * 16;
-    imageHeight = ((int)tableInformation.sizeY + (tableInformation.sizeY == 16 * 4 ? 0 : 16)) * 16;
+    findLastUsedTile(tiles.length() * 16 - 1);
+    imageWidth = sizeX * 16;
+    imageHeight = (sizeY + (sizeY == 16 * 4 ? 0 : 16)) * 16;
     // we don't really care about the rest of the file, now we can draw
     drawInternalMap16File();
     return true;
@@ -118,26 +143,27 @@ int Map16GraphicsView::getExternalOffset(int tileIndex) {
 void Map16GraphicsView::readExternalMap16File(const QString &name) {
     mapName = name;
     readInternalMap16File();
+    emit map16Edited();
+}
+
+const QImage& Map16GraphicsView::sheetImage() const {
+    return TileMap;
+}
+
+qsizetype Map16GraphicsView::imageBytes() const {
+    return TileMap.sizeInBytes() + Grid.sizeInBytes() + PageSep.sizeInBytes();
 }
 
 void Map16GraphicsView::drawInternalMap16File() {
-    TileMap = QImage{imageWidth, imageHeight, QImage::Format::Format_ARGB32};
-    QPainter p{&TileMap};
-    p.setCompositionMode(QPainter::CompositionMode_SourceOver);
-    p.fillRect(TileMap.rect(), QBrush(QGradient(QGradient::EternalConstance)));
-    for (int i = 0; i < tiles.length(); i++) {
-        for (int j = 0; j < tiles[i].length(); j++) {
-            p.drawImage(QRect{j * 16, i * 16, 16, 16}, tiles[i][j].getFullTile(false));
-        }
-    }
-    p.end();
-    int scaleFactor = qMax(1, (352 + imageWidth - 1) / imageWidth);
-    qDebug() << "Image width " << imageWidth << " scale factor: " << scaleFactor;
-    TileMap = TileMap.scaledToWidth(imageWidth * scaleFactor, Qt::FastTransformation);
-    imageWidth = TileMap.width();
-    imageHeight = TileMap.height();
+    TRACE_SCOPE("Map16GraphicsView::drawInternalMap16File");
+    // imageWidth and imageHeight are the size of the tiles up to here, from here on they're the scaled one
+    m_unscaledSize = QSize{imageWidth, imageHeight};
+    m_sheetScale = qMax(1, (352 + imageWidth - 1) / imageWidth);
+    qDebug() << "Image width " << imageWidth << " scale factor: " << m_sheetScale;
+    imageWidth *= m_sheetScale;
+    imageHeight *= m_sheetScale;
     // and now we draw the grid and the page separator
-    Grid = QImage{imageWidth, imageHeight, QImage::Format::Format_ARGB32};
+    Grid = QImage{imageWidth, imageHeight, SnesGFXConverter::TileFormat};
     Grid.fill(qRgba(0, 0, 0, 0));
     QPainter gridPainter{&Grid};
     QPen pen(Qt::white, 1, Qt::SolidLine, Qt::SquareCap, Qt::RoundJoin);
@@ -148,7 +174,7 @@ void Map16GraphicsView::drawInternalMap16File() {
     }
     gridPainter.end();
 
-    PageSep = QImage{imageWidth, imageHeight, QImage::Format::Format_ARGB32};
+    PageSep = QImage{imageWidth, imageHeight, SnesGFXConverter::TileFormat};
     PageSep.fill(qRgba(0, 0, 0, 0));
     QPainter pageSepPainter{&PageSep};
     QPen penSep(Qt::blue, 2, Qt::SolidLine, Qt::SquareCap, Qt::RoundJoin);
@@ -158,90 +184,100 @@ void Map16GraphicsView::drawInternalMap16File() {
         qDebug() << imageHeight << " " << i;
         pageSepPainter.drawRect(QRect{0, i, imageWidth, CellSize() * 16});
     }
-    currentMap16 = scene()->addPixmap(QPixmap::fromImage(TileMap));
-    setMinimumWidth(currentMap16->pixmap().width() + 18);
-    setFixedHeight(currentMap16->pixmap().height() / 4);
+    pageSepPainter.end();
+    renderSheet();
+    drawCurrentSelectedTile();
+    setMinimumWidth(imageWidth + 18);
+    setFixedHeight(imageHeight / 4);
     setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    currentWithNoHighlight = currentMap16->pixmap();
-    currentWithNoSelection = currentMap16->pixmap();
-    if (usePageSep) {
-        usePageSep = false;
-        addPageSep();
+}
+
+void Map16GraphicsView::setBackgroundRendering(bool enabled) {
+    if (enabled == (m_renderWorker != nullptr))
+        return;
+    if (!enabled) {
+        const bool pending = m_renderPending;
+        m_renderWorker.reset();
+        // what was being drawn is lost with the worker
+        if (pending)
+            renderSheet();
+        return;
     }
-    if (useGrid) {
-        useGrid = false;
-        addGrid();
+    m_renderWorker = std::make_unique<Map16RenderWorker>();
+    QObject::connect(m_renderWorker.get(), &Map16RenderWorker::finished, this, [this](quint64 generation, const QImage& sheet) {
+        // superseded while it was on its way
+        if (m_renderWorker && generation == m_renderWorker->generation())
+            swapSheet(sheet);
+    });
+}
+
+void Map16GraphicsView::renderSheet() {
+    Map16RenderWorker::Request request{tiles, m_unscaledSize, m_sheetScale, Map16RenderWorker::Context::capture()};
+    if (!m_renderWorker) {
+        swapSheet(Map16RenderWorker::render(request));
+        return;
     }
+    m_editedWhileRendering.clear();
+    m_renderPending = true;
+    m_renderWorker->submit(std::move(request));
+}
+
+void Map16GraphicsView::swapSheet(const QImage& sheet) {
+    m_renderPending = false;
+    TileMap = sheet;
+    // edits made after the request was taken, they were drawn on the previous sheet
+    const int size = imageWidth / 16;
+    for (int index : std::exchange(m_editedWhileRendering, {}))
+        paintCell(QRect{(index % 16) * size, (index / 16) * size, size, size}, tileAt(index).getFullTile(false));
+    m_memory.update(imageBytes());
+    currentMap16->sheetChanged();
 }
 
-void Map16GraphicsView::drawCurrentSelectedTile(QPixmap& map) {
-    if (currentClickedTile == -1)
+void Map16GraphicsView::drawCurrentSelectedTile() {
+    if (currentClickedTile == -1) {
+        currentMap16->setSelection(QRect{});
         return;
-    QPainter p{&map};
-    QPen pen{Qt::white, 1, Qt::DotLine, Qt::SquareCap, Qt::RoundJoin};
-    p.setPen(pen);
-    p.drawRect(QRect{currentTopLeftClicked.x(), currentTopLeftClicked.y(), CellSize(), CellSize()});
-    p.end();
+    }
+    currentMap16->setSelection(QRect{currentTopLeftClicked.x(), currentTopLeftClicked.y(), CellSize(), CellSize()});
+}
+
+void Map16GraphicsView::paintCell(const QRect& rect, const QImage& img) {
+    // nothing to draw on until the first sheet is in, the cell is drawn when it is
+    if (TileMap.isNull())
+        return;
+    QPainter og{&TileMap};
+    og.setCompositionMode(QPainter::CompositionMode_Source);
+    og.drawImage(rect, img);
+    og.end();
+    currentMap16->update(rect);
 }
 
 void Map16GraphicsView::addGrid() {
     if (useGrid)
         return;
     useGrid = true;
-    QPixmap pixmap = currentWithNoSelection;
-    QPainter paintGrid{&pixmap};
-    paintGrid.drawImage(QRect{0, 0, imageWidth, imageHeight}, Grid);
-    paintGrid.end();
-    currentWithNoSelection = pixmap;
-    drawCurrentSelectedTile(pixmap);
-    currentWithNoHighlight = pixmap;
-    currentMap16->setPixmap(pixmap);
+    currentMap16->update();
 }
 
 void Map16GraphicsView::removeGrid() {
     if (!useGrid)
         return;
     useGrid = false;
-    QPixmap pixmap = QPixmap::fromImage(TileMap);
-    if (usePageSep) {
-        QPainter paint{&pixmap};
-        // if the page separator is being used, we have to draw it
-        paint.drawImage(QRect{0, 0, imageWidth, imageHeight}, PageSep);
-    }
-    currentWithNoSelection = pixmap;
-    drawCurrentSelectedTile(pixmap);
-    currentWithNoHighlight = pixmap;
-    currentMap16->setPixmap(pixmap);
+    currentMap16->update();
 }
 
 void Map16GraphicsView::addPageSep() {
     if (usePageSep)
         return;
     usePageSep = true;
-    QPixmap pixmap = currentWithNoSelection;
-    QPainter paintPageSep{&pixmap};
-    paintPageSep.drawImage(QRect{0, 0, imageWidth, imageHeight}, PageSep);
-    paintPageSep.end();
-    currentWithNoSelection = pixmap;
-    drawCurrentSelectedTile(pixmap);
-    currentWithNoHighlight = pixmap;
-    currentMap16->setPixmap(pixmap);
+    currentMap16->update();
 }
 
 void Map16GraphicsView::removePageSep() {
     if (!usePageSep)
         return;
     usePageSep = false;
-    QPixmap pixmap = QPixmap::fromImage(TileMap);
-    if (useGrid) {
-        QPainter paint{&pixmap};
-        // if the grid is being used, we have to draw it
-        paint.drawImage(QRect{0, 0, imageWidth, imageHeight}, Grid);
-    }
-    currentWithNoSelection = pixmap;
-    drawCurrentSelectedTile(pixmap);
-    currentWithNoHighlight = pixmap;
-    currentMap16->setPixmap(pixmap);
+    currentMap16->update();
 }
 int Map16GraphicsView::mouseCoordinatesToTile(QPoint position) {
     int diff = CellSize();
@@ -259,20 +295,48 @@ QPoint Map16GraphicsView::translateToRect(QPoint position) {
                 );
 }
 
+int Map16GraphicsView::realTileIndex(int tilenum) {
+    if (currType == SelectorType::Sixteen)
+        return tilenum;
+    int r = (tilenum / 32) / 2;
+    int c = (tilenum % 32) / 2;
+    return r * 16 + c;
+}
+
 FullTile& Map16GraphicsView::tileNumToTile(int tilenum) {
-    int realClickedTile;
-    if (currType == SelectorType::Sixteen) {
-        realClickedTile = tilenum;
-    } else {
-        int r = (tilenum / 32) / 2;
-        int c = (tilenum % 32) / 2;
-        realClickedTile = r * 16 + c;
-    }
+    int realClickedTile = realTileIndex(tilenum);
     int row = realClickedTile / (int)tiles[0].length();
     int col = realClickedTile % (int)tiles[0].length();
     return tiles[row][col];
 }
 
+FullTile& Map16GraphicsView::tileAt(int index) {
+    return tiles[index / 16][index % 16];
+}
+
+void Map16GraphicsView::userTileChanged(int index) {
+    if (index < Map16Format::InternalTiles)
+        return;
+    if (m_renderPending)
+        m_editedWhileRendering.append(index);
+    m_map16Cache.reset();
+    if (!tileAt(index).isEmpty())
+        m_lastUsedTile = std::max(m_lastUsedTile, index);
+    else if (index == m_lastUsedTile)
+        findLastUsedTile(index - 1);
+}
+
+void Map16GraphicsView::findLastUsedTile(int from) {
+    m_map16Cache.reset();
+    m_lastUsedTile = -1;
+    for (int i = std::min(from, static_cast<int>(tiles.length()) * 16 - 1); i >= Map16Format::InternalTiles; i--) {
+        if (!tileAt(i).isEmpty()) {
+            m_lastUsedTile = i;
+            return;
+        }
+    }
+}
+
 void Map16GraphicsView::mouseMoveEvent(QMouseEvent *event) {
     auto p = event->position().toPoint();
     {
@@ -289,12 +353,7 @@ void Map16GraphicsView::mouseMoveEvent(QMouseEvent *event) {
     QString tileText = QString::asprintf("Tile: 0x%03X", currentTile);
     tileNumLabel->setText(tileText);
     // highlight the tile in some way
-    auto map = currentWithNoHighlight;
-    QPainter paint{&map};
-    paint.setCompositionMode(QPainter::CompositionMode_DestinationIn);
-    paint.fillRect(QRect{origin.x(), origin.y(), CellSize(), CellSize()}, QBrush(QColor(0,0,0,128)));
-    paint.end();
-    currentMap16->setPixmap(map);
+    currentMap16->setHighlight(QRect{origin.x(), origin.y(), CellSize(), CellSize()});
     event->accept();
 }
 
@@ -329,12 +388,6 @@ void Map16GraphicsView::mousePressEvent(QMouseEvent *event) {
             newTile.setTileInfoByType(tile.getTileInfoByType(currentClickedType), currentType);
         }
 
-        QPainter og{&TileMap};
-        QPainter high{&currentWithNoHighlight};
-        QPainter sel{&currentWithNoSelection};
-        og.setCompositionMode(QPainter::CompositionMode_Source);
-        high.setCompositionMode(QPainter::CompositionMode_Source);
-        sel.setCompositionMode(QPainter::CompositionMode_Source);
         auto size = CellSize();
         QImage img;
         if (currentType == TileChangeType::All)
@@ -343,15 +396,10 @@ void Map16GraphicsView::mousePressEvent(QMouseEvent *event) {
             img = newTile.getPartialTile(currentType);
         }
         auto n_per_row = currentType == TileChangeType::All ? 16 : 32;
-        high.drawImage(QRect{(currentTile % n_per_row) * size, (currentTile / n_per_row) * size, size, size}, img);
-        sel.drawImage(QRect{(currentTile % n_per_row) * size, (currentTile / n_per_row) * size, size, size}, img);
-        og.drawImage(QRect{(currentTile % n_per_row) * size, (currentTile / n_per_row) * size, size, size}, img);
-        sel.end();
-        high.end();
-        og.end();
-        drawCurrentSelectedTile(currentWithNoHighlight);
-        currentMap16->setPixmap(currentWithNoHighlight);
+        paintCell(QRect{(currentTile % n_per_row) * size, (currentTile / n_per_row) * size, size, size}, img);
+        userTileChanged(realTileIndex(currentTile));
         emit signalTileUpdatedForDisplay(newTile, currentTile);
+        emit map16Edited();
     }
     grabKeyboard();
     if (currentTile == -1)
@@ -361,10 +409,7 @@ void Map16GraphicsView::mousePressEvent(QMouseEvent *event) {
     copyTileToClipboard(tileNumToTile(currentClickedTile));
     copiedTile->setTileNum(mouseCoordinatesToTile(event->position().toPoint()));
     clickCallback(tileNumToTile(currentClickedTile), currentTile, currType);
-    QPixmap selected = currentWithNoSelection;
-    drawCurrentSelectedTile(selected);
-    currentMap16->setPixmap(selected);
-    currentWithNoHighlight = selected;
+    drawCurrentSelectedTile();
     event->accept();
 }
 
@@ -381,28 +426,18 @@ void Map16GraphicsView::keyPressEvent(QKeyEvent *event) {
             for (int j = 0; j < tiles[i].length(); j++)
                 tiles[i][j] = FullTile{0, 0, 0, 0, false};
         readInternalMap16File();
+        emit map16Edited();
     } else if (event->key() == Qt::Key::Key_Delete || event->key() == Qt::Key::Key_Backspace) {
         qDebug() << "Delete or backspace pressed";
         if (currentClickedTile == -1 || (currType == SelectorType::Sixteen && currentTile < 0x300) || (currType == SelectorType::Eight && currentTile < 0xC00))
             return;
-        QPainter og{&TileMap};
-        QPainter high{&currentWithNoHighlight};
-        QPainter sel{&currentWithNoSelection};
-        og.setCompositionMode(QPainter::CompositionMode_Source);
-        high.setCompositionMode(QPainter::CompositionMode_Source);
-        sel.setCompositionMode(QPainter::CompositionMode_Source);
         auto size = CellSize();
         auto& tile = tileNumToTile(currentClickedTile);
         tile = FullTile{0, 0, 0, 0, false};
         auto img = tile.getFullTile(tile.translucent);
-        high.drawImage(QRect{(currentTile % 16) * size, (currentTile / 16) * size, size, size}, img);
-        sel.drawImage(QRect{(currentTile % 16) * size, (currentTile / 16) * size, size, size}, img);
-        og.drawImage(QRect{(currentTile % 16) * size, (currentTile / 16) * size, size, size}, img);
-        sel.end();
-        high.end();
-        og.end();
-        drawCurrentSelectedTile(currentWithNoHighlight);
-        currentMap16->setPixmap(currentWithNoHighlight);
+        paintCell(QRect{(currentTile % 16) * size, (currentTile / 16) * size, size, size}, img);
+        userTileChanged(realTileIndex(currentClickedTile));
+        emit map16Edited();
     }
     event->accept();
     releaseKeyboard();
@@ -540,37 +575,22 @@ void Map16GraphicsView::tileChanged(QObject* toBlock, TileChangeAction action, T
             Q_ASSERT(false);
         }
     }
+    userTileChanged(realTileIndex(currentClickedTile));
 
-    QPainter og{&TileMap};
-    QPainter high{&currentWithNoHighlight};
-    QPainter sel{&currentWithNoSelection};
-    og.setCompositionMode(QPainter::CompositionMode_Source);
-    high.setCompositionMode(QPainter::CompositionMode_Source);
-    sel.setCompositionMode(QPainter::CompositionMode_Source);
     auto size = CellSize();
     if (currType == SelectorType::Sixteen || partial == nullptr) {
         auto img = tile.getFullTile(false);
-        QRect rect{(currentClickedTile % 16) * size, (currentClickedTile / 16) * size, size, size};
-        high.drawImage(rect, img);
-        sel.drawImage(rect, img);
-        og.drawImage(rect, img);
+        paintCell(QRect{(currentClickedTile % 16) * size, (currentClickedTile / 16) * size, size, size}, img);
     }
     else {
         auto img = partial->get8x8Tile(tile.offset);
-        QRect rect{(currentClickedTile % 32) * size, (currentClickedTile / 32) * size, size, size};
-        high.drawImage(rect, img);
-        sel.drawImage(rect, img);
-        og.drawImage(rect, img);
+        paintCell(QRect{(currentClickedTile % 32) * size, (currentClickedTile / 32) * size, size, size}, img);
     }
-    sel.end();
-    high.end();
-    og.end();
-    drawCurrentSelectedTile(currentWithNoHighlight);
-    currentMap16->setPixmap(currentWithNoHighlight);
     if (copiedTile->TileNum() == currentClickedTile) {
         copiedTile->update(tile);
     }
     emit signalTileUpdatedForDisplay(tile, currentClickedTile);
+    emit map16Edited();
 }
 
 void Map16GraphicsView::setCopiedTile(ClipboardTile& tile) {
@@ -590,68 +610,49 @@ void Map16GraphicsView::switchCurrSelectionType() {
 }
 
 void Map16GraphicsView::setMap16(const QString& data) {
-    QByteArray arr = QByteArray::fromBase64(data.toUtf8());
-    QDataStream str{&arr, QIODevice::ReadOnly};
-    str.setByteOrder(QDataStream::LittleEndian);
-    int i = (16 * 3);
-    int j = 0;
-    QPainter og{&TileMap};
-    QPainter high{&currentWithNoHighlight};
-    QPainter sel{&currentWithNoSelection};
+    QVector<Map16Tile> decoded;
+    QString error;
+    // whatever could be read is kept, saving must never write back less than was loaded
+    if (!Map16Format::decodeBase64(data, decoded, error))
+        ErrorReporter::error(error);
+    const int needed = Map16Format::InternalTiles + static_cast<int>(decoded.size());
+    const bool grow = needed > tiles.length() * 16;
+    while (tiles.length() * 16 < needed)
+        tiles.append(QVector<FullTile>(16, FullTile{0, 0, 0, 0, false}));
     auto size = CellSize();
-    while (!str.atEnd()) {
-        quint16 tl, tr, bl, br;
-        str >> tl;
-        str >> bl;
-        str >> tr;
-        str >> br;
-        tiles[i][j] = FullTile(tl, bl, tr, br, false);
-        auto img = tiles[i][j].getScaled(size, tiles[i][j].translucent);
-        high.drawImage(QRect{j * size, i * size, size, size}, img);
-        sel.drawImage(QRect{j * size, i * size, size, size}, img);
-        og.drawImage(QRect{j * size, i * size, size, size}, img);
-        if (j == 15) {
-            j = 0;
-            i++;
-        } else {
-            j++;
-        }
+    for (int t = 0; t < decoded.size(); t++) {
+        const auto& [tl, bl, tr, br] = decoded[t];
+        const int index = Map16Format::InternalTiles + t;
+        FullTile& tile = tileAt(index);
+        tile = FullTile(tl, bl, tr, br, false);
+        if (!grow && !m_renderPending)
+            AlphaBlend::blendImage(TileMap, QPoint{(index % 16) * size, (index / 16) * size}, tile.getScaled(size, tile.translucent));
     }
-    og.end();
-    high.end();
-    sel.end();
-    drawCurrentSelectedTile(currentWithNoHighlight);
-    currentMap16->setPixmap(currentWithNoHighlight);
+    // the tiles that were there before and weren't overwritten stay
+    findLastUsedTile(tiles.length() * 16 - 1);
+    if (grow) {
+        // the sheet gets the new pages, drawn with everything else
+        imageWidth = tiles.first().length() * 16;
+        imageHeight = tiles.length() * 16;
+        drawInternalMap16File();
+    } else if (m_renderPending) {
+        // the sheet being drawn doesn't have the new tiles, one that does replaces it
+        renderSheet();
+    }
+    currentMap16->update();
 }
 
 QString Map16GraphicsView::getMap16() {
-    qDebug() << "Tot rows: " << tiles.length();
-    constexpr int base_row = (16 * 3);
-    int row = tiles.length() - 1, col = 15;
-    bool found = false;
-    for (; row >= base_row; row--) {
-        for (; col >= 0; col--)
-            if ((found = !tiles[row][col].isEmpty()))
-                break;
-        if (found) break;
-        col = 15;
-    }
-    if (!found) return "";
-    QByteArray data;
-    QDataStream str{&data, QIODevice::WriteOnly};
-    str.setByteOrder(QDataStream::LittleEndian);
-    qDebug() << "col: " << col << " row: " << row;
-    for (int i = base_row; i <= row; i++) {
-        for (int j = 0; j <= (i == row ? col : 15); j++) {
-            FullTile& t = tiles[i][j];
-            str << t.topleft.TileValue();
-            str << t.bottomleft.TileValue();
-            str << t.topright.TileValue();
-            str << t.bottomright.TileValue();
-        }
+    if (m_map16Cache)
+        return *m_map16Cache;
+    QVector<Map16Tile> packed;
+    packed.reserve(std::max(0, m_lastUsedTile + 1 - Map16Format::InternalTiles));
+    for (int i = Map16Format::InternalTiles; i <= m_lastUsedTile; i++) {
+        FullTile& t = tileAt(i);
+        packed.append(Map16Tile{t.topleft.TileValue(), t.bottomleft.TileValue(), t.topright.TileValue(), t.bottomright.TileValue()});
     }
-    qDebug() << data;
-    return QString{data.toBase64()};
+    m_map16Cache = Map16Format::encodeBase64(packed);
+    return *m_map16Cache;
 }
 
 bool Map16GraphicsView::loadExternalGraphics() {
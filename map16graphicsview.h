@@ -6,6 +6,9 @@
 #include <QImage>
 #include <QPainter>
 #include <QGraphicsView>
+#include <QGraphicsScene>
+#include <QGraphicsItem>
+#include <QStyleOptionGraphicsItem>
 #include <QMouseEvent>
 #include <QDataStream>
 #include <QFile>
@@ -15,7 +18,10 @@
 #include <QComboBox>
 #include <QFileDialog>
 #include <functional>
+#include <optional>
 #include "clipboardtile.h"
+#include "map16renderworker.h"
+#include "memoryaccounting.h"
 
 enum class SelectorType : int {
     Eight = 8,
@@ -30,20 +36,59 @@ enum class TileChangeAction {
     Translucent
 };
 
+class Map16GraphicsView;
+
+// Paints the map16 sheet straight from the view's layer images, so hover, selection,
+// grid and page separators never require copying or converting the whole sheet.
+class Map16SheetItem : public QGraphicsItem
+{
+public:
+    Map16SheetItem(Map16GraphicsView* view);
+    QRectF boundingRect() const override;
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+    void sheetChanged();
+    void setHighlight(const QRect& rect);
+    void setSelection(const QRect& rect);
+private:
+    Map16GraphicsView* m_view;
+    QRect m_highlight;
+    QRect m_selection;
+};
+
 class Map16GraphicsView : public QGraphicsView
 {
     Q_OBJECT
+    friend class Map16SheetItem;
 private:
     QGraphicsScene* currScene = nullptr;
-    QGraphicsPixmapItem* currentMap16 = nullptr;
+    Map16SheetItem* currentMap16 = nullptr;
     QLabel* tileNumLabel;
     QImage TileMap;
     QImage Grid;
     QImage PageSep;
-    QPixmap currentWithNoHighlight;
-    QPixmap currentWithNoSelection;
     ClipboardTile* copiedTile = nullptr;
     QString mapName;
+    MemoryAccount m_memory{MemoryAccounting::Map16Sheet};
+    // last tile of the user pages that isn't empty, -1 if they're all empty; getMap16 stops there
+    int m_lastUsedTile = -1;
+    // what getMap16 returns, until a tile of the user pages changes
+    std::optional<QString> m_map16Cache;
+    FullTile& tileAt(int index);
+    // keeps the last used tile and the cache up to date, index is a 16x16 tile
+    void userTileChanged(int index);
+    // the last used tile at or before from, for when the previous last one was cleared or everything was replaced
+    void findLastUsedTile(int from);
+    // size of the sheet before scaling and its scale factor, as of the last drawInternalMap16File
+    QSize m_unscaledSize;
+    int m_sheetScale = 1;
+    // draws the sheet off the GUI thread when set, see setBackgroundRendering
+    std::unique_ptr<Map16RenderWorker> m_renderWorker;
+    bool m_renderPending = false;
+    // 16x16 tiles edited while the sheet was being drawn, they're drawn again on the new one
+    QVector<int> m_editedWhileRendering;
+    // draws TileMap from the tiles, right away or on the worker
+    void renderSheet();
+    void swapSheet(const QImage& sheet);
 public:
     int imageWidth = 0;
     int imageHeight = 0;
@@ -69,10 +114,16 @@ public:
     bool readInternalMap16File();
     void readExternalMap16File(const QString& name);
     void drawInternalMap16File();
+    // redraws of the whole sheet happen on a worker thread and the previous sheet is shown until they're done,
+    // off by default so that drawInternalMap16File leaves the finished sheet behind
+    void setBackgroundRendering(bool enabled);
     int mouseCoordinatesToTile(QPoint position);
     QPoint translateToRect(QPoint position);
+    // the 16x16 tile a tile number of the current selector size is in
+    int realTileIndex(int tilenum);
     FullTile& tileNumToTile(int tilenum);
-    void drawCurrentSelectedTile(QPixmap& map);
+    void drawCurrentSelectedTile();
+    void paintCell(const QRect& rect, const QImage& img);
     void tileChanged(QObject* toBlock, TileChangeAction action, TileChangeType type = TileChangeType::All, int value = -1);
     void mousePressEvent(QMouseEvent* event);
     void registerMouseClickCallback(const std::function<void(FullTile, int, SelectorType)>& callback);
@@ -89,12 +140,19 @@ public:
     void removePageSep();
     void setCopiedTile(ClipboardTile& tile);
     void setMap16(const QString& data);
+    // the user pages up to their last used tile, in base64
     QString getMap16();
+    // the drawn tiles, without grid, page separators or selection
+    const QImage& sheetImage() const;
+    // the sheet, grid and page separator images
+    qsizetype imageBytes() const;
     const ClipboardTile& getCopiedTile();
     void switchCurrSelectionType();
     bool loadExternalGraphics();
 signals:
     void signalTileUpdatedForDisplay(const FullTile& tile, int tileno);
+    // the user page of the map16 was changed, setMap16 doesn't emit it
+    void map16Edited();
 };
 
 #endif // MAP16GRAPHICSVIEW_H
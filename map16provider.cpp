@@ -1,22 +1,16 @@
 #include "map16provider.h"
-
-Map16Provider::Map16Provider(QWidget* parent) : QLabel(parent)  {
-    tileGrid = createGrid();
-    base = createBase();
-    setPixmap(overlay());
-    setMargin(0);
+#include "alphablend.h"
+#include "displayrenderer.h"
+#include "tracing.h"
+#include "utils.h"
+
+Map16Provider::Map16Provider(QWidget* parent) : QWidget(parent)  {
+    m_textLayer = createBase();
+    accountImages();
+    setAttribute(Qt::WA_OpaquePaintEvent);
     setFixedSize(208, 208);
     setMouseTracking(true);
     setFocusPolicy(Qt::FocusPolicy::ClickFocus);
-    QImage letters{":/Resources/Text/Letters.png"};
-    size_t n = 0;
-    int sizes[3] = {26, 26, 19};
-    for (int i = 0; i < 3; i++) {
-        for (int j = 0; j < sizes[i]; j++) {
-            m_letters[n] = letters.copy(QRect{j * 8, i * 8, 8, 8});
-            n++;
-        }
-    }
 }
 
 void Map16Provider::attachMap16View(Map16GraphicsView* view) {
@@ -32,12 +26,15 @@ void Map16Provider::attachMap16View(Map16GraphicsView* view) {
                 }
             }
             if (changed) {
-                redrawAt(i);
+                invalidateCanvas(i);
                 anyChanged = true;
             }
         }
-        if (anyChanged && currentIndex != -1)
-            setPixmap(drawSelectedTile());
+        if (!anyChanged)
+            return;
+        emit displayTilesEdited();
+        if (currentIndex != -1)
+            update();
     });
 }
 
@@ -54,8 +51,25 @@ TiledPosition& Map16Provider::findIndex(size_t index) {
     return *ret;
 }
 
+QRect Map16Provider::tileRect(TiledPosition& tile) const {
+    int size = tile.tile.isFullTile() ? 16 : 8;
+    return QRect{tile.pos.x(), tile.pos.y(), size, size};
+}
+
+QRect Map16Provider::selectionRect() {
+    if (m_currentSelected == SIZE_MAX || currentIndex < 0 || currentIndex >= m_tiles.size())
+        return QRect{};
+    auto& t = findIndex(m_currentSelected);
+    if (t.tid == SIZE_MAX)
+        return QRect{};
+    // the selection outline is always 16x16 and the 1px pen spills one pixel past the rect
+    return QRect{t.pos.x(), t.pos.y(), 16, 16}.adjusted(-1, -1, 1, 1);
+}
+
 void Map16Provider::setCurrentlySelected(size_t tid) {
+    update(selectionRect());
     m_currentSelected = tid;
+    update(selectionRect());
     if (tid == SIZE_MAX || currentIndex == -1) {
         emit currentlySelectedTileChanged(tid, false);
     } else {
@@ -74,29 +88,39 @@ QPoint Map16Provider::alignToGrid(QPoint position, int size) {
     return QPoint(position.x() - (position.x() % size), position.y() - (position.y() % size));
 }
 
-QPixmap Map16Provider::drawSelectedTile() {
-    QPixmap curr = overlay();
-    if (m_currentSelected == SIZE_MAX)
-        return curr;
-    QPainter p{&curr};
-    QPen pen{Qt::white, 1, Qt::DotLine, Qt::SquareCap, Qt::BevelJoin};
-    p.setPen(pen);
-    auto& t = findIndex(m_currentSelected);
-    auto size = 16;
-    p.drawRect(QRect{t.pos.x(), t.pos.y(), size, size});
+void Map16Provider::paintEvent(QPaintEvent *event) {
+    const QRect dirty = event->rect();
+    QPainter p{this};
+    const QImage& background = staticLayer();
+    const qreal dpr = background.devicePixelRatio();
+    p.drawImage(dirty, background, QRectF{QPointF{dirty.topLeft()} * dpr, QSizeF{dirty.size()} * dpr});
+    if (currentIndex >= 0 && currentIndex < m_tiles.size()) {
+        if (usesText[currentIndex])
+            p.drawImage(dirty, m_textLayer, dirty);
+        else
+            p.drawImage(dirty, displayCanvas(currentIndex), dirty);
+    }
+    if (m_currentSelected != SIZE_MAX && currentIndex != -1) {
+        auto& t = findIndex(m_currentSelected);
+        if (t.tid != SIZE_MAX) {
+            QPen pen{Qt::white, 1, Qt::DotLine, Qt::SquareCap, Qt::BevelJoin};
+            p.setPen(pen);
+            p.drawRect(QRect{t.pos.x(), t.pos.y(), 16, 16});
+        }
+    }
     p.end();
-    return curr;
 }
 
 void Map16Provider::insertText(const QString& text) {
     m_descriptions[currentIndex] = text;
-    setPixmap(overlay());
+    refreshTextLayer();
+    update();
+    emit displayTilesEdited();
 }
 
 void Map16Provider::mousePressEvent(QMouseEvent *event) {
     if (m_tiles.length() == 0 || currentIndex == -1)
         return;
-    QPainter p{&m_displays[currentIndex]};
     if (event->button() == Qt::MouseButton::LeftButton) {
         grabKeyboard();
         qDebug() << "Left mouse button pressed";
@@ -108,7 +132,6 @@ void Map16Provider::mousePressEvent(QMouseEvent *event) {
             return;
         setCurrentlySelected((*ret).tid);
         pressOffset = event->position().toPoint() - (*ret).pos;
-        setPixmap(drawSelectedTile());
         currentlyPressed = true;
         return;
     } else if (event->button() == Qt::MouseButton::RightButton) {
@@ -121,23 +144,31 @@ void Map16Provider::mousePressEvent(QMouseEvent *event) {
         QPoint aligned = alignToGrid(event->position().toPoint(), size);
         FullTile fullTile = copiedTile->getTile();
         TiledPosition tile{fullTile, aligned, 0, TiledPosition::unique_index++, copiedTile->TileNum(), fullTile.translucent};
+        // fetch the canvas before appending, otherwise a freshly rendered one would already contain the tile
+        QImage& canvas = displayCanvas(currentIndex);
         setCurrentlySelected(tile.tid);
         m_tiles[currentIndex].append(std::move(tile));
-        p.setCompositionMode(QPainter::CompositionMode_SourceOver);
-        p.drawImage(QRect{aligned.x(), aligned.y(), copiedTile->size(), copiedTile->size()}, copiedTile->draw());
+        // drawn the way renderCanvas draws it, 8x8 tiles keep their size
+        auto& pasted = m_tiles[currentIndex].last();
+        const QImage image = pasted.tile.getFullTile(pasted.translucent);
+        AlphaBlend::blendImage(canvas, aligned, image);
+        update(QRect{aligned, image.size()}.united(selectionRect()));
+        emit displayTilesEdited();
     }
-    setPixmap(drawSelectedTile());
     event->accept();
 }
 
 void Map16Provider::mouseReleaseEvent(QMouseEvent *event) {
     if (currentlyPressed && m_currentSelected != SIZE_MAX) {
         auto& tile = findIndex(m_currentSelected);
+        QRect dirty = selectionRect();
         int size = static_cast<int>(selectorSize);
         QPoint p = tile.pos;
         tile.pos = QPoint(((p.x() + size / 2) / size) * size,
                           ((p.y() + size / 2) / size) * size);
-        redrawNoSort();
+        redrawAt(currentIndex);
+        update(dirty.united(selectionRect()));
+        emit displayTilesEdited();
     }
     currentlyPressed = false;
     event->accept();
@@ -146,8 +177,10 @@ void Map16Provider::mouseReleaseEvent(QMouseEvent *event) {
 void Map16Provider::mouseMoveEvent(QMouseEvent *event) {
     if (currentlyPressed && m_currentSelected != SIZE_MAX) {
         auto& tile = findIndex(m_currentSelected);
+        QRect dirty = selectionRect();
         tile.pos = event->position().toPoint() - pressOffset;
-        redrawNoSort();
+        redrawAt(currentIndex);
+        update(dirty.united(selectionRect()));
     }
     event->accept();
 }
@@ -160,69 +193,107 @@ void Map16Provider::wheelEvent(QWheelEvent *event) {
         if (event->angleDelta().y() < 0 && t.zpos > INT_MIN) {
             t.zpos--;
             redraw();
+            emit displayTilesEdited();
         } else if (event->angleDelta().y() > 0 && t.zpos < INT_MAX){
             t.zpos++;
             redraw();
+            emit displayTilesEdited();
         }
     }
 }
 
 void Map16Provider::redrawNoSort() {
-    m_displays[currentIndex].fill(Qt::transparent);
-    QPainter p{&m_displays[currentIndex]};
-    for (auto& t : m_tiles[currentIndex]) {
-        int size = t.tile.isFullTile() ? 16 : 8;
-        p.drawImage(QRect{t.pos.x(), t.pos.y(), size, size}, t.tile.getFullTile(t.translucent));
-    }
-    p.end();
-    setPixmap(drawSelectedTile());
+    TRACE_SCOPE("Map16Provider::redrawNoSort");
+    redrawAt(currentIndex);
+    update();
 }
 
 void Map16Provider::redrawFirstIndex() {
+    TRACE_SCOPE("Map16Provider::redrawFirstIndex");
     if (m_tiles.empty())
         return;
     if (m_tiles.first().empty())
         return;
-    m_displays.first().fill(Qt::transparent);
-    QPainter p{&m_displays.first()};
     std::sort(m_tiles.first().begin(), m_tiles.first().end(), [](TiledPosition& lhs, TiledPosition& rhs) {
         return lhs.zpos < rhs.zpos;
     });
-    for (auto& t : m_tiles.first()) {
-        int size = t.tile.isFullTile() ? 16 : 8;
-        p.drawImage(QRect{t.pos.x(), t.pos.y(), size, size}, t.tile.getFullTile(t.translucent));
-    }
-    setPixmap(drawSelectedTile());
+    invalidateCanvas(0);
+    update();
 }
 
 void Map16Provider::redraw() {
+    TRACE_SCOPE("Map16Provider::redraw");
     if (currentIndex == -1) {
         redrawFirstIndex();
         return;
     }
-    m_displays[currentIndex].fill(Qt::transparent);
-    QPainter p{&m_displays[currentIndex]};
     std::sort(m_tiles[currentIndex].begin(), m_tiles[currentIndex].end(), [](TiledPosition& lhs, TiledPosition& rhs) {
         return lhs.zpos < rhs.zpos;
     });
-    for (auto& t : m_tiles[currentIndex]) {
-        int size = t.tile.isFullTile() ? 16 : 8;
-        p.drawImage(QRect{t.pos.x(), t.pos.y(), size, size}, t.tile.getFullTile(t.translucent));
-    }
-    setPixmap(drawSelectedTile());
+    redrawAt(currentIndex);
+    update();
 }
 
 void Map16Provider::redrawAt(int index) {
-    if (index < 0 || index >= m_displays.size())
+    TRACE_SCOPE("Map16Provider::redrawAt");
+    if (index < 0 || index >= m_tiles.size())
+        return;
+    // only the display on screen is worth rendering right away, the others are rendered when shown
+    if (index != currentIndex) {
+        invalidateCanvas(index);
         return;
-    m_displays[index].fill(Qt::transparent);
-    QPainter p{&m_displays[index]};
+    }
+    renderCanvas(index, displayCanvas(index));
+}
+
+QImage Map16Provider::canvas(int index) {
+    if (index < 0 || index >= m_displayIds.size())
+        return {};
+    return displayCanvas(index);
+}
+
+void Map16Provider::accountImages() {
+    m_memory.update(imageBytes());
+}
+
+qsizetype Map16Provider::imageBytes() const {
+    qsizetype bytes = m_textLayer.sizeInBytes();
+    for (auto& layer : m_staticLayers)
+        bytes += layer.sizeInBytes();
+    for (auto& key : m_canvases.keys())
+        bytes += m_canvases.object(key)->sizeInBytes();
+    return bytes;
+}
+
+QImage& Map16Provider::displayCanvas(int index) {
+    QImage* canvas = m_canvases.object(m_displayIds[index]);
+    if (canvas) {
+        PerfCounters::add(PerfCounters::CanvasCacheHits);
+        return *canvas;
+    }
+    PerfCounters::add(PerfCounters::CanvasCacheMisses);
+    canvas = new QImage{createBase()};
+    renderCanvas(index, *canvas);
+    m_canvases.insert(m_displayIds[index], canvas);
+    accountImages();
+    return *canvas;
+}
+
+void Map16Provider::renderCanvas(int index, QImage& canvas) {
+    TRACE_SCOPE_COUNTER("Map16Provider::renderCanvas", CanvasRedrawNs);
+    canvas.fill(Qt::transparent);
     for (auto& t : m_tiles[index]) {
-        int size = t.tile.isFullTile() ? 16 : 8;
-        p.drawImage(QRect{t.pos.x(), t.pos.y(), size, size}, t.tile.getFullTile(t.translucent));
+        AlphaBlend::blendImage(canvas, t.pos, t.tile.getFullTile(t.translucent));
     }
 }
 
+void Map16Provider::invalidateCanvas(int index) {
+    if (index < 0 || index >= m_displayIds.size())
+        return;
+    m_canvases.remove(m_displayIds[index]);
+    accountImages();
+}
+
 void Map16Provider::setTranslucencyForSelectedTile(bool translucent) {
     if (m_currentSelected == SIZE_MAX) return;
     auto it = std::find_if(m_tiles[currentIndex].begin(), m_tiles[currentIndex].end(), [this](const auto& tile) {
@@ -231,13 +302,16 @@ void Map16Provider::setTranslucencyForSelectedTile(bool translucent) {
     if (it == m_tiles[currentIndex].end()) return;
     else it->translucent = translucent;
     redraw();
+    emit displayTilesEdited();
 }
 
 void Map16Provider::redrawAll() {
-    for (int i = 0; i < m_displays.size(); i++)
-        redrawAt(i);
+    TRACE_SCOPE("Map16Provider::redrawAll");
+    // tiles are re-rendered lazily, the next paint picks up the new graphics
+    m_canvases.clear();
+    accountImages();
     if (currentIndex != -1)
-        setPixmap(drawSelectedTile());
+        update();
 }
 
 void Map16Provider::setCopiedTile(ClipboardTile& tile) {
@@ -248,22 +322,35 @@ ClipboardTile* Map16Provider::getCopiedTile() {
     return copiedTile;
 }
 
-QPixmap Map16Provider::createBase() {
-    QPixmap pix{208, 208};
-    pix.fill(Qt::transparent);
-    return pix;
+QImage Map16Provider::createBase() {
+    return DisplayRenderer::createCanvas();
 }
 
-QPixmap Map16Provider::createGrid() {
-    QImage img{208, 208, QImage::Format::Format_ARGB32};
+const QImage& Map16Provider::staticLayer() {
+    const qreal dpr = devicePixelRatioF();
+    QPair<int, qreal> key{static_cast<int>(selectorSize), dpr};
+    auto it = m_staticLayers.constFind(key);
+    if (it != m_staticLayers.cend()) {
+        PerfCounters::add(PerfCounters::LayerCacheHits);
+        return *it;
+    }
+    PerfCounters::add(PerfCounters::LayerCacheMisses);
+    it = m_staticLayers.insert(key, createStaticLayer(selectorSize, dpr));
+    accountImages();
+    return *it;
+}
+
+QImage Map16Provider::createStaticLayer(SizeSelector selector, qreal dpr) {
+    QImage img{QSize{208, 208} * dpr, SnesGFXConverter::TileFormat};
+    img.setDevicePixelRatio(dpr);
     QPainter p{&img};
+    p.fillRect(QRect{0, 0, 208, 208}, QBrush(QGradient(QGradient::AmourAmour)));
     QPen pen(Qt::lightGray, 0, Qt::SolidLine, Qt::FlatCap, Qt::BevelJoin);
     pen.setWidthF(0.5);
     p.setPen(pen);
-    img.fill(qRgba(0, 0, 0, 0));
-    int size = static_cast<int>(selectorSize);
+    int size = static_cast<int>(selector);
     if (size != 8 && size != 16) {
-        return QPixmap::fromImage(img);
+        return img;
     }
     for (int i = size; i < 208; i += size) {
         p.drawLine(0, i, 208, i);
@@ -277,66 +364,36 @@ QPixmap Map16Provider::createGrid() {
         QRect box_rect{center, center, 16, 16};
         p.drawRect(box_rect);
     }
-    return QPixmap::fromImage(img);
-}
-
-QPixmap Map16Provider::overlay() {
-    QPixmap pix{208, 208};
-    QPainter p{&pix};
-    p.fillRect(pix.rect(), QBrush(QGradient(QGradient::AmourAmour)));
-    p.drawImage(pix.rect(), tileGrid.toImage());
-    if (currentIndex < 0 || currentIndex >= m_displays.size()) {
-        p.drawImage(pix.rect(), base.toImage());
-    } else if (usesText[currentIndex]) {
-        drawLetters(p);
-    } else {
-        p.drawImage(pix.rect(), m_displays[currentIndex].toImage());
-    }
-    p.end();
-    return pix;
-}
-
-void Map16Provider::drawLetters(QPainter& p) {
-    constexpr int cpl = 24; // 26 is a whole line
-    auto slines = m_descriptions[currentIndex].split("\n", Qt::SkipEmptyParts);
-    for (qsizetype i = 0; i < slines.length(); i++) {
-        QString str{slines[i].trimmed()};
-        int max = str.length();
-        if (max > cpl) {
-            slines.removeAt(i);
-            int curr = 0;
-            int j = 0;
-            while (max - curr > cpl) {
-                auto slice = str.sliced(curr, (curr + cpl >= max) ? (max - curr) : cpl).trimmed();
-                auto space = slice.lastIndexOf(' ');
-                if (space == -1) {
-                    slines.insert(i + j, slice);
-                    curr += cpl;
-                }
-                else {
-                    slines.insert(i + j, slice.sliced(0, space));
-                    curr += (space + 1);
-                }
-                j++;
-            }
-            slines.insert(i + j, str.sliced(curr));
-        }
-    }
-    auto str = m_descriptions[currentIndex].toStdString();
-    int lines = slines.length();
-    int vmargin = (208 - (lines * 8)) / 2;
-    for (int row = 0; row < lines; row++) {
-        auto str = slines[row].toStdString();
-        int hmargin = static_cast<int>((208 - (str.length() * 8)) / 2);
-        for (int col = 0; col < (int)str.length(); col++) {
-            char c = str[col];
-            if (table.find(c) == table.cend()) {
-                p.drawImage(QRect{hmargin + (col * 8), vmargin + (row * 8), 8, 8}, m_letters[(*table.find(' ')).second]);
-            } else {
-                p.drawImage(QRect{hmargin + (col * 8), vmargin + (row * 8), 8, 8}, m_letters[(*table.find(c)).second]);
-            }
-        }
+    return img;
+}
+
+void Map16Provider::refreshTextLayer() {
+    m_textLayer.fill(Qt::transparent);
+    if (currentIndex < 0 || currentIndex >= m_tiles.size() || !usesText[currentIndex])
+        return;
+    updateTextLayout(m_descriptions[currentIndex]);
+    DisplayRenderer::drawText(m_textLayer, m_layoutLines);
+}
+
+void Map16Provider::updateTextLayout(const QString& text) {
+    if (text == m_layoutText && !m_layoutLines.isEmpty())
+        return;
+    m_layoutText = text;
+    auto paragraphs = text.split("\n", Qt::SkipEmptyParts);
+    QVector<QVector<QByteArray>> wrapped;
+    wrapped.reserve(paragraphs.length());
+    for (qsizetype i = 0; i < paragraphs.length(); i++) {
+        // typing only ever touches one paragraph, the others keep their wrapping
+        if (i < m_layoutParagraphs.length() && m_layoutParagraphs[i] == paragraphs[i])
+            wrapped.append(m_layoutWrapped[i]);
+        else
+            wrapped.append(DisplayRenderer::wrapParagraph(paragraphs[i]));
     }
+    m_layoutParagraphs = std::move(paragraphs);
+    m_layoutWrapped = std::move(wrapped);
+    m_layoutLines.clear();
+    for (auto& lines : m_layoutWrapped)
+        m_layoutLines.append(lines);
 }
 
 const Map16Provider::DisplayTiles& Map16Provider::Tiles() {
@@ -350,66 +407,92 @@ void Map16Provider::setUseText(bool enabled) {
     usesText[currentIndex] = enabled;
     if (enabled)
         m_tiles[currentIndex].clear();
+    refreshTextLayer();
+    update();
+    emit displayTilesEdited();
 }
 
 void Map16Provider::addDisplay(int index) {
     qDebug() << "Index is " << index;
     index++;
     m_tiles.insert(index, DisplayTiles());
-    m_displays.insert(index, createBase());
+    m_displayIds.insert(index, m_nextDisplayId++);
     usesText.insert(index, false);
     m_descriptions.insert(index, "");
     currentIndex = index;
-    setPixmap(overlay());
+    refreshTextLayer();
+    update();
+    emit displayTilesEdited();
 }
 void Map16Provider::removeDisplay(int index) {
     if (index < 0)
         index = currentIndex;
-    if (index < 0 || index >= m_displays.size())
+    if (index < 0 || index >= m_tiles.size())
         return;
-    m_displays.removeAt(index);
+    invalidateCanvas(index);
+    m_displayIds.removeAt(index);
     m_tiles.removeAt(index);
     usesText.removeAt(index);
     m_descriptions.removeAt(index);
     setCurrentlySelected(SIZE_MAX);
-    if (m_displays.isEmpty())
+    if (m_tiles.isEmpty())
         currentIndex = -1;
     else
-        currentIndex = std::min(index, static_cast<int>(m_displays.size()) - 1);
-    setPixmap(overlay());
+        currentIndex = std::min(index, static_cast<int>(m_tiles.size()) - 1);
+    refreshTextLayer();
+    update();
+    emit displayTilesEdited();
 }
 void Map16Provider::changeDisplay(int index) {
-    currentIndex = index;
     setCurrentlySelected(SIZE_MAX);
-    setPixmap(overlay());
+    currentIndex = index;
+    refreshTextLayer();
+    update();
+}
+
+void Map16Provider::moveDisplays(int from, int count, int before) {
+    if (count <= 0 || from < 0 || from + count > m_tiles.size() || before < 0 || before > m_tiles.size()
+        || (before >= from && before <= from + count))
+        return;
+    // the canvases are keyed by display id, they move with it
+    moveItems(m_displayIds, from, count, before);
+    moveItems(m_tiles, from, count, before);
+    moveItems(usesText, from, count, before);
+    moveItems(m_descriptions, from, count, before);
+    if (currentIndex != -1)
+        currentIndex = static_cast<int>(movedIndex(currentIndex, from, count, before));
+    emit displayTilesEdited();
 }
 
 void Map16Provider::cloneDisplay(int index) {
-    if (currentIndex < 0 || currentIndex >= m_displays.size())
+    if (currentIndex < 0 || currentIndex >= m_tiles.size())
         return;
     if (index < 0)
         index = currentIndex + 1;
-    QPixmap pix = m_displays[currentIndex];
     DisplayTiles tiles = m_tiles[currentIndex];
     bool ut = usesText[currentIndex];
     QString desc = m_descriptions[currentIndex];
     for (auto& t : tiles)
         t.tid = TiledPosition::unique_index++;
-    m_displays.insert(index, pix);
+    if (QImage* canvas = m_canvases.object(m_displayIds[currentIndex]))
+        m_canvases.insert(m_nextDisplayId, new QImage{*canvas});
+    accountImages();
+    m_displayIds.insert(index, m_nextDisplayId++);
     m_tiles.insert(index, tiles);
     usesText.insert(index, ut);
     m_descriptions.insert(index, desc);
-    currentIndex = index;
     setCurrentlySelected(SIZE_MAX);
-    setPixmap(overlay());
+    currentIndex = index;
+    refreshTextLayer();
+    update();
+    emit displayTilesEdited();
 }
 SizeSelector Map16Provider::getSelectorSize() {
     return selectorSize;
 }
 void Map16Provider::setSelectorSize(SizeSelector size) {
     selectorSize = size;
-    tileGrid = createGrid();
-    setPixmap(overlay());
+    update();
 }
 
 void Map16Provider::serializeDisplays(QVector<DisplayData>& data) {
@@ -452,6 +535,7 @@ void Map16Provider::keyPressEvent(QKeyEvent *event) {
         }
         setCurrentlySelected(SIZE_MAX);
         redrawNoSort();
+        emit displayTilesEdited();
     } else if (event->key() == Qt::Key_Escape) {
         setCurrentlySelected(SIZE_MAX);
         redrawNoSort();
@@ -463,16 +547,17 @@ void Map16Provider::keyPressEvent(QKeyEvent *event) {
 void Map16Provider::deserializeDisplays(const QVector<JSONDisplay>& displays, Map16GraphicsView* view) {
 
     // clear all to prepare for new displays
-    m_displays.clear();
+    m_canvases.clear();
+    accountImages();
+    m_displayIds.clear();
     m_tiles.clear();
     usesText.clear();
     m_descriptions.clear();
 
     // insert new displays
     setCurrentlySelected(SIZE_MAX);
-    currentIndex = 0;
     auto len = displays.length();
-    m_displays.reserve(len);
+    m_displayIds.reserve(len);
     m_tiles.reserve(len);
     usesText.reserve(len);
     m_descriptions.reserve(len);
@@ -483,18 +568,18 @@ void Map16Provider::deserializeDisplays(const QVector<JSONDisplay>& displays, Ma
         QVector<TiledPosition> tiles;
         tiles.reserve(d.tiles.length());
         for (auto& t : d.tiles) {
-            QPoint align = QPoint(t.xoff, t.yoff) + QPoint(96, 96);
+            QPoint align = DisplayRenderer::tilePosition(t);
             int i = t.tilenumber / 16;
             int j = t.tilenumber % 16;
             qDebug() << "Drawing tile " << i << j << t.translucent;
             tiles.append({view->tiles[i][j], align, 0, TiledPosition::unique_index++, t.tilenumber, t.translucent});
         }
         m_tiles.append(tiles);
-        m_displays.append(createBase());
-        redrawNoSort();
-        currentIndex++;
+        // canvases are rendered when the display is first shown
+        m_displayIds.append(m_nextDisplayId++);
     }
     currentIndex = -1;
+    update();
 }
 
 void Map16Provider::reset() {
@@ -503,9 +588,10 @@ void Map16Provider::reset() {
     usesText.clear();
     m_descriptions.clear();
     m_tiles.clear();
-    m_displays.clear();
-    tileGrid = createGrid();
-    base = createBase();
-    setPixmap(overlay());
+    m_displayIds.clear();
+    m_canvases.clear();
+    m_textLayer = createBase();
+    accountImages();
+    update();
     currentlyPressed = false;
 }
@@ -1,11 +1,15 @@
 #ifndef MAP16PROVIDER_H
 #define MAP16PROVIDER_H
-#include <QPixmap>
+#include <QImage>
 #include <QPainter>
-#include <QLabel>
+#include <QWidget>
 #include <QMouseEvent>
+#include <QPaintEvent>
+#include <QCache>
+#include <QHash>
 #include "spritedatamodel.h"
 #include "map16graphicsview.h"
+#include "memoryaccounting.h"
 
 enum SizeSelector : int {
     Sixteen = 16,
@@ -40,7 +44,7 @@ struct TiledPosition {
 };
 
 class
-    Map16Provider : public QLabel
+    Map16Provider : public QWidget
 {
     Q_OBJECT
 public:
@@ -48,6 +52,7 @@ public:
     Map16Provider(QWidget* parent = nullptr);
     void attachMap16View(Map16GraphicsView* view);
     void focusOutEvent(QFocusEvent* event);
+    void paintEvent(QPaintEvent *event);
     void mouseMoveEvent(QMouseEvent *event);
     void mousePressEvent(QMouseEvent *event);
     void mouseReleaseEvent(QMouseEvent *event);
@@ -57,11 +62,8 @@ public:
     void setCopiedTile(ClipboardTile& tile);
     QPoint alignToGrid(QPoint position, int size);
     void insertText(const QString& text);
-    QPixmap drawSelectedTile();
-    void drawLetters(QPainter& p);
-    QPixmap createGrid();
-    QPixmap createBase();
-    QPixmap overlay();
+    QImage createBase();
+    QImage createStaticLayer(SizeSelector size, qreal dpr);
     void redraw();
     void redrawNoSort();
     void redrawFirstIndex();
@@ -70,8 +72,6 @@ public:
     void redrawAll();
     ClipboardTile* getCopiedTile();
     void reset();
-    QPixmap tileGrid;
-    QPixmap base;
     bool currentlyPressed = false;
     const DisplayTiles& Tiles();
     SizeSelector getSelectorSize();
@@ -81,9 +81,31 @@ public:
     void removeDisplay(int index = -1);
     void changeDisplay(int newindex);
     void cloneDisplay(int index = -1);
+    // same arguments as QAbstractItemModel::moveRows, the current display stays current
+    void moveDisplays(int from, int count, int before);
     void serializeDisplays(QVector<DisplayData>& data);
     void deserializeDisplays(const QVector<JSONDisplay>& display, Map16GraphicsView* view);
+    // the tiles of a display as they're drawn, without background, grid, text or selection
+    QImage canvas(int index);
+    // cached canvases and layers
+    qsizetype imageBytes() const;
 private:
+    // layers composed by paintEvent, bottom to top: background and grid, display content (tiles or text), selection
+    // background and grid never change for a given selector size, so they're rendered once per size and pixel ratio
+    QHash<QPair<int, qreal>, QImage> m_staticLayers;
+    const QImage& staticLayer();
+    QImage m_textLayer;
+    void refreshTextLayer();
+    QRect tileRect(TiledPosition& tile) const;
+    QRect selectionRect();
+    // display canvases are rendered on demand and kept in a bounded cache, 208x208 ARGB32 is ~170KB each
+    static constexpr int MaxCachedCanvases = 16;
+    QImage& displayCanvas(int index);
+    void renderCanvas(int index, QImage& canvas);
+    void invalidateCanvas(int index);
+    // reports imageBytes() to MemoryAccounting, called whenever a canvas or layer is added or dropped
+    void accountImages();
+    MemoryAccount m_memory{MemoryAccounting::DisplayCanvases};
     void setCurrentlySelected(size_t index);
     TiledPosition invalid = TiledPosition::getInvalid();
     TiledPosition& findIndex(size_t index);
@@ -91,16 +113,25 @@ private:
     int currentIndex = -1;
     QPoint pressOffset{0, 0};
     SizeSelector selectorSize = SizeSelector::Sixteen;
-    std::array<QImage, 26 + 26 + 10 + 9> m_letters;
-    const std::map<char, int> table = {{'a', 0}, {'b', 1}, {'c', 2}, {'d', 3}, {'e', 4}, {'f', 5}, {'g', 6}, {'h', 7}, {'i', 8}, {'j', 9}, {'k', 10}, {'l', 11}, {'m', 12}, {'n', 13}, {'o', 14}, {'p', 15}, {'q', 16}, {'r', 17}, {'s', 18}, {'t', 19}, {'u', 20}, {'v', 21}, {'w', 22}, {'x', 23}, {'y', 24}, {'z', 25}, {'A', 26}, {'B', 27}, {'C', 28}, {'D', 29}, {'E', 30}, {'F', 31}, {'G', 32}, {'H', 33}, {'I', 34}, {'J', 35}, {'K', 36}, {'L', 37}, {'M', 38}, {'N', 39}, {'O', 40}, {'P', 41}, {'Q', 42}, {'R', 43}, {'S', 44}, {'T', 45}, {'U', 46}, {'V', 47}, {'W', 48}, {'X', 49}, {'Y', 50}, {'Z', 51}, {'0', 52}, {'1', 53}, {'2', 54}, {'3', 55}, {'4', 56}, {'5', 57}, {'6', 58}, {'7', 59}, {'8', 60}, {'9', 61}, {',', 62}, {'.', 63}, {'!', 64}, {'?', 65}, {'-', 66}, {' ', 67}, {'\'', 68}, {'"', 69}, {'&', 70}};
+    // wrapped lines of the text layer, each paragraph is only re-wrapped when it changes
+    QString m_layoutText;
+    QStringList m_layoutParagraphs;
+    QVector<QVector<QByteArray>> m_layoutWrapped;
+    QVector<QByteArray> m_layoutLines;
+    void updateTextLayout(const QString& text);
     QVector<QString> m_descriptions;
     QVector<bool> usesText;
     QVector<DisplayTiles> m_tiles;
     ClipboardTile* copiedTile = nullptr;
     Map16GraphicsView* view = nullptr;
-    QVector<QPixmap> m_displays;
+    // stable per-display keys, so inserting or removing a display doesn't shift the cache
+    QVector<size_t> m_displayIds;
+    size_t m_nextDisplayId = 0;
+    QCache<size_t, QImage> m_canvases{MaxCachedCanvases};
 signals:
     void currentlySelectedTileChanged(size_t tid, bool translucent);
+    // the tiles or text of a display were edited by the user, not emitted when displays are loaded or reset
+    void displayTilesEdited();
 };
 
 #endif // MAP16PROVIDER_H
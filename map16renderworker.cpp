@@ -0,0 +1,139 @@
+#include "map16renderworker.h"
+#include "alphablend.h"
+#include "errorreporter.h"
+#include "tracing.h"
+#include <QMutexLocker>
+#include <QPainter>
+
+namespace {
+// same as TileInfo::get8x8Tile, with the graphics and palettes of the context
+QImage tile8x8(TileInfo& info, int offset, const Map16RenderWorker::Context& context, int& missing) {
+    QImage image(8, 8, SnesGFXConverter::TileFormat);
+    image.fill(qRgba(0, 0, 0, 0));
+    if (!info.isThisTile())
+        return image;
+    const QRgb* colors = context.palettes[info.pal & 7].data();
+    if (offset == -1) {
+        if (!SnesGFXConverter::decode8x8(image, context.gfx, info.tilenum * 8 * 4, colors) && missing == -1)
+            missing = info.tilenum;
+    } else {
+        SnesGFXConverter::decode8x8(image, context.exgfx, (info.tilenum + offset) * 8 * 4, colors);
+    }
+    Qt::Orientations flipOr{};
+    if (info.vflip) flipOr |= Qt::Vertical;
+    if (info.hflip) flipOr |= Qt::Horizontal;
+    image.flip(flipOr);
+    return image;
+}
+
+// same as FullTile::getFullTile(false)
+QImage fullTile(FullTile& tile, const Map16RenderWorker::Context& context, int& missing) {
+    const bool half = tile.translucent;
+    if (tile.isFullTile()) {
+        QImage img{16, 16, SnesGFXConverter::TileFormat};
+        img.fill(Qt::transparent);
+        AlphaBlend::blendImage(img, QPoint{0, 0}, tile8x8(tile.topleft, tile.offset, context, missing), half);
+        AlphaBlend::blendImage(img, QPoint{0, 8}, tile8x8(tile.bottomleft, tile.offset, context, missing), half);
+        AlphaBlend::blendImage(img, QPoint{8, 0}, tile8x8(tile.topright, tile.offset, context, missing), half);
+        AlphaBlend::blendImage(img, QPoint{8, 8}, tile8x8(tile.bottomright, tile.offset, context, missing), half);
+        return img;
+    }
+    QImage img{8, 8, SnesGFXConverter::TileFormat};
+    img.fill(Qt::transparent);
+    for (TileInfo* info : {&tile.topleft, &tile.topright, &tile.bottomleft, &tile.bottomright}) {
+        if (info->isThisTile()) {
+            AlphaBlend::blendImage(img, QPoint{0, 0}, tile8x8(*info, tile.offset, context, missing), half);
+            break;
+        }
+    }
+    return img;
+}
+}
+
+std::shared_ptr<const Map16RenderWorker::Context> Map16RenderWorker::Context::capture() {
+    auto context = std::make_shared<Context>();
+    context->gfx = SnesGFXConverter::map16Data();
+    context->exgfx = SnesGFXConverter::externalMap16Data();
+    for (int i = 0; i < static_cast<int>(context->palettes.size()); i++) {
+        const QVector<QColor>& colors = SpritePaletteCreator::getPalette(i + 8);
+        for (int c = 1; c < colors.size() && c <= 15; c++)
+            context->palettes[i][c - 1] = colors[c].rgba();
+    }
+    return context;
+}
+
+Map16RenderWorker::Map16RenderWorker(QObject* parent) : QObject(parent) {
+    m_thread.setObjectName("Map16 render");
+    m_context.moveToThread(&m_thread);
+    m_thread.start();
+}
+
+Map16RenderWorker::~Map16RenderWorker() {
+    // stops the sheet being drawn, nothing is posted for it
+    m_generation++;
+    m_thread.quit();
+    m_thread.wait();
+}
+
+quint64 Map16RenderWorker::submit(Request request) {
+    QMutexLocker lock{&m_mutex};
+    const quint64 generation = ++m_generation;
+    m_pending = std::move(request);
+    m_pendingGeneration = generation;
+    if (!m_scheduled) {
+        m_scheduled = true;
+        QMetaObject::invokeMethod(&m_context, [this]() { process(); }, Qt::QueuedConnection);
+    }
+    return generation;
+}
+
+quint64 Map16RenderWorker::generation() const {
+    return m_generation.load();
+}
+
+void Map16RenderWorker::process() {
+    for (;;) {
+        Request request;
+        quint64 generation;
+        {
+            QMutexLocker lock{&m_mutex};
+            if (!m_pending) {
+                m_scheduled = false;
+                return;
+            }
+            request = std::move(*m_pending);
+            m_pending.reset();
+            generation = m_pendingGeneration;
+        }
+        QImage sheet = render(request, [this, generation]() {
+            return m_generation.load(std::memory_order_relaxed) != generation;
+        });
+        // the receiver checks the generation again, a newer request can come in before this gets to it
+        if (!sheet.isNull() && m_generation.load() == generation)
+            emit finished(generation, sheet);
+    }
+}
+
+QImage Map16RenderWorker::render(const Request& request, const std::function<bool()>& cancelled) {
+    TRACE_SCOPE_COUNTER("Map16RenderWorker::render", SheetRedrawNs);
+    QImage sheet{request.size, SnesGFXConverter::TileFormat};
+    QPainter p{&sheet};
+    p.setCompositionMode(QPainter::CompositionMode_SourceOver);
+    p.fillRect(sheet.rect(), QBrush(QGradient(QGradient::EternalConstance)));
+    p.end();
+    int missing = -1;
+    for (int i = 0; i < request.tiles.length(); i++) {
+        if (cancelled && cancelled())
+            return {};
+        for (int j = 0; j < request.tiles[i].length(); j++) {
+            // the tile's drawing functions aren't const, the rows stay shared with the view
+            FullTile tile = request.tiles[i][j];
+            AlphaBlend::blendImage(sheet, QPoint{j * 16, i * 16}, fullTile(tile, *request.context, missing));
+        }
+    }
+    if (missing != -1)
+        ErrorReporter::error(QString::asprintf("8x8 Tile number %03X was out of bounds. Maybe missing an external file?", missing));
+    if (request.scale == 1)
+        return sheet;
+    return sheet.scaledToWidth(sheet.width() * request.scale, Qt::FastTransformation);
+}
@@ -0,0 +1,67 @@
+#ifndef MAP16RENDERWORKER_H
+#define MAP16RENDERWORKER_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QMutex>
+#include <QObject>
+#include <QSize>
+#include <QThread>
+#include <QVector>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <optional>
+#include "clipboardtile.h"
+
+// Draws the map16 sheet on its own thread, so a palette or GFX change doesn't stall the editor while a big
+// sheet is redrawn. A request carries everything the drawing needs, the tiles and a snapshot of the graphics
+// and palettes, so the worker never touches the static SnesGFXConverter/SpritePaletteCreator state.
+// Only the newest request is drawn: submitting one replaces the pending one and stops the one being drawn.
+// The finished sheet is posted back to the thread that owns the worker, which keeps showing its previous
+// sheet until then and only has to swap it in.
+class Map16RenderWorker : public QObject
+{
+    Q_OBJECT
+public:
+    struct Context {
+        // SP0-SP3 followed by the ExAnimation file, and the ExGFX files, as loaded by SnesGFXConverter
+        QByteArray gfx;
+        QByteArray exgfx;
+        // colors 1-15 of the sprite palettes 8-F, color 0 is always transparent
+        std::array<std::array<QRgb, 15>, 8> palettes{};
+        // the graphics and palettes currently loaded, only safe on the GUI thread
+        static std::shared_ptr<const Context> capture();
+    };
+    struct Request {
+        // rows of tiles, the sheet is drawn at 16 pixels per tile and then scaled
+        QVector<QVector<FullTile>> tiles;
+        // size of the sheet before scaling, it can be larger than the tiles
+        QSize size;
+        int scale = 1;
+        std::shared_ptr<const Context> context;
+    };
+    explicit Map16RenderWorker(QObject* parent = nullptr);
+    ~Map16RenderWorker() override;
+    // returns the generation of the request, finished is only emitted for the newest one
+    quint64 submit(Request request);
+    // the generation of the newest request
+    quint64 generation() const;
+    // draws the sheet on the calling thread, cancelled is polled between rows and a null image is returned once it's true
+    static QImage render(const Request& request, const std::function<bool()>& cancelled = {});
+signals:
+    void finished(quint64 generation, const QImage& sheet);
+private:
+    void process();
+    QThread m_thread;
+    // lives on m_thread, the requests are processed through its event loop
+    QObject m_context;
+    QMutex m_mutex;
+    std::optional<Request> m_pending;
+    quint64 m_pendingGeneration = 0;
+    bool m_scheduled = false;
+    std::atomic<quint64> m_generation{0};
+};
+
+#endif // MAP16RENDERWORKER_H
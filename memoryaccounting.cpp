@@ -0,0 +1,85 @@
+#include "memoryaccounting.h"
+#include <QLocale>
+#include <array>
+#include <atomic>
+
+namespace {
+std::array<std::atomic<qint64>, MemoryAccounting::Count> s_bytes{};
+std::array<std::atomic<qint64>, MemoryAccounting::Count> s_peaks{};
+std::atomic<qint64> s_total{0};
+std::atomic<qint64> s_totalPeak{0};
+
+void raisePeak(std::atomic<qint64>& peak, qint64 value) {
+    qint64 previous = peak.load(std::memory_order_relaxed);
+    while (value > previous && !peak.compare_exchange_weak(previous, value, std::memory_order_relaxed)) {
+    }
+}
+}
+
+void MemoryAccounting::set(Subsystem subsystem, qint64 bytes) {
+    const qint64 previous = s_bytes[subsystem].exchange(bytes, std::memory_order_relaxed);
+    raisePeak(s_peaks[subsystem], bytes);
+    raisePeak(s_totalPeak, s_total.fetch_add(bytes - previous, std::memory_order_relaxed) + bytes - previous);
+}
+
+void MemoryAccounting::add(Subsystem subsystem, qint64 delta) {
+    if (delta == 0)
+        return;
+    raisePeak(s_peaks[subsystem], s_bytes[subsystem].fetch_add(delta, std::memory_order_relaxed) + delta);
+    raisePeak(s_totalPeak, s_total.fetch_add(delta, std::memory_order_relaxed) + delta);
+}
+
+qint64 MemoryAccounting::bytes(Subsystem subsystem) {
+    return s_bytes[subsystem].load(std::memory_order_relaxed);
+}
+
+qint64 MemoryAccounting::peak(Subsystem subsystem) {
+    return s_peaks[subsystem].load(std::memory_order_relaxed);
+}
+
+qint64 MemoryAccounting::total() {
+    return s_total.load(std::memory_order_relaxed);
+}
+
+qint64 MemoryAccounting::totalPeak() {
+    return s_totalPeak.load(std::memory_order_relaxed);
+}
+
+void MemoryAccounting::resetPeaks() {
+    for (int i = 0; i < Count; i++)
+        s_peaks[i].store(s_bytes[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    s_totalPeak.store(total(), std::memory_order_relaxed);
+}
+
+QString MemoryAccounting::name(Subsystem subsystem) {
+    switch (subsystem) {
+    case GfxBuffers:
+        return "GFX buffers";
+    case ExGfxBuffers:
+        return "ExGFX buffers";
+    case TileBitmap:
+        return "8x8 tile bitmap";
+    case Map16Sheet:
+        return "Map16 sheet";
+    case DisplayCanvases:
+        return "Display canvases";
+    case DisplayData:
+        return "Display data";
+    case Count:
+        break;
+    }
+    return "Unknown";
+}
+
+QString MemoryAccounting::dump() {
+    const QLocale locale;
+    QString text = QString::asprintf("%-20s %12s %12s\n", "subsystem", "current", "peak");
+    auto line = [&](const QString& name, qint64 current, qint64 peak) {
+        text += QString::asprintf("%-20s %12s %12s\n", qPrintable(name), qPrintable(locale.formattedDataSize(current)),
+                                  qPrintable(locale.formattedDataSize(peak)));
+    };
+    for (int i = 0; i < Count; i++)
+        line(name(static_cast<Subsystem>(i)), bytes(static_cast<Subsystem>(i)), peak(static_cast<Subsystem>(i)));
+    line("Total", total(), totalPeak());
+    return text;
+}
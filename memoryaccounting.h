@@ -0,0 +1,59 @@
+#ifndef MEMORYACCOUNTING_H
+#define MEMORYACCOUNTING_H
+
+#include <QString>
+#include <QtGlobal>
+
+// Bytes held by the big buffers of the editor, per subsystem, with the highest value each one reached.
+// The owners report their sizes whenever they change, so reading them costs nothing and can be done from any thread.
+class MemoryAccounting
+{
+public:
+    enum Subsystem {
+        // the decoded SP0-SP3 files (SnesGFXConverter)
+        GfxBuffers,
+        // the loaded ExGFX files (SnesGFXConverter)
+        ExGfxBuffers,
+        // the 8x8 tile viewer bitmap (CFGEditor)
+        TileBitmap,
+        // the sheet, grid and page separator images (Map16GraphicsView)
+        Map16Sheet,
+        // cached display canvases, background layers and the text layer (Map16Provider)
+        DisplayCanvases,
+        // the editor's displays with their tiles and texts (DisplayTableModel)
+        DisplayData,
+        Count
+    };
+    static void set(Subsystem subsystem, qint64 bytes);
+    static void add(Subsystem subsystem, qint64 delta);
+    static qint64 bytes(Subsystem subsystem);
+    static qint64 peak(Subsystem subsystem);
+    static qint64 total();
+    static qint64 totalPeak();
+    // peaks start over from the current values
+    static void resetPeaks();
+    static QString name(Subsystem subsystem);
+    // one line per subsystem with the current and peak size, then the totals
+    static QString dump();
+};
+
+// What one object contributes to a subsystem, taken out again when the object is destroyed.
+class MemoryAccount
+{
+public:
+    explicit MemoryAccount(MemoryAccounting::Subsystem subsystem) : m_subsystem{subsystem} {}
+    ~MemoryAccount() {
+        MemoryAccounting::add(m_subsystem, -m_bytes);
+    }
+    MemoryAccount(const MemoryAccount&) = delete;
+    MemoryAccount& operator=(const MemoryAccount&) = delete;
+    void update(qint64 bytes) {
+        MemoryAccounting::add(m_subsystem, bytes - m_bytes);
+        m_bytes = bytes;
+    }
+private:
+    MemoryAccounting::Subsystem m_subsystem;
+    qint64 m_bytes = 0;
+};
+
+#endif // MEMORYACCOUNTING_H
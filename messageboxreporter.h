@@ -0,0 +1,35 @@
+#ifndef MESSAGEBOXREPORTER_H
+#define MESSAGEBOXREPORTER_H
+
+#include <QApplication>
+#include <QMessageBox>
+#include <QThread>
+#include "errorreporter.h"
+
+class DefaultAlertImpl : QMessageBox {
+    Q_OBJECT
+private:
+public:
+    DefaultAlertImpl(QWidget* parent, const QString& message) : QMessageBox(parent) {
+        setText(message);
+    }
+
+    void operator()() {
+        exec();
+	}
+};
+
+// shows the errors of the core code the way the editor always did, with a modal DefaultAlertImpl
+class MessageBoxReporter : public ErrorReporter
+{
+public:
+    void report(const QString& message) override {
+        // widgets only exist on the GUI thread, reports from workers are shown once it gets to them
+        if (QThread::currentThread() == qApp->thread())
+            DefaultAlertImpl(nullptr, message)();
+        else
+            QMetaObject::invokeMethod(qApp, [message]() { DefaultAlertImpl(nullptr, message)(); }, Qt::QueuedConnection);
+    }
+};
+
+#endif // MESSAGEBOXREPORTER_H
@@ -0,0 +1,50 @@
+#include "modificationtracker.h"
+
+void ModificationTracker::touch(SpriteSection section) {
+    m_generations[static_cast<size_t>(section)]++;
+}
+
+bool ModificationTracker::isDirty(SpriteSection section) const {
+    auto i = static_cast<size_t>(section);
+    return m_unsaved || m_generations[i] != m_baseline[i];
+}
+
+bool ModificationTracker::anyDirty() const {
+    return m_unsaved || m_generations != m_baseline;
+}
+
+bool ModificationTracker::isModified(SpriteSection section, const std::function<quint64()>& currentHash) {
+    if (m_unsaved)
+        return true;
+    auto i = static_cast<size_t>(section);
+    if (m_generations[i] == m_baseline[i])
+        return false;
+    if (m_hashGenerations[i] != m_generations[i]) {
+        m_hashes[i] = currentHash();
+        m_hashGenerations[i] = m_generations[i];
+    }
+    if (m_hashes[i] != m_savedHashes[i])
+        return true;
+    m_baseline[i] = m_generations[i];
+    return false;
+}
+
+void ModificationTracker::markSaved(const SectionHashes& hashes) {
+    m_baseline = m_generations;
+    m_savedHashes = hashes;
+    m_hashes = hashes;
+    m_hashGenerations = m_generations;
+    m_unsaved = false;
+}
+
+void ModificationTracker::markUnsaved() {
+    m_unsaved = true;
+}
+
+quint64 ModificationTracker::generation(SpriteSection section) const {
+    return m_generations[static_cast<size_t>(section)];
+}
+
+quint64 ModificationTracker::savedHash(SpriteSection section) const {
+    return m_savedHashes[static_cast<size_t>(section)];
+}
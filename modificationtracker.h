@@ -0,0 +1,47 @@
+#ifndef MODIFICATIONTRACKER_H
+#define MODIFICATIONTRACKER_H
+
+#include <QtGlobal>
+#include <array>
+#include <functional>
+
+enum class SpriteSection {
+    Tweaks,
+    Displays,
+    Collections,
+    Map16,
+    Count
+};
+
+// Edit counters for each part of the sprite, compared against the counters recorded when the sprite was last
+// loaded or saved. A section whose counter still matches its baseline is unmodified without looking at its data,
+// an edited one is compared through its structural hash against the hash of the saved sprite.
+class ModificationTracker
+{
+public:
+    static constexpr size_t SectionCount = static_cast<size_t>(SpriteSection::Count);
+    // indexed by SpriteSection
+    using SectionHashes = std::array<quint64, SectionCount>;
+    void touch(SpriteSection section);
+    bool isDirty(SpriteSection section) const;
+    bool anyDirty() const;
+    // currentHash is only called if the section was edited since its hash was last taken
+    // a section that hashes the same as the saved one (e.g. an edit undone by hand) is clean again
+    bool isModified(SpriteSection section, const std::function<quint64()>& currentHash);
+    // everything matches what's on disk
+    void markSaved(const SectionHashes& hashes);
+    // the last save never made it to disk, everything counts as modified until the next markSaved
+    void markUnsaved();
+    quint64 generation(SpriteSection section) const;
+    quint64 savedHash(SpriteSection section) const;
+private:
+    std::array<quint64, SectionCount> m_generations{};
+    std::array<quint64, SectionCount> m_baseline{};
+    SectionHashes m_savedHashes{};
+    // last hash taken of each section and the generation it was taken at
+    SectionHashes m_hashes{};
+    std::array<quint64, SectionCount> m_hashGenerations{};
+    bool m_unsaved = false;
+};
+
+#endif // MODIFICATIONTRACKER_H
@@ -28,7 +28,7 @@ PaletteContainer::PaletteContainer(PaletteView* view, QWidget *parent) : QWidget
 		QString filename = QFileDialog::getSaveFileName(this, "Save Pal/Palmask File", "", tr("Palette Files (*.pal)"));
 		if (filename.length() == 0)
 			return;
-		SpritePaletteCreator::PaletteToFile(m_view->getCurrentItem()->pixmap().toImage(), filename);
+		SpritePaletteCreator::PaletteToFile(filename);
 	});
 	savePalette->adjustSize();
 	loadPalette->adjustSize();
@@ -19,17 +19,18 @@ void PaletteView::mousePressEvent(QMouseEvent *event) {
     if (event->button() == Qt::RightButton) {
         return;
     }
-    QImage m = currentItem->pixmap().toImage();
-    QPainter p{&m};
-    p.setBrush(QBrush(Qt::BrushStyle::SolidPattern));
-    QColor color = QColorDialog::getColor(m.pixelColor(event->position().toPoint()), this);
+    QPoint colorIndex = convertPointToTile(event->position());
+    // the palette data is the source of truth, no need to read the color back from the pixmap
+    QColor color = QColorDialog::getColor(SpritePaletteCreator::getPalette((colorIndex.y() / 16) + 8)[colorIndex.x() / 16], this);
     if (!color.isValid())
         return;
-    QPoint colorIndex = convertPointToTile(event->position());
     SpritePaletteCreator::changePaletteColor(color, colorIndex);
     emit paletteChanged();
+    QPixmap m = currentItem->pixmap();
+    QPainter p{&m};
     p.fillRect(QRect{colorIndex, QSize(16, 16)}, color);
-    currentItem->setPixmap(QPixmap::fromImage(m));
+    p.end();
+    currentItem->setPixmap(m);
     event->accept();
 }
 
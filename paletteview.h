@@ -2,6 +2,7 @@
 #define PALETTEVIEW_H
 
 #include <QGraphicsView>
+#include <QGraphicsScene>
 #include <QCloseEvent>
 #include <QGraphicsItem>
 #include <QTimer>
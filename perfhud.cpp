@@ -0,0 +1,70 @@
+#include "perfhud.h"
+#include "memoryaccounting.h"
+#include "tracing.h"
+#include <QLocale>
+
+namespace {
+QString formatDuration(qint64 ns) {
+    if (ns <= 0)
+        return "-";
+    if (ns >= 1'000'000)
+        return QString::asprintf("%.1f ms", ns / 1e6);
+    return QString::asprintf("%.0f us", ns / 1e3);
+}
+
+QString formatHitRate(PerfCounters::Counter hits, PerfCounters::Counter misses) {
+    const qint64 h = PerfCounters::value(hits);
+    const qint64 total = h + PerfCounters::value(misses);
+    if (total == 0)
+        return "-";
+    return QString::asprintf("%.0f%%", 100.0 * h / total);
+}
+}
+
+PerfHud::PerfHud(QWidget* parent)
+    : QLabel(parent)
+{
+    setTextInteractionFlags(Qt::TextSelectableByMouse);
+    setVisible(false);
+    m_timer.setInterval(RefreshMs);
+    QObject::connect(&m_timer, &QTimer::timeout, this, &PerfHud::refresh);
+}
+
+void PerfHud::setActive(bool active) {
+    if (active == isActive())
+        return;
+    PerfCounters::setEnabled(active);
+    setVisible(active);
+    if (!active) {
+        m_timer.stop();
+        return;
+    }
+    m_lastDecoded = 0;
+    m_sinceRefresh.start();
+    m_timer.start();
+    refresh();
+}
+
+bool PerfHud::isActive() const {
+    return m_timer.isActive();
+}
+
+void PerfHud::refresh() {
+    const qint64 elapsedMs = qMax<qint64>(m_sinceRefresh.restart(), 1);
+    const qint64 decoded = PerfCounters::value(PerfCounters::Decoded8x8Tiles);
+    const double tilesPerSecond = (decoded - m_lastDecoded) * 1000.0 / elapsedMs;
+    m_lastDecoded = decoded;
+    const qint64 gfxBytes = MemoryAccounting::bytes(MemoryAccounting::GfxBuffers) + MemoryAccounting::bytes(MemoryAccounting::ExGfxBuffers);
+    const qint64 imageBytes = MemoryAccounting::bytes(MemoryAccounting::TileBitmap) + MemoryAccounting::bytes(MemoryAccounting::Map16Sheet) +
+                              MemoryAccounting::bytes(MemoryAccounting::DisplayCanvases);
+    const QLocale locale;
+    setText(QString::asprintf("Sheet %s | Canvas %s | Decode %.0f tiles/s | Canvas cache %s | Layer cache %s | GFX %s | Images %s | Peak %s",
+                              qPrintable(formatDuration(PerfCounters::value(PerfCounters::SheetRedrawNs))),
+                              qPrintable(formatDuration(PerfCounters::value(PerfCounters::CanvasRedrawNs))),
+                              tilesPerSecond,
+                              qPrintable(formatHitRate(PerfCounters::CanvasCacheHits, PerfCounters::CanvasCacheMisses)),
+                              qPrintable(formatHitRate(PerfCounters::LayerCacheHits, PerfCounters::LayerCacheMisses)),
+                              qPrintable(locale.formattedDataSize(gfxBytes)),
+                              qPrintable(locale.formattedDataSize(imageBytes)),
+                              qPrintable(locale.formattedDataSize(MemoryAccounting::totalPeak()))));
+}
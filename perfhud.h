@@ -0,0 +1,27 @@
+#ifndef PERFHUD_H
+#define PERFHUD_H
+
+#include <QElapsedTimer>
+#include <QLabel>
+#include <QTimer>
+
+// One line in the status bar with what the editor is doing right now: how long the last map16 sheet and display
+// canvas redraws took, how many 8x8 tiles per second are being decoded, how often the display caches hit and how
+// much memory the GFX buffers and images take. Fed from PerfCounters, which only count while the HUD is active,
+// and MemoryAccounting.
+class PerfHud : public QLabel
+{
+    Q_OBJECT
+public:
+    explicit PerfHud(QWidget* parent = nullptr);
+    void setActive(bool active);
+    bool isActive() const;
+private:
+    static constexpr int RefreshMs = 500;
+    void refresh();
+    QTimer m_timer;
+    QElapsedTimer m_sinceRefresh;
+    qint64 m_lastDecoded = 0;
+};
+
+#endif // PERFHUD_H
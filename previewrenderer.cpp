@@ -0,0 +1,172 @@
+#include "previewrenderer.h"
+#include "alphablend.h"
+#include "headlesstool.h"
+#include "jsonsprite.h"
+#include "snesgfxconverter.h"
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSet>
+#include <QTextStream>
+#include <QThreadPool>
+
+using namespace HeadlessTool;
+
+bool PreviewRenderer::requested(int argc, char* argv[]) {
+    return hasFlag(argc, argv, "--render-previews");
+}
+
+int PreviewRenderer::run(const QStringList& arguments) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Renders every display of the sprites under a path into one PNG sheet per sprite.");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"render-previews", "Sprite file, or directory searched recursively.", "path"},
+        {"output", "Directory the sheets are written to, defaults to the input directory.", "dir"},
+        {"gfx-dir", "Directory with GFXxx.bin/ExGFXxx.bin files that aren't built in.", "dir"},
+        {"palette", "Palette file (.pal) to draw with instead of the default sprite palettes.", "file"},
+        {"columns", "Displays per row of a sheet, defaults to 4.", "n", "4"},
+        {"jobs", "Number of worker threads, defaults to the number of cores.", "n"},
+    });
+    if (!parser.parse(arguments)) {
+        QTextStream(stderr) << parser.errorText() << '\n';
+        return ExitUsage;
+    }
+    if (parser.isSet("help")) {
+        QTextStream(stdout) << parser.helpText();
+        return ExitOk;
+    }
+
+    Options options;
+    options.input = parser.value("render-previews");
+    QFileInfo input{options.input};
+    if (!input.exists()) {
+        QTextStream(stderr) << options.input << " does not exist\n";
+        return ExitUsage;
+    }
+    options.outputDir = parser.isSet("output") ? parser.value("output") : (input.isDir() ? options.input : input.absolutePath());
+    options.graphicsDir = parser.value("gfx-dir");
+    if (parser.isSet("palette")) {
+        QString error;
+        if (!DisplayRenderer::readPalette(parser.value("palette"), options.palette, error)) {
+            QTextStream(stderr) << "Could not read " << parser.value("palette") << ": " << error << '\n';
+            return ExitUsage;
+        }
+    }
+    bool ok = false;
+    options.columns = parser.value("columns").toInt(&ok);
+    if (!ok || options.columns < 1) {
+        QTextStream(stderr) << "--columns expects a positive number\n";
+        return ExitUsage;
+    }
+    if (parser.isSet("jobs")) {
+        options.jobs = parser.value("jobs").toInt(&ok);
+        if (!ok || options.jobs < 1) {
+            QTextStream(stderr) << "--jobs expects a positive number\n";
+            return ExitUsage;
+        }
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    auto results = renderTree(options);
+    auto elapsed = timer.elapsed();
+
+    return printResults(results, "rendered", elapsed, [](const Result& r) { return QString::asprintf(" (%d displays)", r.displays); });
+}
+
+QVector<PreviewRenderer::Result> PreviewRenderer::renderTree(const Options& options) {
+    QFileInfo input{options.input};
+    QDir inputDir{input.isDir() ? options.input : input.absolutePath()};
+    QDir outputDir{options.outputDir};
+
+    QStringList sources;
+    if (input.isDir())
+        sources = findFiles(options.input, {"*.json", "*.cfg"});
+    else
+        sources.append(input.absoluteFilePath());
+
+    // sprite.json and sprite.cfg would both become sprite.png, only the first one in sorted order is drawn
+    QVector<Result> results(sources.size());
+    QSet<QString> targets;
+    for (qsizetype i = 0; i < sources.size(); i++) {
+        auto relative = inputDir.relativeFilePath(sources[i]);
+        relative.chop(QFileInfo{relative}.suffix().size());
+        results[i].source = sources[i];
+        results[i].target = outputDir.filePath(relative + "png");
+        if (targets.contains(results[i].target)) {
+            results[i].status = Status::Skipped;
+            results[i].message = "another sprite with the same name is rendered to " + results[i].target;
+        }
+        targets.insert(results[i].target);
+    }
+
+    // the results were laid out above, each task only replaces its own
+    QThreadPool pool;
+    if (options.jobs > 0)
+        pool.setMaxThreadCount(options.jobs);
+    for (qsizetype i = 0; i < results.size(); i++) {
+        if (results[i].status == Status::Skipped)
+            continue;
+        pool.start([&, i]() {
+            results[i] = renderFile(results[i].source, results[i].target, options);
+        });
+    }
+    pool.waitForDone();
+    return results;
+}
+
+PreviewRenderer::Result PreviewRenderer::renderFile(const QString& source, const QString& target, const Options& options) {
+    Result result{source, target, Status::Failed, 0, {}};
+    JsonSprite sprite;
+    if (!sprite.load_file(source, result.message))
+        return result;
+    if (sprite.displays.isEmpty()) {
+        result.status = Status::Skipped;
+        result.message = "no displays";
+        return result;
+    }
+    QString warning;
+    QImage sheet = renderSheet(sprite, options, result.message, warning);
+    if (sheet.isNull())
+        return result;
+    if (!QDir{}.mkpath(QFileInfo{target}.absolutePath())) {
+        result.message = "could not create the output directory";
+        return result;
+    }
+    if (!writeAtomically(target, [&sheet](QIODevice& out) { return sheet.save(&out, "PNG"); }, result.message))
+        return result;
+    result.status = Status::Rendered;
+    result.displays = static_cast<int>(sprite.displays.size());
+    result.message = warning;
+    return result;
+}
+
+QImage PreviewRenderer::renderSheet(const JsonSprite& sprite, const Options& options, QString& error, QString& warning) {
+    const auto count = static_cast<int>(sprite.displays.size());
+    if (count == 0)
+        return {};
+    // one renderer per sprite, its tile cache is shared by displays with the same graphics
+    DisplayRenderer renderer;
+    renderer.setGraphicsDirectory(options.graphicsDir);
+    if (!options.palette.isEmpty())
+        renderer.setPalette(options.palette);
+    if (!sprite.map16.isEmpty())
+        renderer.setMap16(sprite.map16, warning);
+
+    const int columns = qMin(options.columns, count);
+    const int rows = (count + columns - 1) / columns;
+    constexpr int cell = DisplayRenderer::CanvasSize;
+    QImage sheet{columns * cell, rows * cell, SnesGFXConverter::TileFormat};
+    sheet.fill(Qt::transparent);
+    for (int i = 0; i < count; i++) {
+        const auto& display = sprite.displays[i];
+        if (!renderer.setGraphics(display.gfxinfo, error)) {
+            error = QString::asprintf("Displays[%d]: ", i) + error;
+            return {};
+        }
+        AlphaBlend::blendImage(sheet, QPoint{(i % columns) * cell, (i / columns) * cell}, renderer.render(display));
+    }
+    return sheet;
+}
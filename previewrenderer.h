@@ -0,0 +1,46 @@
+#ifndef PREVIEWRENDERER_H
+#define PREVIEWRENDERER_H
+
+#include <QStringList>
+#include <QVector>
+#include "displayrenderer.h"
+
+// Headless preview sheets, started with --render-previews.
+// Every display of a sprite is drawn with its own GFXInfo, the palette and the sprite's Map16, and the
+// displays are laid out in a grid on one PNG per sprite. Sprites are rendered in parallel on a worker pool.
+class PreviewRenderer
+{
+public:
+    enum class Status {
+        Rendered,
+        Skipped,
+        Failed
+    };
+    struct Result {
+        QString source;
+        QString target;
+        Status status = Status::Failed;
+        int displays = 0;
+        // why it failed or was skipped, or what was wrong with a sprite that was still rendered
+        QString message;
+    };
+    struct Options {
+        // a sprite file or a directory searched recursively for .json and .cfg files
+        QString input;
+        QString outputDir;
+        QString graphicsDir;
+        // sprite palettes used instead of the built-in ones, empty for the default
+        DisplayRenderer::Palette palette;
+        int columns = 4;
+        int jobs = 0;
+    };
+    static bool requested(int argc, char* argv[]);
+    static int run(const QStringList& arguments);
+    static QVector<Result> renderTree(const Options& options);
+    static Result renderFile(const QString& source, const QString& target, const Options& options);
+    // all the displays of the sprite in rows of columns cells, a null image if it has none
+    // warning is set for a problem the editor works around too, e.g. a Map16 field that had to be padded
+    static QImage renderSheet(const JsonSprite& sprite, const Options& options, QString& error, QString& warning);
+};
+
+#endif // PREVIEWRENDERER_H
@@ -1,4 +1,6 @@
 #include "snesgfxconverter.h"
+#include "tracing.h"
+#include "memoryaccounting.h"
 
 SnesGFXConverter::SnesGFXConverter(const QString& name) {
     QFile file{name};
@@ -12,7 +14,12 @@ void SnesGFXConverter::setCustomExanimation(const QString& other) {
 }
 
 bool SnesGFXConverter::populateFullMap16Data(const QVector<QString>& names) {
+    TRACE_SCOPE("SnesGFXConverter::populateFullMap16Data");
     qDebug() << "Populating map16 data with " << names;
+    // accounted on every return, a failed load leaves part of the files behind
+    struct Account {
+        ~Account() { MemoryAccounting::set(MemoryAccounting::GfxBuffers, fullmap16data.capacity()); }
+    } account;
     fullmap16data.clear();
     for (auto& name : names) {
         if (QDir(name).isAbsolute()) {
@@ -38,6 +45,9 @@ bool SnesGFXConverter::populateExternalMap16Data(const QVector<QString>& names)
         });
     if (ret != names.cend())
         return false;
+    struct Account {
+        ~Account() { MemoryAccounting::set(MemoryAccounting::ExGfxBuffers, exgfxmap16data.capacity()); }
+    } account;
     exgfxmap16data.clear();
     for (auto& name : names) {
         QFile file{name};
@@ -52,42 +62,52 @@ bool SnesGFXConverter::populateExternalMap16Data(const QVector<QString>& names)
 
 void SnesGFXConverter::clearnExternalMap16Data() {
     exgfxmap16data.clear();
+    MemoryAccounting::set(MemoryAccounting::ExGfxBuffers, exgfxmap16data.capacity());
 }
 
-QImage SnesGFXConverter::get8x8TileFromVect(int index, const QVector<QColor>& colors) {
-    int offset = index * 8 * 4;
-    QImage image(8, 8, QImage::Format::Format_ARGB32);
-    image.fill(qRgba(0, 0, 0, 0));
-    QVector<QRgb> rgbColors;
-    rgbColors.reserve(15);
-    // we skip the first color to make it transparent
-    std::for_each(colors.cbegin() + 1, colors.cend(), [&](const QColor& col) {
-         rgbColors.append(col.rgba());
-    });
+QByteArray SnesGFXConverter::map16Data() {
+    return fullmap16data;
+}
+
+QByteArray SnesGFXConverter::externalMap16Data() {
+    return exgfxmap16data;
+}
+
+bool SnesGFXConverter::decode8x8(QImage& image, const QByteArray& data, qsizetype offset, const QRgb* colors) {
+    if (offset < 0 || offset + 8 * 4 > data.length())
+        return false;
+    PerfCounters::add(PerfCounters::Decoded8x8Tiles);
     for (int row = 0; row < 8; row++) {
         uint8_t bytes[4] = { 0 };
-        for (int i = 0; i < 4; i++) {
-            qsizetype val = row * 0x2 + offset + (i & 1) + ((i & 0xFE) << 3);
-            if (val >= fullmap16data.length()) {
-                DefaultAlertImpl(nullptr, QString::asprintf("8x8 Tile number %03X was out of bounds. Maybe missing an external file?", index))();
-                return image;
-            }
-            bytes[i] = fullmap16data[val];
-        }
+        for (int i = 0; i < 4; i++)
+            bytes[i] = data[row * 0x2 + offset + (i & 1) + ((i & 0xFE) << 3)];
         for (int bit = 7; bit >= 0; bit--) {
             uint8_t pixel = 0;
             for (int i = 0; i < 4; i++)
                 pixel |= ((bytes[i] & (1 << bit)) >> bit) << i;
             if (pixel != 0)
-                image.setPixelColor(7 - bit, row, rgbColors[pixel - 1]);
+                image.setPixel(7 - bit, row, colors[pixel - 1]);
         }
     }
+    return true;
+}
+
+QImage SnesGFXConverter::get8x8TileFromVect(int index, const QVector<QColor>& colors) {
+    QImage image(8, 8, TileFormat);
+    image.fill(qRgba(0, 0, 0, 0));
+    QVector<QRgb> rgbColors;
+    rgbColors.reserve(15);
+    // we skip the first color to make it transparent
+    std::for_each(colors.cbegin() + 1, colors.cend(), [&](const QColor& col) {
+         rgbColors.append(col.rgba());
+    });
+    if (!decode8x8(image, fullmap16data, index * 8 * 4, rgbColors.constData()))
+        ErrorReporter::error(QString::asprintf("8x8 Tile number %03X was out of bounds. Maybe missing an external file?", index));
     return image;
 }
 
 QImage SnesGFXConverter::get8x8TileFromExternal(int index, const QVector<QColor>& colors, int extra_offset) {
-    int offset = index * 8 * 4 + (extra_offset * 8 * 4);
-    QImage image(8, 8, QImage::Format::Format_ARGB32);
+    QImage image(8, 8, TileFormat);
     image.fill(qRgba(0, 0, 0, 0));
     QVector<QRgb> rgbColors;
     rgbColors.reserve(15);
@@ -95,26 +115,13 @@ QImage SnesGFXConverter::get8x8TileFromExternal(int index, const QVector<QColor>
     std::for_each(colors.cbegin() + 1, colors.cend(), [&](const QColor& col) {
          rgbColors.append(col.rgba());
     });
-    for (int row = 0; row < 8; row++) {
-        uint8_t bytes[4] = { 0 };
-        for (int i = 0; i < 4; i++) {
-            qsizetype val = row * 0x2 + offset + (i & 1) + ((i & 0xFE) << 3);
-            bytes[i] = exgfxmap16data[val];
-        }
-        for (int bit = 7; bit >= 0; bit--) {
-            uint8_t pixel = 0;
-            for (int i = 0; i < 4; i++)
-                pixel |= ((bytes[i] & (1 << bit)) >> bit) << i;
-            if (pixel != 0)
-                image.setPixelColor(7 - bit, row, rgbColors[pixel - 1]);
-        }
-    }
+    decode8x8(image, exgfxmap16data, index * 8 * 4 + (extra_offset * 8 * 4), rgbColors.constData());
     return image;
 }
 
 QImage SnesGFXConverter::get8x8Tile(int orig_row, int orig_column, const QVector<QColor>& colors) {
     int offset = (orig_row * 16 * 32) + (32 * orig_column);
-    QImage image(8, 8, QImage::Format_ARGB32);
+    QImage image(8, 8, TileFormat);
     QVector<QRgb> rgbColors;
     rgbColors.reserve(15);
     // skip the first color and append it manually cause it needs to be transparent
@@ -137,12 +144,12 @@ QImage SnesGFXConverter::get8x8Tile(int orig_row, int orig_column, const QVector
 }
 QImage SnesGFXConverter::fromResource(const QString& name, const QVector<QColor>& colors) {
     SnesGFXConverter converter{name};
-    QImage fullMap(128, 64, QImage::Format::Format_ARGB32);
+    QImage fullMap(128, 64, TileFormat);
     QPainter f(&fullMap);
     f.setCompositionMode(QPainter::CompositionMode::CompositionMode_SourceOver);
     for (int row = 0; row < 4; row++) {
         for (int col = 0; col < 8; col++) {
-            QImage fullTile(16, 16, QImage::Format::Format_ARGB32);
+            QImage fullTile(16, 16, TileFormat);
             QPainter p(&fullTile);
             p.setCompositionMode(QPainter::CompositionMode::CompositionMode_SourceOver);
             p.drawImage(QRect{0, 0, 8, 8}, converter.get8x8Tile(row * 2, col * 2, colors), QRect{0, 0, 8, 8});
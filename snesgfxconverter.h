@@ -5,9 +5,6 @@
 #include <QFile>
 #include <QDebug>
 #include <QRgb>
-#include <QGraphicsScene>
-#include <QGraphicsView>
-#include <QGraphicsPixmapItem>
 #include <QPainter>
 #include <QDir>
 #include "utils.h"
@@ -23,13 +20,21 @@ private:
     ~SnesGFXConverter();
     QImage get8x8Tile(int row, int column, const QVector<QColor>& colors);
 public:
+    // every tile and canvas uses this format so drawing them onto each other never needs a conversion
+    static constexpr QImage::Format TileFormat = QImage::Format_ARGB32_Premultiplied;
     static bool populateFullMap16Data(const QVector<QString>& names);
     static QImage fromResource(const QString& name, const QVector<QColor>& colors);
+    // decodes the 4bpp tile at offset into image, colors are the 15 opaque colors of a palette row (color 0 is transparent)
+    // touches no shared state, returns false if data ends before the tile does
+    static bool decode8x8(QImage& image, const QByteArray& data, qsizetype offset, const QRgb* colors);
     static QImage get8x8TileFromVect(int index, const QVector<QColor>& colors);
     static QImage get8x8TileFromExternal(int index, const QVector<QColor>& colors, int gfxfileno);
     static void setCustomExanimation(const QString& other);
     static bool populateExternalMap16Data(const QVector<QString>& names);
     static void clearnExternalMap16Data();
+    // the loaded SP files and ExGFX files, the copies are shared and can be read on other threads
+    static QByteArray map16Data();
+    static QByteArray externalMap16Data();
 };
 
 #endif // SNESGFXCONVERTER_H
@@ -1,61 +1,6 @@
 #include "spritedatamodel.h"
-
-CollectionDataModel::CollectionDataModel()
-{
-    m_extrabit = false;
-    m_name = "";
-    memset(m_bytes, 0, 12);
-}
-const QString& CollectionDataModel::name() {
-    return m_name;
-}
-uint8_t CollectionDataModel::byte(int index) {
-    Q_ASSERT(index < 12);
-    return m_bytes[index];
-}
-bool CollectionDataModel::extrabit() {
-    return m_extrabit;
-}
-void CollectionDataModel::setName(const QString& name) {
-    m_name = name;
-}
-void CollectionDataModel::setBytes(const uint8_t* data) {
-    memcpy(m_bytes, data, 12);
-}
-void CollectionDataModel::setByte(uint8_t data, int index) {
-    Q_ASSERT(index < 12);
-    m_bytes[index] = data;
-}
-void CollectionDataModel::setExtraBit(bool bit) {
-    m_extrabit = bit;
-}
-
-CollectionDataModel CollectionDataModel::fromRow(const QVector<QStandardItem*>& row) {
-    CollectionDataModel model{};
-    model.setName(row[0]->data().toString());
-    model.setExtraBit(row[1]->data().toBool());
-    for (int i = 0; i < 12; i++) {
-        model.m_bytes[i] = (uint8_t)row[i + 2]->data().toUInt();
-    }
-    return model;
-}
-
-QVector<QStandardItem*> CollectionDataModel::fromCollection(const Collection& coll) {
-    CollectionDataModel data{};
-    data.setExtraBit(coll.extrabit);
-    data.setName(coll.name);
-    data.setBytes(coll.prop);
-    return data.getRow();
-}
-
-CollectionDataModel CollectionDataModel::fromIndex(int index, QTableView* view) {
-    CollectionDataModel data{};
-    data.setName(view->model()->data(view->model()->index(index, 0)).toString());
-    data.setExtraBit(view->model()->data(view->model()->index(index, 1)).toBool());
-    for (int i = 0; i < 12; i++)
-        data.setByte((uint8_t)view->model()->data(view->model()->index(index, i + 2)).toString().toUInt(nullptr, 16), i);
-    return data;
-}
+#include "utils.h"
+#include <algorithm>
 
 void TileData::setXOffset(int x) {
     m_x_offset = x;
@@ -90,20 +35,7 @@ bool TileData::Translucent() const {
     return m_translucent;
 }
 
-TileData& TileData::operator=(const TileData& other) {
-    m_tile_number = other.m_tile_number;
-    m_x_offset = other.m_x_offset;
-    m_y_offset = other.m_y_offset;
-    m_translucent = other.m_translucent;
-    return *this;
-}
-
-TileData::TileData(const TileData& other) {
-    this->operator=(other);
-}
-
 TileData::TileData(int x_off, int y_off, int tile_num, bool translucent) : m_x_offset(x_off), m_y_offset(y_off), m_tile_number(tile_num), m_translucent(translucent) {
-
 }
 
 SingleGFXFileData::SingleGFXFileData(bool separate, int value) {
@@ -111,16 +43,6 @@ SingleGFXFileData::SingleGFXFileData(bool separate, int value) {
     m_separate = separate;
 }
 
-SingleGFXFileData::SingleGFXFileData(const SingleGFXFileData& data) {
-    m_value = data.m_value;
-    m_separate = data.m_separate;
-}
-
-SingleGFXFileData& SingleGFXFileData::operator=(const SingleGFXFileData& data) {
-    m_value = data.m_value;
-    m_separate = data.m_separate;
-    return *this;
-}
 SingleGFXFileData& SingleGFXFileData::operator=(const SingleGFXFile& data) {
     m_value = data.value;
     m_separate = data.separate;
@@ -140,31 +62,6 @@ void SingleGFXFileData::setSeparate(bool separate) {
     m_separate = separate;
 }
 
-QStandardItem* SingleGFXFileData::separateItem() const {
-    QStandardItem* item = new QStandardItem();
-    item->setCheckable(true);
-    item->setCheckState(m_separate ? Qt::Checked : Qt::Unchecked);
-    item->setFlags(Qt::ItemIsUserCheckable | Qt::ItemIsEnabled);
-    return item;
-}
-QStandardItem* SingleGFXFileData::valueItem() const {
-    auto* item = new QStandardItem(QString::asprintf("0x%X", m_value));
-    return item;
-}
-
-GFXInfoData::GFXInfoData(const GFXInfoData& data) {
-    m_sp0 = data.m_sp0;
-    m_sp1 = data.m_sp1;
-    m_sp2 = data.m_sp2;
-    m_sp3 = data.m_sp3;
-}
-GFXInfoData& GFXInfoData::operator=(const GFXInfoData& data) {
-    m_sp0 = data.m_sp0;
-    m_sp1 = data.m_sp1;
-    m_sp2 = data.m_sp2;
-    m_sp3 = data.m_sp3;
-    return *this;
-}
 GFXInfoData& GFXInfoData::operator=(const GFXInfo& data) {
     m_sp0 = data.sp0;
     m_sp1 = data.sp1;
@@ -201,38 +98,17 @@ void GFXInfoData::setSp3(SingleGFXFileData gfxdata) {
     m_sp3 = gfxdata;
 }
 
-QVector<QStandardItem*> GFXInfoData::itemsFromGFXInfo() const {
-    QVector<QStandardItem*> vec;
-    vec.append(m_sp0.valueItem());
-    vec.append(m_sp0.separateItem());
-    vec.append(m_sp1.valueItem());
-    vec.append(m_sp1.separateItem());
-    vec.append(m_sp2.valueItem());
-    vec.append(m_sp2.separateItem());
-    vec.append(m_sp3.valueItem());
-    vec.append(m_sp3.separateItem());
-    return vec;
-}
-
-GFXInfoData GFXInfoData::fromModel(QStandardItemModel* model, int row) {
-    GFXInfoData data{};
-    SingleGFXFileData sp0{};
-    sp0.setValue(model->item(row, 0)->text().toInt());
-    sp0.setSeparate(model->item(row, 1)->checkState() == Qt::Checked);
-    data.setSp0(sp0);
-    SingleGFXFileData sp1{};
-    sp1.setValue(model->item(row, 2)->text().toInt());
-    sp1.setSeparate(model->item(row, 3)->checkState() == Qt::Checked);
-    data.setSp0(sp1);
-    SingleGFXFileData sp2{};
-    sp2.setValue(model->item(row, 4)->text().toInt());
-    sp2.setSeparate(model->item(row, 5)->checkState() == Qt::Checked);
-    data.setSp0(sp2);
-    SingleGFXFileData sp3{};
-    sp3.setValue(model->item(row, 6)->text().toInt());
-    sp3.setSeparate(model->item(row, 7)->checkState() == Qt::Checked);
-    data.setSp0(sp3);
-    return data;
+const SingleGFXFileData& GFXInfoData::sp(int spnum) const {
+    switch (spnum) {
+    case 1:
+        return m_sp1;
+    case 2:
+        return m_sp2;
+    case 3:
+        return m_sp3;
+    default:
+        return m_sp0;
+    }
 }
 
 void DisplayData::setUseText(bool enabled) {
@@ -342,9 +218,9 @@ QPoint DisplayData::PosOrExtra() const {
     return QPoint(m_x_or_index, m_y_or_value);
 }
 
-
-DisplayData::DisplayData(const DisplayData& other) {
-    this->operator=(other);
+qint64 DisplayData::bytes() const {
+    return static_cast<qint64>(sizeof(DisplayData)) + m_tiles.capacity() * static_cast<qint64>(sizeof(TileData))
+           + (m_description.capacity() + m_display_text.capacity()) * static_cast<qint64>(sizeof(QChar));
 }
 
 DisplayData::DisplayData(const JSONDisplay& other) {
@@ -353,7 +229,7 @@ DisplayData::DisplayData(const JSONDisplay& other) {
     m_y_or_value = other.y_or_value;
     m_tiles.reserve(other.tiles.length());
     std::for_each(other.tiles.cbegin(), other.tiles.cend(), [&](const Tile& tile) {
-        m_tiles.append({tile.xoff, tile.yoff, tile.tilenumber, tile.translucent});
+        m_tiles.emplaceBack(tile.xoff, tile.yoff, tile.tilenumber, tile.translucent);
     });
     m_description = other.description;
     m_use_text = other.useText;
@@ -361,63 +237,311 @@ DisplayData::DisplayData(const JSONDisplay& other) {
     m_gfxinfo = other.gfxinfo;
 }
 
+DisplayData DisplayData::blankData() {
+    return DisplayData{};
+}
 
-DisplayData& DisplayData::operator=(const DisplayData& other) {
-    m_extra_bit = other.m_extra_bit;
-    m_x_or_index = other.m_x_or_index;
-    m_y_or_value = other.m_y_or_value;
-    m_tiles.clear();
-    m_tiles.reserve(other.m_tiles.size());
-    std::for_each(other.m_tiles.cbegin(), other.m_tiles.cend(), [&](const TileData& tile) {
-        m_tiles.append(tile);
-    });
-    m_description = other.m_description;
-    m_use_text = other.m_use_text;
-    m_display_text = other.m_display_text;
-    m_gfxinfo = other.m_gfxinfo;
-    return *this;
+CollectionTableModel::CollectionTableModel(QObject* parent) : QAbstractTableModel(parent) {
 }
 
-DisplayData::DisplayData() {
+int CollectionTableModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(m_collections.size());
+}
 
+int CollectionTableModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
 }
 
-DisplayData DisplayData::blankData() {
-    DisplayData data;
-    data.m_extra_bit = false;
-    data.m_x_or_index = 0;
-    data.m_y_or_value = 0;
-    data.m_tiles = QVector<TileData>();
-    data.m_use_text = false;
-    data.m_display_text = "";
-    data.m_description = "";
-    data.m_gfxinfo = GFXInfoData{};
-    return data;
-}
-DisplayData DisplayData::cloneData(QStandardItemModel* model, QStandardItemModel* gfxModel, const QString& description, int row, const QString& display_text) {
-    DisplayData data;
-    data.m_extra_bit = model->item(row, 0)->data().toBool();
-    data.m_x_or_index = model->item(row, 1)->data().toInt();
-    data.m_y_or_value = model->item(row, 2)->data().toInt();
-    data.m_description = description;
-    data.m_use_text = display_text.length() != 0;
-    data.m_display_text = display_text;
-    data.m_gfxinfo = GFXInfoData::fromModel(model, row);
-    return data;
-}
-
-QVector<QStandardItem*> DisplayData::itemsFromDisplay() const {
-    QVector<QStandardItem*> vec;
-    QStandardItem* item = new QStandardItem();
-    item->setCheckable(true);
-    item->setCheckState(m_extra_bit ? Qt::Checked : Qt::Unchecked);
-    item->setFlags(Qt::ItemIsEnabled);
-    vec.append(item);
-    auto* idx = new QStandardItem(QString::asprintf("%02X", m_x_or_index));
-    idx->setFlags(idx->flags() & (~Qt::ItemIsEditable));
-    auto* val = new QStandardItem(QString::asprintf("%02X", m_y_or_value));
-    val->setFlags(val->flags() & (~Qt::ItemIsEditable));
-    vec.append(idx);
-    vec.append(val);
-    return vec;
+QVariant CollectionTableModel::data(const QModelIndex& index, int role) const {
+    if (!checkIndex(index, CheckIndexOption::IndexIsValid))
+        return {};
+    const Collection& coll = m_collections[index.row()];
+    switch (index.column()) {
+    case Name:
+        if (role == Qt::DisplayRole || role == Qt::EditRole)
+            return coll.name;
+        break;
+    case ExtraBit:
+        if (role == Qt::CheckStateRole)
+            return coll.extrabit ? Qt::Checked : Qt::Unchecked;
+        break;
+    default:
+        if (role == Qt::DisplayRole || role == Qt::EditRole)
+            return QString::asprintf("%02X", coll.prop[index.column() - FirstByte]);
+        break;
+    }
+    return {};
+}
+
+QVariant CollectionTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return QAbstractTableModel::headerData(section, orientation, role);
+    if (section == Name)
+        return QStringLiteral("Name");
+    if (section == ExtraBit)
+        return QStringLiteral("Extra bit");
+    return QString::asprintf("Ex%d", section - FirstByte + 1);
+}
+
+Qt::ItemFlags CollectionTableModel::flags(const QModelIndex& index) const {
+    if (!index.isValid())
+        return Qt::NoItemFlags;
+    if (index.column() == ExtraBit)
+        return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsUserCheckable;
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsEditable;
+}
+
+bool CollectionTableModel::setData(const QModelIndex& index, const QVariant& value, int role) {
+    if (!checkIndex(index, CheckIndexOption::IndexIsValid))
+        return false;
+    Collection& coll = m_collections[index.row()];
+    switch (index.column()) {
+    case Name:
+        if (role != Qt::EditRole)
+            return false;
+        coll.name = value.toString();
+        break;
+    case ExtraBit:
+        if (role != Qt::CheckStateRole)
+            return false;
+        coll.extrabit = static_cast<Qt::CheckState>(value.toInt()) == Qt::Checked;
+        break;
+    default: {
+        if (role != Qt::EditRole)
+            return false;
+        bool ok = false;
+        uint byte = value.toString().toUInt(&ok, 16);
+        if (!ok || byte > 0xFF)
+            return false;
+        coll.prop[index.column() - FirstByte] = static_cast<uint8_t>(byte);
+        break;
+    }
+    }
+    emit dataChanged(index, index, {role});
+    return true;
+}
+
+bool CollectionTableModel::removeRows(int row, int count, const QModelIndex& parent) {
+    if (parent.isValid() || count <= 0 || row < 0 || row + count > m_collections.size())
+        return false;
+    beginRemoveRows({}, row, row + count - 1);
+    m_collections.remove(row, count);
+    endRemoveRows();
+    return true;
+}
+
+bool CollectionTableModel::moveRows(const QModelIndex& sourceParent, int sourceRow, int count, const QModelIndex& destinationParent, int destinationChild) {
+    if (sourceParent.isValid() || destinationParent.isValid() || count <= 0 || sourceRow < 0 || sourceRow + count > m_collections.size()
+        || destinationChild < 0 || destinationChild > m_collections.size())
+        return false;
+    if (!beginMoveRows({}, sourceRow, sourceRow + count - 1, {}, destinationChild))
+        return false;
+    moveItems(m_collections, sourceRow, count, destinationChild);
+    endMoveRows();
+    return true;
+}
+
+const QVector<Collection>& CollectionTableModel::collections() const {
+    return m_collections;
+}
+
+void CollectionTableModel::setCollections(QVector<Collection> collections) {
+    if (!m_collections.isEmpty())
+        removeRows(0, static_cast<int>(m_collections.size()));
+    if (collections.isEmpty())
+        return;
+    beginInsertRows({}, 0, static_cast<int>(collections.size()) - 1);
+    m_collections = std::move(collections);
+    endInsertRows();
+}
+
+void CollectionTableModel::insertCollection(int row, const Collection& collection) {
+    row = qBound(0, row, static_cast<int>(m_collections.size()));
+    beginInsertRows({}, row, row);
+    m_collections.insert(row, collection);
+    endInsertRows();
+}
+
+void CollectionTableModel::appendCollection(const Collection& collection) {
+    insertCollection(static_cast<int>(m_collections.size()), collection);
+}
+
+DisplayTableModel::DisplayTableModel(QObject* parent) : QAbstractTableModel(parent) {
+}
+
+int DisplayTableModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(m_displays.size());
+}
+
+int DisplayTableModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant DisplayTableModel::data(const QModelIndex& index, int role) const {
+    if (!checkIndex(index, CheckIndexOption::IndexIsValid))
+        return {};
+    const DisplayData& d = m_displays[index.row()];
+    const int column = index.column();
+    if (column == ExtraBit) {
+        if (role == Qt::CheckStateRole)
+            return d.ExtraBit() ? Qt::Checked : Qt::Unchecked;
+        return {};
+    }
+    if (column == XOrIndex || column == YOrValue) {
+        const int value = column == XOrIndex ? d.XOrIndex() : d.YOrValue();
+        if (role == Qt::DisplayRole)
+            return QString::asprintf("%02X", value);
+        if (role == Qt::EditRole)
+            return value;
+        return {};
+    }
+    const SingleGFXFileData& file = d.GFXInfo().sp((column - Sp0) / 2);
+    if (isSeparateColumn(column)) {
+        if (role == Qt::CheckStateRole)
+            return file.Separate() ? Qt::Checked : Qt::Unchecked;
+        return {};
+    }
+    if (role == Qt::DisplayRole)
+        return QString::asprintf("0x%X", file.Value());
+    if (role == Qt::EditRole)
+        return QString::asprintf("%X", file.Value());
+    return {};
+}
+
+QVariant DisplayTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return QAbstractTableModel::headerData(section, orientation, role);
+    switch (section) {
+    case ExtraBit:
+        return QStringLiteral("ExtraBit");
+    case XOrIndex:
+        return m_extraByteLabels ? QStringLiteral("Index") : QStringLiteral("X");
+    case YOrValue:
+        return m_extraByteLabels ? QStringLiteral("Value") : QStringLiteral("Y");
+    default:
+        if (isSeparateColumn(section))
+            return QStringLiteral("Sep.");
+        return QString::asprintf("Sp%d", (section - Sp0) / 2);
+    }
+}
+
+Qt::ItemFlags DisplayTableModel::flags(const QModelIndex& index) const {
+    if (!index.isValid())
+        return Qt::NoItemFlags;
+    // the extra bit, X and Y are edited in the panel next to the table
+    if (index.column() == ExtraBit)
+        return Qt::ItemIsEnabled;
+    if (isSeparateColumn(index.column()))
+        return Qt::ItemIsEnabled | Qt::ItemIsUserCheckable;
+    if (isGFXColumn(index.column()))
+        return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsEditable;
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+}
+
+bool DisplayTableModel::setData(const QModelIndex& index, const QVariant& value, int role) {
+    if (!checkIndex(index, CheckIndexOption::IndexIsValid))
+        return false;
+    DisplayData& d = m_displays[index.row()];
+    const int column = index.column();
+    const bool checked = static_cast<Qt::CheckState>(value.toInt()) == Qt::Checked;
+    if (column == ExtraBit) {
+        if (role != Qt::CheckStateRole)
+            return false;
+        d.setExtraBit(checked);
+    } else if (column == XOrIndex || column == YOrValue) {
+        bool ok = false;
+        const int v = value.toInt(&ok);
+        if (role != Qt::EditRole || !ok)
+            return false;
+        if (column == XOrIndex)
+            d.setXOrIndex(v);
+        else
+            d.setYOrValue(v);
+    } else if (isSeparateColumn(column)) {
+        if (role != Qt::CheckStateRole)
+            return false;
+        d.setSeparate(checked, (column - Sp0) / 2);
+    } else {
+        if (role != Qt::EditRole)
+            return false;
+        // hex, with or without 0x
+        const QString str = value.toString().trimmed();
+        bool ok = false;
+        const int v = str.startsWith(QStringLiteral("0x"), Qt::CaseInsensitive) ? QStringView{str}.mid(2).toInt(&ok, 16) : str.toInt(&ok, 16);
+        if (!ok)
+            return false;
+        d.setGfxInfoValue(v, (column - Sp0) / 2);
+    }
+    emit dataChanged(index, index, {Qt::DisplayRole, Qt::EditRole, Qt::CheckStateRole});
+    return true;
+}
+
+bool DisplayTableModel::removeRows(int row, int count, const QModelIndex& parent) {
+    if (parent.isValid() || count <= 0 || row < 0 || row + count > m_displays.size())
+        return false;
+    beginRemoveRows({}, row, row + count - 1);
+    m_displays.remove(row, count);
+    endRemoveRows();
+    updateMemory();
+    return true;
+}
+
+bool DisplayTableModel::moveRows(const QModelIndex& sourceParent, int sourceRow, int count, const QModelIndex& destinationParent, int destinationChild) {
+    if (sourceParent.isValid() || destinationParent.isValid() || count <= 0 || sourceRow < 0 || sourceRow + count > m_displays.size()
+        || destinationChild < 0 || destinationChild > m_displays.size())
+        return false;
+    if (!beginMoveRows({}, sourceRow, sourceRow + count - 1, {}, destinationChild))
+        return false;
+    moveItems(m_displays, sourceRow, count, destinationChild);
+    endMoveRows();
+    return true;
+}
+
+void DisplayTableModel::setExtraByteLabels(bool extraByte) {
+    if (m_extraByteLabels == extraByte)
+        return;
+    m_extraByteLabels = extraByte;
+    emit headerDataChanged(Qt::Horizontal, XOrIndex, YOrValue);
+}
+
+const QVector<DisplayData>& DisplayTableModel::displays() const {
+    return m_displays;
+}
+
+const DisplayData& DisplayTableModel::display(int row) const {
+    return m_displays[row];
+}
+
+DisplayData& DisplayTableModel::editDisplay(int row) {
+    return m_displays[row];
+}
+
+QVector<DisplayData>& DisplayTableModel::editDisplays() {
+    return m_displays;
+}
+
+void DisplayTableModel::setDisplays(QVector<DisplayData> displays) {
+    if (!m_displays.isEmpty())
+        removeRows(0, static_cast<int>(m_displays.size()));
+    if (!displays.isEmpty()) {
+        beginInsertRows({}, 0, static_cast<int>(displays.size()) - 1);
+        m_displays = std::move(displays);
+        endInsertRows();
+    }
+    updateMemory();
+}
+
+void DisplayTableModel::insertDisplay(int row, DisplayData display) {
+    row = qBound(0, row, static_cast<int>(m_displays.size()));
+    beginInsertRows({}, row, row);
+    m_displays.insert(row, std::move(display));
+    endInsertRows();
+    updateMemory();
+}
+
+void DisplayTableModel::updateMemory() {
+    qint64 bytes = m_displays.capacity() * static_cast<qint64>(sizeof(DisplayData));
+    for (auto& d : m_displays)
+        bytes += d.bytes() - static_cast<qint64>(sizeof(DisplayData));
+    m_memory.update(bytes);
 }
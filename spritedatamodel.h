@@ -1,41 +1,23 @@
 #ifndef COLLECTIONDATAMODEL_H
 #define COLLECTIONDATAMODEL_H
 
-#include <QTableView>
-#include <QStandardItemModel>
+#include <QAbstractTableModel>
 #include "jsonsprite.h"
+#include "memoryaccounting.h"
+#include <type_traits>
 
-class CollectionDataModel
-{
+// The display data below are plain values: the editor keeps them in QVectors and copies them freely (clones,
+// the unsaved changes check), so they carry no QObject and no hand written copies. Edits are announced by
+// CFGEditor's models and the ModificationTracker, not by the values themselves.
+class TileData {
 private:
-    uint8_t m_bytes[12];
-    QString m_name;
-    bool m_extrabit;
-public:
-    CollectionDataModel();
-    const QString& name();
-    uint8_t byte(int index);
-    bool extrabit();
-    void setName(const QString& name);
-    void setByte(uint8_t data, int index);
-    void setBytes(const uint8_t* data);
-    void setExtraBit(bool bit);
-    QVector<QStandardItem*> getRow(void* ui = nullptr);
-    static CollectionDataModel fromRow(const QVector<QStandardItem*>& row);
-    static CollectionDataModel fromIndex(int index, QTableView* view);
-    static QVector<QStandardItem*> fromCollection(const Collection& coll);
-};
-
-class TileData : QObject {
-    Q_OBJECT
-private:
-    int m_x_offset;
-    int m_y_offset;
-    int m_tile_number;
-    bool m_translucent;
+    int m_x_offset = 0;
+    int m_y_offset = 0;
+    int m_tile_number = 0;
+    bool m_translucent = false;
 public:
+    TileData() = default;
     TileData(int x_off, int y_off, int tile_num, bool translucent);
-    TileData(const TileData& other);
     void setXOffset(int x);
     void setYOffset(int y);
     void setOffset(int x, int y);
@@ -46,13 +28,9 @@ public:
     QPoint Offset() const;
     int TileNumber() const;
     bool Translucent() const;
-    TileData& operator=(const TileData& other);
-signals:
 };
 
-class SingleGFXFileData : QObject {
-    Q_OBJECT
-
+class SingleGFXFileData {
 private:
     int m_value{0x7f};
     bool m_separate{false};
@@ -60,20 +38,14 @@ private:
 public:
     SingleGFXFileData() = default;
     SingleGFXFileData(bool separate, int value);
-    SingleGFXFileData(const SingleGFXFileData&);
-    SingleGFXFileData& operator=(const SingleGFXFileData&);
     SingleGFXFileData& operator=(const SingleGFXFile& data);
     int Value() const;
     bool Separate() const;
     void setValue(int value);
     void setSeparate(bool separate);
-    QStandardItem* separateItem() const;
-    QStandardItem* valueItem() const;
 };
 
-class GFXInfoData : QObject {
-    Q_OBJECT
-
+class GFXInfoData {
 private:
     SingleGFXFileData m_sp0{};
     SingleGFXFileData m_sp1{};
@@ -81,8 +53,6 @@ private:
     SingleGFXFileData m_sp3{};
 public:
     GFXInfoData() = default;
-    GFXInfoData(const GFXInfoData&);
-    GFXInfoData& operator=(const GFXInfoData&);
     GFXInfoData& operator=(const GFXInfo&);
     const SingleGFXFileData& sp0() const;
     const SingleGFXFileData& sp1() const;
@@ -92,27 +62,23 @@ public:
     void setSp1(SingleGFXFileData gfxdata);
     void setSp2(SingleGFXFileData gfxdata);
     void setSp3(SingleGFXFileData gfxdata);
-    QVector<QStandardItem*> itemsFromGFXInfo() const;
-    static GFXInfoData fromModel(QStandardItemModel* model, int row);
+    // SP0 to SP3 by number
+    const SingleGFXFileData& sp(int spnum) const;
 };
 
-class DisplayData : QObject {
-    Q_OBJECT
-
+class DisplayData {
 private:
-    bool m_use_text;
-    bool m_extra_bit;
+    bool m_use_text = false;
+    bool m_extra_bit = false;
     QVector<TileData> m_tiles;
     QString m_description;
     QString m_display_text;
-    int m_x_or_index;
-    int m_y_or_value;
+    int m_x_or_index = 0;
+    int m_y_or_value = 0;
     GFXInfoData m_gfxinfo;
-    DisplayData();
 public:
-    DisplayData& operator=(const DisplayData& other);
-    DisplayData(const DisplayData& other);
-    DisplayData(const JSONDisplay& other);
+    DisplayData() = default;
+    explicit DisplayData(const JSONDisplay& other);
     void setUseText(bool enabled);
     void setExtraBit(bool enabled);
     void setDescription(const QString& description);
@@ -136,13 +102,106 @@ public:
     int XOrIndex() const;
     int YOrValue() const;
     QPoint PosOrExtra() const;
+    // heap and inline bytes held by this display, reported to MemoryAccounting by whoever owns the displays
+    qint64 bytes() const;
 
     static DisplayData blankData();
-    static DisplayData cloneData(QStandardItemModel* model, QStandardItemModel* gfxModel, const QString& description, int row, const QString& display_text);
-    QVector<QStandardItem*> itemsFromDisplay() const;
-signals:
+};
+
+// tiles and GFX info are copied with memcpy, displays are moved with memmove when QVector grows or inserts
+static_assert(std::is_trivially_copyable_v<TileData>);
+static_assert(std::is_trivially_copyable_v<GFXInfoData>);
+Q_DECLARE_TYPEINFO(TileData, Q_PRIMITIVE_TYPE);
+// not primitive, a zero filled GFX file isn't the default one
+Q_DECLARE_TYPEINFO(SingleGFXFileData, Q_RELOCATABLE_TYPE);
+Q_DECLARE_TYPEINFO(GFXInfoData, Q_RELOCATABLE_TYPE);
+Q_DECLARE_TYPEINFO(DisplayData, Q_RELOCATABLE_TYPE);
 
+// The collection table: name, extra bit and the 12 extra property bytes of every collection, kept as the
+// Collections the sprite saves.
+class CollectionTableModel : public QAbstractTableModel {
+    Q_OBJECT
+public:
+    enum Column {
+        Name,
+        ExtraBit,
+        FirstByte,
+        ColumnCount = FirstByte + 12
+    };
+    explicit CollectionTableModel(QObject* parent = nullptr);
+    int rowCount(const QModelIndex& parent = {}) const override;
+    int columnCount(const QModelIndex& parent = {}) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+    bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole) override;
+    bool removeRows(int row, int count, const QModelIndex& parent = {}) override;
+    bool moveRows(const QModelIndex& sourceParent, int sourceRow, int count, const QModelIndex& destinationParent, int destinationChild) override;
 
+    const QVector<Collection>& collections() const;
+    // replaces every row, announced as one removal and one insertion so the views keep their column setup
+    void setCollections(QVector<Collection> collections);
+    void insertCollection(int row, const Collection& collection);
+    void appendCollection(const Collection& collection);
+private:
+    QVector<Collection> m_collections;
+};
+
+// The displays of the sprite. The display table shows the extra bit and X/Y (or extra byte index and value) columns,
+// the GFX table the four GFX files; both tables view this one model with the other columns hidden, so every display
+// is stored once. Columns shown by a table change through setData, the rest of a display (tiles, texts, description)
+// is edited in place through editDisplay.
+class DisplayTableModel : public QAbstractTableModel {
+    Q_OBJECT
+public:
+    enum Column {
+        ExtraBit,
+        XOrIndex,
+        YOrValue,
+        Sp0,
+        Sp0Separate,
+        Sp1,
+        Sp1Separate,
+        Sp2,
+        Sp2Separate,
+        Sp3,
+        Sp3Separate,
+        ColumnCount
+    };
+    static bool isGFXColumn(int column) {
+        return column >= Sp0;
+    }
+    static bool isSeparateColumn(int column) {
+        return isGFXColumn(column) && (column - Sp0) % 2 == 1;
+    }
+    explicit DisplayTableModel(QObject* parent = nullptr);
+    int rowCount(const QModelIndex& parent = {}) const override;
+    int columnCount(const QModelIndex& parent = {}) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+    bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole) override;
+    bool removeRows(int row, int count, const QModelIndex& parent = {}) override;
+    // the tiles Map16Provider holds for the displays have to be moved along, see rowsMoved
+    bool moveRows(const QModelIndex& sourceParent, int sourceRow, int count, const QModelIndex& destinationParent, int destinationChild) override;
+
+    // X and Y, or Index and Value for extra byte displays
+    void setExtraByteLabels(bool extraByte);
+    const QVector<DisplayData>& displays() const;
+    const DisplayData& display(int row) const;
+    // for the fields no column shows, nothing is announced
+    DisplayData& editDisplay(int row);
+    // same for every display at once, e.g. to store the tiles Map16Provider holds
+    QVector<DisplayData>& editDisplays();
+    // replaces every row, announced as one removal and one insertion so the views keep their hidden columns
+    void setDisplays(QVector<DisplayData> displays);
+    void insertDisplay(int row, DisplayData display);
+    // reports the displays to MemoryAccounting, done on every row change and after editing in place
+    void updateMemory();
+private:
+    QVector<DisplayData> m_displays;
+    bool m_extraByteLabels = false;
+    MemoryAccount m_memory{MemoryAccounting::DisplayData};
 };
 
 #endif // COLLECTIONDATAMODEL_H
@@ -0,0 +1,430 @@
+#include "spritelinter.h"
+#include "headlesstool.h"
+#include "jsonsprite.h"
+#include <QBuffer>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QThreadPool>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+using namespace HeadlessTool;
+
+namespace {
+// first tile number that lives in the sprite's own Map16 data instead of the built-in pages
+constexpr int FirstCustomMap16Tile = 0x300;
+constexpr qsizetype BytesPerMap16Tile = 8;
+
+class Lint {
+public:
+    explicit Lint(QVector<SpriteLinter::Issue>& issues) : m_issues(issues) {}
+    void add(const char* check, const QString& location, const QString& message) {
+        m_issues.append({check, location, message});
+    }
+    static bool isInteger(const QJsonValue& v) {
+        return v.isDouble() && std::floor(v.toDouble()) == v.toDouble();
+    }
+    // members are optional, only present ones of the wrong type or out of range are reported
+    void checkInt(const QJsonObject& o, const QString& key, const QString& location, int min, int max) {
+        auto v = o.value(key);
+        if (v.isUndefined())
+            return;
+        if (!isInteger(v)) {
+            add("malformed", location, key + " is not an integer");
+            return;
+        }
+        double d = v.toDouble();
+        if (d < min || d > max)
+            add("range", location, key + QString::asprintf(" is %g, expected %d to %d", d, min, max));
+    }
+    void checkBool(const QJsonObject& o, const QString& key, const QString& location) {
+        auto v = o.value(key);
+        if (!v.isUndefined() && !v.isBool())
+            add("malformed", location, key + " is not a boolean");
+    }
+    void checkString(const QJsonObject& o, const QString& key, const QString& location) {
+        auto v = o.value(key);
+        if (!v.isUndefined() && !v.isString())
+            add("malformed", location, key + " is not a string");
+    }
+    QJsonArray array(const QJsonObject& o, const QString& key, const QString& location) {
+        auto v = o.value(key);
+        if (!v.isUndefined() && !v.isArray())
+            add("malformed", location, key + " is not an array");
+        return v.toArray();
+    }
+    QJsonObject object(const QJsonValue& v, const QString& location) {
+        if (!v.isObject())
+            add("malformed", location, "expected an object");
+        return v.toObject();
+    }
+private:
+    QVector<SpriteLinter::Issue>& m_issues;
+};
+
+// a tweak object is in range if it survives being packed into its byte, anything that doesn't was masked off on load
+template <typename T>
+void lintTweak(Lint& lint, const QJsonObject& root, const QString& key) {
+    auto v = root.value(key);
+    if (v.isUndefined())
+        return;
+    if (!v.isObject()) {
+        lint.add("malformed", key, "expected an object");
+        return;
+    }
+    auto o = v.toObject();
+    T loaded{};
+    loaded.from_json(o);
+    T packed{};
+    packed.from_byte(loaded.to_byte());
+    auto expected = packed.to_json();
+    for (auto it = expected.constBegin(); it != expected.constEnd(); ++it) {
+        auto actual = o.value(it.key());
+        if (actual.isUndefined())
+            continue;
+        if (actual.type() != it.value().type() || (actual.isDouble() && !Lint::isInteger(actual)))
+            lint.add("malformed", key, it.key() + " has the wrong type");
+        else if (actual != it.value())
+            lint.add("tweak-range", key, it.key() + QString::asprintf(" is %g but only %g fits in the tweak byte", actual.toDouble(), it.value().toDouble()));
+    }
+}
+
+void lintMap16(Lint& lint, const QJsonObject& root, QByteArray& map16) {
+    auto v = root.value("Map16");
+    if (!v.isString())
+        return;
+    auto decoded = QByteArray::fromBase64Encoding(v.toString().toLatin1(), QByteArray::AbortOnBase64DecodingErrors);
+    if (!decoded) {
+        lint.add("map16", "Map16", "not valid base64");
+        return;
+    }
+    map16 = *decoded;
+    if (map16.size() % BytesPerMap16Tile != 0)
+        lint.add("map16", "Map16", QString::asprintf("decodes to %lld bytes, not a whole number of 8 byte tiles", static_cast<long long>(map16.size())));
+}
+
+bool isEmptyMap16Tile(const QByteArray& map16, int tilenumber) {
+    qsizetype offset = (tilenumber - FirstCustomMap16Tile) * BytesPerMap16Tile;
+    if (offset + BytesPerMap16Tile > map16.size())
+        return true;
+    return std::all_of(map16.cbegin() + offset, map16.cbegin() + offset + BytesPerMap16Tile, [](char c) { return c == 0; });
+}
+
+void lintDisplays(Lint& lint, const QJsonObject& root, const QByteArray& map16) {
+    auto type = root.value("DisplayType");
+    if (!type.isUndefined() && type != QJsonValue{"XY"} && type != QJsonValue{"ExByte"})
+        lint.add("malformed", "DisplayType", "expected \"XY\" or \"ExByte\"");
+    bool exbyte = type == QJsonValue{"ExByte"};
+    auto displays = lint.array(root, "Displays", "Displays");
+    for (qsizetype i = 0; i < displays.size(); i++) {
+        auto location = QString::asprintf("Displays[%lld]", static_cast<long long>(i));
+        auto d = lint.object(displays[i], location);
+        lint.checkString(d, "Description", location);
+        lint.checkString(d, "DisplayText", location);
+        lint.checkBool(d, "ExtraBit", location);
+        lint.checkBool(d, "UseText", location);
+        if (exbyte) {
+            lint.checkInt(d, "Index", location, 0, 12);
+            lint.checkInt(d, "Value", location, 0, 0xFF);
+        } else {
+            lint.checkInt(d, "X", location, 0, 0x0F);
+            lint.checkInt(d, "Y", location, 0, 0x0F);
+        }
+        auto gfx = d.value("GFXInfo");
+        if (!gfx.isUndefined()) {
+            auto info = lint.object(gfx, location + ".GFXInfo");
+            for (auto it = info.constBegin(); it != info.constEnd(); ++it) {
+                auto fileLocation = location + ".GFXInfo." + it.key();
+                auto file = lint.object(it.value(), fileLocation);
+                lint.checkBool(file, "Separate", fileLocation);
+                lint.checkInt(file, "Value", fileLocation, 0, 0xFFF);
+            }
+        }
+        bool useText = d.value("UseText").toBool();
+        auto tiles = lint.array(d, "Tiles", location);
+        for (qsizetype j = 0; j < tiles.size(); j++) {
+            auto tileLocation = location + QString::asprintf(".Tiles[%lld]", static_cast<long long>(j));
+            auto t = lint.object(tiles[j], tileLocation);
+            lint.checkInt(t, "X offset", tileLocation, INT_MIN, INT_MAX);
+            lint.checkInt(t, "Y offset", tileLocation, INT_MIN, INT_MAX);
+            lint.checkInt(t, "map16 tile", tileLocation, 0, 0xFFFF);
+            lint.checkBool(t, "Translucent", tileLocation);
+            int raw = t.value("map16 tile").toInt();
+            Tile tile{0, 0, raw, false};
+            tile.foldTranslucency();
+            if (tile.tilenumber != raw)
+                lint.add("translucency-bits", tileLocation, QString::asprintf("map16 tile 0x%X carries the old translucency bits, it's read as tile 0x%X", raw, tile.tilenumber));
+            // text displays only carry a placeholder tile
+            if (!useText && tile.tilenumber >= FirstCustomMap16Tile && isEmptyMap16Tile(map16, tile.tilenumber))
+                lint.add("empty-map16-tile", tileLocation, QString::asprintf("map16 tile 0x%X is empty in this sprite's Map16", tile.tilenumber));
+        }
+    }
+}
+
+void lintCollections(Lint& lint, const QJsonObject& root) {
+    auto collections = lint.array(root, "Collection", "Collection");
+    for (qsizetype i = 0; i < collections.size(); i++) {
+        auto location = QString::asprintf("Collection[%lld]", static_cast<long long>(i));
+        auto c = lint.object(collections[i], location);
+        lint.checkString(c, "Name", location);
+        lint.checkBool(c, "ExtraBit", location);
+        for (int j = 1; j <= 12; j++)
+            lint.checkInt(c, QString::asprintf("Extra Property Byte %d", j), location, 0, 0xFF);
+    }
+}
+
+// false if the file couldn't be parsed at all, the round trip check is pointless then
+bool lintJson(Lint& lint, const QByteArray& data) {
+    QJsonParseError parseError{};
+    auto doc = QJsonDocument::fromJson(data, &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        lint.add("malformed", QString::asprintf("offset %d", parseError.offset), parseError.errorString());
+        return false;
+    }
+    if (!doc.isObject()) {
+        lint.add("malformed", {}, "the top level value is not an object");
+        return false;
+    }
+    auto root = doc.object();
+    lintTweak<J1656>(lint, root, "$1656");
+    lintTweak<J1662>(lint, root, "$1662");
+    lintTweak<J166E>(lint, root, "$166E");
+    lintTweak<J167A>(lint, root, "$167A");
+    lintTweak<J1686>(lint, root, "$1686");
+    lintTweak<J190F>(lint, root, "$190F");
+    lint.checkString(root, "AsmFile", {});
+    lint.checkInt(root, "ActLike", {}, 0, 0xFF);
+    lint.checkInt(root, "Type", {}, 0, 3);
+    lint.checkInt(root, "Extra Property Byte 1", {}, 0, 0xFF);
+    lint.checkInt(root, "Extra Property Byte 2", {}, 0, 0xFF);
+    lint.checkInt(root, "Additional Byte Count (extra bit clear)", {}, 0, 12);
+    lint.checkInt(root, "Additional Byte Count (extra bit set)", {}, 0, 12);
+    lint.checkString(root, "Map16", {});
+    QByteArray map16;
+    lintMap16(lint, root, map16);
+    lintDisplays(lint, root, map16);
+    lintCollections(lint, root);
+    return true;
+}
+
+bool lintCfg(Lint& lint, const QByteArray& data) {
+    auto lines = data.split('\n');
+    auto line = [&](int i) -> QByteArray {
+        return i < lines.size() ? lines[i].trimmed() : QByteArray{};
+    };
+    auto hexByte = [&](const QByteArray& text, int lineNo, const char* what, int max, const char* rangeCheck) {
+        bool ok = false;
+        int v = text.toInt(&ok, 16);
+        if (!ok)
+            lint.add("malformed", QString::asprintf("line %d", lineNo), QString::asprintf("%s is not a hex number", what));
+        else if (v > max)
+            lint.add(rangeCheck, QString::asprintf("line %d", lineNo), QString::asprintf("%s is %X, at most %X fits", what, v, max));
+    };
+    if (lines.size() < 5) {
+        lint.add("malformed", {}, "a CFG needs at least 5 lines");
+        return false;
+    }
+    hexByte(line(0), 1, "the type", 3, "range");
+    hexByte(line(1), 2, "the acts like setting", 0xFF, "range");
+    auto tweaks = line(2).simplified().split(' ');
+    static constexpr const char* tweakNames[]{"$1656", "$1662", "$166E", "$167A", "$1686", "$190F"};
+    if (tweaks.size() != 6) {
+        lint.add("malformed", "line 3", "expected 6 tweak bytes");
+        return false;
+    }
+    for (qsizetype i = 0; i < tweaks.size(); i++)
+        hexByte(tweaks[i], 3, tweakNames[i], 0xFF, "tweak-range");
+    auto props = line(3).simplified().split(' ');
+    if (props.size() != 2) {
+        lint.add("malformed", "line 4", "expected 2 extra property bytes");
+        return false;
+    }
+    hexByte(props[0], 4, "extra property byte 1", 0xFF, "range");
+    hexByte(props[1], 4, "extra property byte 2", 0xFF, "range");
+    if (line(4).isEmpty())
+        lint.add("malformed", "line 5", "no asm file");
+    // the byte counts are optional, older CFGs don't have them
+    if (!line(5).isEmpty()) {
+        auto counts = line(5).split(':');
+        if (counts.size() != 2) {
+            lint.add("malformed", "line 6", "expected the extra byte counts as XX:XX");
+        } else {
+            hexByte(counts[0], 6, "the extra byte count (extra bit clear)", 12, "range");
+            hexByte(counts[1], 6, "the extra byte count (extra bit set)", 12, "range");
+        }
+    }
+    return true;
+}
+
+void lintRoundTrip(Lint& lint, const QString& path) {
+    JsonSprite loaded;
+    QString error;
+    if (!loaded.load_file(path, error)) {
+        lint.add("malformed", {}, error);
+        return;
+    }
+    QByteArray text = loaded.to_text(path, false);
+    JsonSprite reloaded;
+    if (path.endsWith(".cfg")) {
+        QBuffer buffer{&text};
+        buffer.open(QIODevice::ReadOnly);
+        if (!reloaded.deserialize_cfg(buffer, error)) {
+            lint.add("round-trip", {}, "the saved CFG can't be read back: " + error);
+            return;
+        }
+    } else if (!reloaded.deserialize_stream(text)) {
+        lint.add("round-trip", {}, "the saved JSON can't be read back");
+        return;
+    }
+    // the asm file name keeps the line ending when read from a CFG and is always trimmed when written
+    loaded.asmfile = loaded.asmfile.trimmed();
+    reloaded.asmfile = reloaded.asmfile.trimmed();
+    if (loaded.tweaks_hash() != reloaded.tweaks_hash())
+        lint.add("round-trip", {}, "tweaks or sprite properties change when the file is saved again");
+    if (loaded.displays_hash() != reloaded.displays_hash())
+        lint.add("round-trip", "Displays", "displays change when the file is saved again");
+    if (loaded.collections_hash() != reloaded.collections_hash())
+        lint.add("round-trip", "Collection", "collections change when the file is saved again");
+    if (loaded.map16_hash() != reloaded.map16_hash())
+        lint.add("round-trip", "Map16", "the Map16 changes when the file is saved again");
+}
+
+QStringList collectSprites(const QStringList& paths) {
+    QStringList files;
+    for (auto& path : paths) {
+        QFileInfo info{path};
+        if (!info.isDir()) {
+            files.append(path);
+            continue;
+        }
+        files.append(findFiles(path, {"*.json", "*.cfg"}));
+    }
+    // the same file can be given twice, directly and inside a directory
+    std::sort(files.begin(), files.end());
+    files.erase(std::unique(files.begin(), files.end()), files.end());
+    return files;
+}
+}
+
+bool SpriteLinter::requested(int argc, char* argv[]) {
+    return hasFlag(argc, argv, "--lint");
+}
+
+int SpriteLinter::run(const QStringList& arguments) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Checks every sprite under the given paths and prints a JSON report.");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"lint", "File or directory to check, can be given more than once.", "path"},
+        {"report", "Write the report to this file instead of stdout.", "file"},
+        {"jobs", "Number of worker threads, defaults to the number of cores.", "n"},
+    });
+    parser.addPositionalArgument("paths", "More files or directories to check.", "[paths...]");
+    if (!parser.parse(arguments)) {
+        QTextStream(stderr) << parser.errorText() << '\n';
+        return ExitUsage;
+    }
+    if (parser.isSet("help")) {
+        QTextStream(stdout) << parser.helpText();
+        return ExitOk;
+    }
+    int jobs = 0;
+    if (parser.isSet("jobs")) {
+        bool ok = false;
+        jobs = parser.value("jobs").toInt(&ok);
+        if (!ok || jobs < 1) {
+            QTextStream(stderr) << "--jobs expects a positive number\n";
+            return ExitUsage;
+        }
+    }
+    auto paths = parser.values("lint") + parser.positionalArguments();
+
+    QElapsedTimer timer;
+    timer.start();
+    auto files = lintPaths(paths, jobs);
+    auto json = report(files, timer.elapsed());
+
+    if (parser.isSet("report")) {
+        QString error;
+        if (!writeAtomically(parser.value("report"), json, error)) {
+            QTextStream(stderr) << "Could not write " << parser.value("report") << ": " << error << '\n';
+            return ExitUsage;
+        }
+    } else {
+        QTextStream(stdout) << json;
+    }
+    bool clean = std::all_of(files.cbegin(), files.cend(), [](const FileReport& f) { return f.issues.isEmpty(); });
+    return clean ? ExitOk : ExitFailures;
+}
+
+QVector<SpriteLinter::FileReport> SpriteLinter::lintPaths(const QStringList& paths, int jobs) {
+    auto files = collectSprites(paths);
+    // every task writes its own slot, the report comes out in path order whatever the scheduling
+    QVector<FileReport> reports(files.size());
+    QThreadPool pool;
+    if (jobs > 0)
+        pool.setMaxThreadCount(jobs);
+    for (qsizetype i = 0; i < files.size(); i++) {
+        pool.start([&, i]() {
+            reports[i] = lintFile(files[i]);
+        });
+    }
+    pool.waitForDone();
+    return reports;
+}
+
+SpriteLinter::FileReport SpriteLinter::lintFile(const QString& path) {
+    FileReport report{path, {}};
+    Lint lint{report.issues};
+    QFile file{path};
+    if (!file.open(QFile::OpenModeFlag::ReadOnly)) {
+        lint.add("io", {}, file.errorString());
+        return report;
+    }
+    auto data = file.readAll();
+    bool parsed = false;
+    if (path.endsWith(".json")) {
+        parsed = lintJson(lint, data);
+    } else if (path.endsWith(".cfg")) {
+        parsed = lintCfg(lint, data);
+    } else {
+        lint.add("io", {}, "Unrecognized file extension, valid extensions are: .cfg, .json");
+    }
+    if (parsed)
+        lintRoundTrip(lint, path);
+    return report;
+}
+
+QByteArray SpriteLinter::report(const QVector<FileReport>& files, qint64 elapsedMs) {
+    QJsonArray fileArr{};
+    qsizetype issueCount = 0;
+    for (auto& f : files) {
+        if (f.issues.isEmpty())
+            continue;
+        QJsonArray issueArr{};
+        for (auto& issue : f.issues) {
+            QJsonObject o{};
+            o["check"] = issue.check;
+            o["location"] = issue.location;
+            o["message"] = issue.message;
+            issueArr.append(o);
+        }
+        issueCount += f.issues.size();
+        QJsonObject o{};
+        o["path"] = f.path;
+        o["issues"] = issueArr;
+        fileArr.append(o);
+    }
+    QJsonObject summary{};
+    summary["files"] = files.size();
+    summary["filesWithIssues"] = fileArr.size();
+    summary["issues"] = issueCount;
+    summary["elapsedMs"] = elapsedMs;
+    QJsonObject root{};
+    root["files"] = fileArr;
+    root["summary"] = summary;
+    return QJsonDocument{root}.toJson(QJsonDocument::Indented);
+}
@@ -0,0 +1,32 @@
+#ifndef SPRITELINTER_H
+#define SPRITELINTER_H
+
+#include <QByteArray>
+#include <QStringList>
+#include <QVector>
+
+// Headless validation of sprite folders, started with --lint.
+// Every .json/.cfg is checked on a worker pool and the problems are written out as a JSON report.
+class SpriteLinter
+{
+public:
+    struct Issue {
+        // short machine readable name of the check, e.g. "tweak-range"
+        QString check;
+        // where in the file, e.g. "Displays[2].Tiles[0]" or "line 3"
+        QString location;
+        QString message;
+    };
+    struct FileReport {
+        QString path;
+        QVector<Issue> issues;
+    };
+    static bool requested(int argc, char* argv[]);
+    static int run(const QStringList& arguments);
+    // paths can be files or directories (searched recursively), the result is sorted by path
+    static QVector<FileReport> lintPaths(const QStringList& paths, int jobs = 0);
+    static FileReport lintFile(const QString& path);
+    static QByteArray report(const QVector<FileReport>& files, qint64 elapsedMs);
+};
+
+#endif // SPRITELINTER_H
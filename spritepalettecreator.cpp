@@ -53,12 +53,13 @@ QPixmap SpritePaletteCreator::MakeFullPalette() {
     return b;
 }
 
-bool SpritePaletteCreator::PaletteToFile(const QImage& image, const QString& name) {
+bool SpritePaletteCreator::PaletteToFile(const QString& name) {
     QVector<QColor> colors;
     QString palmaskName = name.endsWith(".pal") ? name.chopped(3) + "palmask" : name + ".palmask";
-    for (int i = 0; i < image.height(); i += 16)
-        for (int j = 0; j < image.width(); j += 16)
-            colors.append(image.pixel(j, i));
+    // sprite palettes 8-F, same layout as MakeFullPalette
+    for (int i = 8; i < 16; i++)
+        for (int j = 0; j < 16; j++)
+            colors.append(paletteData[i][j]);
     QFile file{name};
     QFile palmask{palmaskName};
     bool s1 = file.open(QFile::OpenModeFlag::WriteOnly | QFile::OpenModeFlag::Truncate);
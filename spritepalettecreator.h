@@ -17,7 +17,7 @@ public:
     constexpr static int nSpritePalettes() { return 8; }
     static QPixmap MakePalette(int index);
     static QPixmap MakeFullPalette();
-    static bool PaletteToFile(const QImage& image, const QString& name);
+    static bool PaletteToFile(const QString& name);
     static void changePaletteColor(const QColor& color, const QPoint& index);
 };
 
@@ -0,0 +1,67 @@
+#include "spritesaver.h"
+#include "tracing.h"
+#include <QFile>
+#include <QSaveFile>
+
+SpriteSaver::SpriteSaver(QObject* parent) : QObject(parent) {
+    m_pool.setMaxThreadCount(1);
+    // an idle editor shouldn't keep a thread around
+    m_pool.setExpiryTimeout(5000);
+}
+
+SpriteSaver::~SpriteSaver() {
+    m_pool.waitForDone();
+}
+
+bool SpriteSaver::save(const JsonSprite& sprite, QString name, bool translucencyCompatibility, quint64 document) {
+    if (name.length() == 0)
+        name = sprite.m_name;
+    if (name.length() == 0)
+        return false;
+    m_pending++;
+    // the copy is the snapshot, the editor can keep changing its sprite
+    m_pool.start([this, snapshot = sprite, name, translucencyCompatibility, document]() mutable {
+        TRACE_SCOPE("SpriteSaver::save");
+        const QByteArray data = snapshot.to_text(name, translucencyCompatibility);
+        bool written = false;
+        QString error;
+        const bool ok = writeFile(name, data, written, error);
+        if (!ok)
+            m_failures++;
+        m_pending--;
+        if (ok)
+            emit saved(name, written, document);
+        else
+            emit failed(name, error, document);
+    });
+    return true;
+}
+
+bool SpriteSaver::isSaving() const {
+    return m_pending > 0;
+}
+
+bool SpriteSaver::waitForDone() {
+    const int failures = m_failures;
+    m_pool.waitForDone();
+    return m_failures == failures;
+}
+
+bool SpriteSaver::writeFile(const QString& name, const QByteArray& data, bool& written, QString& error) {
+    TRACE_SCOPE("SpriteSaver::writeFile");
+    written = false;
+    {
+        // read back the way it's written, so line endings don't count as a change
+        QFile current{name};
+        if (current.size() >= data.size() && current.open(QFile::OpenModeFlag::ReadOnly | QFile::OpenModeFlag::Text)
+            && current.readAll() == data)
+            return true;
+    }
+    QSaveFile out{name};
+    if (!out.open(QFile::OpenModeFlag::WriteOnly | QFile::OpenModeFlag::Text) || out.write(data) != data.size() || !out.commit()) {
+        error = out.errorString();
+        return false;
+    }
+    written = true;
+    return true;
+}
@@ -0,0 +1,39 @@
+#ifndef SPRITESAVER_H
+#define SPRITESAVER_H
+
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <atomic>
+#include "jsonsprite.h"
+
+// Saves sprites without holding up the editor: the sprite is copied when the save starts, serialized on a
+// worker thread and written through a QSaveFile, so the file on disk is either the old one or the new one,
+// never a truncated mix. A file that already holds exactly the serialized bytes isn't written at all.
+// Saves run one at a time in the order they were started, so the last one started is what ends up on disk.
+class SpriteSaver : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SpriteSaver(QObject* parent = nullptr);
+    // waits for the saves still running
+    ~SpriteSaver() override;
+    // an empty name saves to the file the sprite was loaded from, false if there is none
+    // document is handed back by the signals, so a result for a sprite that was closed since can be told apart
+    bool save(const JsonSprite& sprite, QString name, bool translucencyCompatibility, quint64 document = 0);
+    bool isSaving() const;
+    // blocks until every save started so far is done, false if one of those still running when it was called failed
+    bool waitForDone();
+    // replaces the file with data, written is false if it already held the same data and was left alone
+    static bool writeFile(const QString& name, const QByteArray& data, bool& written, QString& error);
+signals:
+    // emitted from the worker thread, connections to the GUI are queued
+    void saved(const QString& name, bool written, quint64 document);
+    void failed(const QString& name, const QString& error, quint64 document);
+private:
+    QThreadPool m_pool;
+    std::atomic<int> m_pending{0};
+    std::atomic<int> m_failures{0};
+};
+
+#endif // SPRITESAVER_H
@@ -0,0 +1,46 @@
+#ifndef STRUCTURALHASH_H
+#define STRUCTURALHASH_H
+
+#include <QString>
+#include <QtGlobal>
+
+// Order dependent 64 bit hash built from plain values.
+// Only the values fed in matter (not pointers, padding or endianness), so a hash is stable across runs and
+// machines and two structures that compare equal always hash the same.
+class StructuralHash
+{
+public:
+    constexpr StructuralHash& add(quint64 v) {
+        m_state = mix(m_state ^ (v + 0x9e3779b97f4a7c15ull + (m_state << 6) + (m_state >> 2)));
+        return *this;
+    }
+    // the length goes in first, so "ab" + "c" and "a" + "bc" don't collide
+    StructuralHash& add(const QString& str) {
+        add(static_cast<quint64>(str.size()));
+        auto units = str.utf16();
+        qsizetype i = 0;
+        for (; i + 4 <= str.size(); i += 4) {
+            add(static_cast<quint64>(units[i]) | static_cast<quint64>(units[i + 1]) << 16 |
+                static_cast<quint64>(units[i + 2]) << 32 | static_cast<quint64>(units[i + 3]) << 48);
+        }
+        for (; i < str.size(); i++)
+            add(static_cast<quint64>(units[i]));
+        return *this;
+    }
+    constexpr quint64 value() const {
+        return mix(m_state);
+    }
+private:
+    // splitmix64 finalizer
+    static constexpr quint64 mix(quint64 x) {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ull;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebull;
+        x ^= x >> 31;
+        return x;
+    }
+    quint64 m_state = 0xcbf29ce484222325ull;
+};
+
+#endif // STRUCTURALHASH_H
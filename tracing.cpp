@@ -0,0 +1,162 @@
+#include "tracing.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QSaveFile>
+#include <QThread>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace {
+struct Event {
+    const char* name;
+    qint64 start;
+    qint64 duration;
+};
+
+// written only by its own thread, the count is published after the slot so write() never reads a half written one
+struct ThreadBuffer {
+    int tid = 0;
+    QString threadName;
+    std::unique_ptr<Event[]> events{new Event[Tracing::Capacity]};
+    std::atomic<quint64> count{0};
+};
+
+struct TraceState {
+    QMutex mutex;
+    QString filename;
+    std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    // owned here instead of by the threads, pool threads may be gone by the time the trace is written
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+};
+
+TraceState& state() {
+    static TraceState s;
+    return s;
+}
+
+ThreadBuffer* registerThread() {
+    auto& s = state();
+    QMutexLocker lock{&s.mutex};
+    auto buffer = std::make_unique<ThreadBuffer>();
+    buffer->tid = static_cast<int>(s.buffers.size()) + 1;
+    auto app = QCoreApplication::instance();
+    if (app && QThread::currentThread() == app->thread())
+        buffer->threadName = "Main thread";
+    else if (!QThread::currentThread()->objectName().isEmpty())
+        buffer->threadName = QThread::currentThread()->objectName();
+    else
+        buffer->threadName = QString::asprintf("Thread %d", buffer->tid);
+    s.buffers.push_back(std::move(buffer));
+    return s.buffers.back().get();
+}
+
+ThreadBuffer& threadBuffer() {
+    thread_local ThreadBuffer* buffer = registerThread();
+    return *buffer;
+}
+}
+
+void PerfCounters::setEnabled(bool enabled) {
+    if (enabled && !s_enabled.load(std::memory_order_relaxed)) {
+        for (auto& value : s_values)
+            value.store(0, std::memory_order_relaxed);
+    }
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Tracing::configure(int& argc, char** argv) {
+    QString filename = qEnvironmentVariable("CFGEDITOR_TRACE");
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--trace") != 0 || i + 1 >= argc)
+            continue;
+        filename = QString::fromLocal8Bit(argv[i + 1]);
+        // the editor treats every other argument as a sprite to open
+        for (int j = i; j + 2 <= argc; j++)
+            argv[j] = argv[j + 2];
+        argc -= 2;
+        break;
+    }
+    if (!filename.isEmpty())
+        start(filename);
+}
+
+void Tracing::start(const QString& filename) {
+    auto& s = state();
+    {
+        QMutexLocker lock{&s.mutex};
+        if (!s.filename.isEmpty())
+            return;
+        s.filename = filename;
+        s.epoch = std::chrono::steady_clock::now();
+    }
+    std::atexit(writeAtExit);
+    s_enabled.store(true, std::memory_order_relaxed);
+}
+
+qint64 Tracing::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - state().epoch).count();
+}
+
+void Tracing::record(const char* name, qint64 start, qint64 end) {
+    auto& buffer = threadBuffer();
+    quint64 n = buffer.count.load(std::memory_order_relaxed);
+    buffer.events[n % Capacity] = Event{name, start, end - start};
+    buffer.count.store(n + 1, std::memory_order_release);
+}
+
+bool Tracing::write(const QString& filename, QString& error) {
+    auto& s = state();
+    QMutexLocker lock{&s.mutex};
+    const qint64 pid = QCoreApplication::applicationPid();
+    QJsonArray events;
+    for (auto& buffer : s.buffers) {
+        events.append(QJsonObject{
+            {"ph", "M"},
+            {"name", "thread_name"},
+            {"pid", pid},
+            {"tid", buffer->tid},
+            {"args", QJsonObject{{"name", buffer->threadName}}},
+        });
+        const quint64 count = buffer->count.load(std::memory_order_acquire);
+        const quint64 first = count > static_cast<quint64>(Capacity) ? count - Capacity : 0;
+        for (quint64 i = first; i < count; i++) {
+            const Event& e = buffer->events[i % Capacity];
+            // chrome wants microseconds, the fraction keeps the ns resolution
+            events.append(QJsonObject{
+                {"ph", "X"},
+                {"cat", "cfgeditor"},
+                {"name", e.name},
+                {"pid", pid},
+                {"tid", buffer->tid},
+                {"ts", e.start / 1000.0},
+                {"dur", e.duration / 1000.0},
+            });
+        }
+    }
+    QByteArray data = QJsonDocument{QJsonObject{{"traceEvents", events}, {"displayTimeUnit", "ms"}}}.toJson(QJsonDocument::Compact);
+    QSaveFile out{filename};
+    if (!out.open(QIODevice::WriteOnly) || out.write(data) != data.size() || !out.commit()) {
+        error = out.errorString();
+        return false;
+    }
+    return true;
+}
+
+void Tracing::writeAtExit() {
+    s_enabled.store(false, std::memory_order_relaxed);
+    QString filename;
+    {
+        QMutexLocker lock{&state().mutex};
+        filename = state().filename;
+    }
+    QString error;
+    if (!write(filename, error))
+        qWarning() << "Could not write the trace to" << filename << ":" << error;
+}
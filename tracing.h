@@ -0,0 +1,107 @@
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <QString>
+#include <QtGlobal>
+#include <array>
+#include <atomic>
+
+// Scoped timing of the hot paths, written as Chrome trace events (chrome://tracing, ui.perfetto.dev).
+// Off unless CFGEDITOR_TRACE=<file> is set or --trace <file> is passed, then every TRACE_SCOPE records one
+// complete event into a ring buffer of the calling thread and the file is written when the program exits.
+// A disabled scope costs a relaxed load and a branch.
+class Tracing
+{
+public:
+    // each thread keeps its newest Capacity events, older ones are overwritten
+    static constexpr int Capacity = 1 << 15;
+    // reads the environment and removes --trace <file> from argv, call before the QApplication is created
+    static void configure(int& argc, char** argv);
+    // starts recording, the trace is written to filename at exit
+    static void start(const QString& filename);
+    static bool enabled() {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+    // steady clock, in ns since tracing started
+    static qint64 now();
+    // name has to outlive the trace, TRACE_SCOPE only passes string literals
+    static void record(const char* name, qint64 start, qint64 end);
+    // everything recorded so far, the traced threads should be idle while it runs
+    static bool write(const QString& filename, QString& error);
+private:
+    static void writeAtExit();
+    static inline std::atomic<bool> s_enabled{false};
+};
+
+// Process wide counters read by the performance HUD, they're only updated while counting is on.
+// Durations hold the last measured value, everything else adds up from the moment counting was turned on.
+class PerfCounters
+{
+public:
+    enum Counter {
+        None = -1,
+        SheetRedrawNs,
+        CanvasRedrawNs,
+        Decoded8x8Tiles,
+        CanvasCacheHits,
+        CanvasCacheMisses,
+        LayerCacheHits,
+        LayerCacheMisses,
+        Count
+    };
+    static bool enabled() {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+    // turning counting on starts every counter from 0
+    static void setEnabled(bool enabled);
+    static void add(Counter counter, qint64 n = 1) {
+        if (enabled()) [[unlikely]]
+            s_values[counter].fetch_add(n, std::memory_order_relaxed);
+    }
+    static void set(Counter counter, qint64 value) {
+        if (enabled()) [[unlikely]]
+            s_values[counter].store(value, std::memory_order_relaxed);
+    }
+    static qint64 value(Counter counter) {
+        return s_values[counter].load(std::memory_order_relaxed);
+    }
+private:
+    static inline std::atomic<bool> s_enabled{false};
+    static inline std::array<std::atomic<qint64>, Count> s_values{};
+};
+
+class TraceZone
+{
+public:
+    // with a counter, the duration is also stored there while PerfCounters are on
+    explicit TraceZone(const char* name, PerfCounters::Counter counter = PerfCounters::None)
+        : m_name{Tracing::enabled() || (counter != PerfCounters::None && PerfCounters::enabled()) ? name : nullptr}
+        , m_counter{counter} {
+        if (m_name) [[unlikely]]
+            m_start = Tracing::now();
+    }
+    ~TraceZone() {
+        if (!m_name) [[likely]]
+            return;
+        const qint64 end = Tracing::now();
+        if (Tracing::enabled())
+            Tracing::record(m_name, m_start, end);
+        if (m_counter != PerfCounters::None)
+            PerfCounters::set(m_counter, end - m_start);
+    }
+    TraceZone(const TraceZone&) = delete;
+    TraceZone& operator=(const TraceZone&) = delete;
+private:
+    const char* m_name;
+    PerfCounters::Counter m_counter;
+    qint64 m_start = 0;
+};
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+// times the rest of the enclosing block
+#define TRACE_SCOPE(name) TraceZone TRACE_CONCAT(traceZone, __LINE__){name}
+// same, and keeps the duration in a PerfCounters counter
+#define TRACE_SCOPE_COUNTER(name, counter) TraceZone TRACE_CONCAT(traceZone, __LINE__){name, PerfCounters::counter}
+
+#endif // TRACING_H
@@ -1,4 +1,5 @@
 #include "tweak_bytes.h"
+#include "structuralhash.h"
 
 void J1656::from_json(const QJsonObject& byte) {
     objclip = byte["Object Clipping"].toInt() & 0x0F;
@@ -247,3 +248,27 @@ QJsonObject J190F::to_json() const {
     obj["Don't get stuck in walls (carryable sprites)"] = nostuck;
     return obj;
 }
+
+quint64 J1656::hash() const {
+    return StructuralHash{}.add(to_byte()).value();
+}
+
+quint64 J1662::hash() const {
+    return StructuralHash{}.add(to_byte()).value();
+}
+
+quint64 J166E::hash() const {
+    return StructuralHash{}.add(to_byte()).value();
+}
+
+quint64 J167A::hash() const {
+    return StructuralHash{}.add(to_byte()).value();
+}
+
+quint64 J1686::hash() const {
+    return StructuralHash{}.add(to_byte()).value();
+}
+
+quint64 J190F::hash() const {
+    return StructuralHash{}.add(to_byte()).value();
+}
@@ -13,6 +13,7 @@ struct J1656 {
     void from_byte(uint8_t byte);
     uint8_t to_byte() const;
     QJsonObject to_json() const;
+    quint64 hash() const;
     constexpr bool operator==(const J1656&) const = default;
 };
 
@@ -25,6 +26,7 @@ struct J1662 {
     void from_byte(uint8_t byte);
     uint8_t to_byte() const;
     QJsonObject to_json() const;
+    quint64 hash() const;
     constexpr bool operator==(const J1662&) const = default;
 };
 
@@ -40,6 +42,7 @@ struct J166E {
     void from_byte(uint8_t byte);
     uint8_t to_byte() const;
     QJsonObject to_json() const;
+    quint64 hash() const;
     constexpr bool operator==(const J166E&) const = default;
 };
 
@@ -57,6 +60,7 @@ struct J167A {
     void from_byte(uint8_t byte);
     uint8_t to_byte() const;
     QJsonObject to_json() const;
+    quint64 hash() const;
     constexpr bool operator==(const J167A&) const = default;
 };
 
@@ -74,6 +78,7 @@ struct J1686 {
     void from_byte(uint8_t byte);
     uint8_t to_byte() const;
     QJsonObject to_json() const;
+    quint64 hash() const;
     constexpr bool operator==(const J1686&) const = default;
 };
 
@@ -91,6 +96,7 @@ struct J190F {
     void from_byte(uint8_t byte);
     uint8_t to_byte() const;
     QJsonObject to_json() const;
+    quint64 hash() const;
     constexpr bool operator==(const J190F&) const = default;
 };
 
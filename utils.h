@@ -1,25 +1,14 @@
 #ifndef UTILS_H
 #define UTILS_H
 #include <type_traits>
+#include <algorithm>
 #include <QString>
 #include <QFile>
-#include <QMessageBox>
+#include <QVector>
+#include "errorreporter.h"
 
 #define TRY_OPEN(f) if (!(f)) return false;
 
-class DefaultAlertImpl : QMessageBox {
-    Q_OBJECT
-private:
-public:
-    DefaultAlertImpl(QWidget* parent, const QString& message) : QMessageBox(parent) {
-        setText(message);
-    }
-
-    void operator()() {
-        exec();
-	}
-};
-
 class Equal{};
 class LessThan{};
 class MoreThan{};
@@ -36,37 +25,37 @@ bool assert_filesize(S name, qsizetype size) {
         if constexpr (std::is_same_v<T, Equal>) {
             result = file.size() == size;
             if (!result) {
-                DefaultAlertImpl(nullptr, QString::asprintf("This type of file must be exactly %lld bytes in size", size))();
+                ErrorReporter::error(QString::asprintf("This type of file must be exactly %lld bytes in size", size));
             }
         }
         else if constexpr (std::is_same_v<T, Different>) {
             result = file.size() != size;
             if (!result) {
-                DefaultAlertImpl(nullptr, QString::asprintf("This type of file must not be exactly %lld bytes in size", size))();
+                ErrorReporter::error(QString::asprintf("This type of file must not be exactly %lld bytes in size", size));
             }
         }
         else if constexpr (std::is_same_v<T, LessThan>) {
             result = file.size() < size;
             if (!result) {
-                DefaultAlertImpl(nullptr, QString::asprintf("This type of file must be less than %lld bytes in size", size))();
+                ErrorReporter::error(QString::asprintf("This type of file must be less than %lld bytes in size", size));
             }
         }
         else if constexpr (std::is_same_v<T, MoreThan>) {
             result = file.size() > size;
             if (!result) {
-                DefaultAlertImpl(nullptr, QString::asprintf("This type of file must be more than %lld bytes in size", size))();
+                ErrorReporter::error(QString::asprintf("This type of file must be more than %lld bytes in size", size));
             }
         }
         else if constexpr (std::is_same_v<T, LessThanOrEqual>) {
             result = file.size() <= size;
             if (!result) {
-                DefaultAlertImpl(nullptr, QString::asprintf("This type of file must be less than or equal to %lld bytes in size", size))();
+                ErrorReporter::error(QString::asprintf("This type of file must be less than or equal to %lld bytes in size", size));
             }
         }
         else if constexpr (std::is_same_v<T, MoreThanOrEqual>) {
             result = file.size() == size;
             if (!result) {
-                DefaultAlertImpl(nullptr, QString::asprintf("This type of file must be more than or equal to %lld bytes in size", size))();
+                ErrorReporter::error(QString::asprintf("This type of file must be more than or equal to %lld bytes in size", size));
             }
         } else {
             Q_ASSERT(false);
@@ -76,6 +65,29 @@ bool assert_filesize(S name, qsizetype size) {
     return false;
 }
 
+// moves count items starting at from in front of the item at before, counted before the move,
+// the way QAbstractItemModel::beginMoveRows describes a move
+template <typename T>
+void moveItems(QVector<T>& items, qsizetype from, qsizetype count, qsizetype before) {
+    if (before > from)
+        std::rotate(items.begin() + from, items.begin() + from + count, items.begin() + before);
+    else
+        std::rotate(items.begin() + before, items.begin() + from, items.begin() + from + count);
+}
+
+// where the item at index ends up after moveItems
+constexpr qsizetype movedIndex(qsizetype index, qsizetype from, qsizetype count, qsizetype before) {
+    if (index >= from && index < from + count)
+        return index + (before > from ? before - from - count : before - from);
+    if (before > from && index >= from + count && index < before)
+        return index - count;
+    if (before < from && index >= before && index < from)
+        return index + count;
+    return index;
+}
+static_assert(movedIndex(0, 0, 2, 5) == 3 && movedIndex(2, 0, 2, 5) == 0 && movedIndex(5, 0, 2, 5) == 5);
+static_assert(movedIndex(4, 3, 2, 1) == 2 && movedIndex(1, 3, 2, 1) == 3 && movedIndex(0, 3, 2, 1) == 0);
+
 constexpr qsizetype kb(qsizetype n) {
     return n * 1024;
 }